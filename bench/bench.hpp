@@ -0,0 +1,87 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Bench
+{
+	class Benchmark;
+
+	/** The sizes of input which benchmarks are run with. These range from a short message identifier
+	 * up to a full block of message tags.
+	 */
+	inline constexpr size_t SIZES[] = { 10, 64, 512, 8192 };
+
+	/** Prevents the compiler from optimising away the calculation of a value.
+	 * \param value The value which must be calculated.
+	 */
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#ifdef __GNUC__
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	/** Generates a deterministic pseudo-random string for use as benchmark input.
+	 * \param length The length of the string.
+	 * \param characters The characters to pick from or an empty string to use every octet.
+	 * \return A string of the specified length.
+	 */
+	std::string RandomString(size_t length, std::string_view characters = {});
+
+	/** Retrieves the list of benchmarks which have been registered. */
+	std::vector<Benchmark>& GetBenchmarks();
+
+	/** Registers a benchmark.
+	 * \param name The name of the benchmark in the format module/function/size.
+	 * \param bytes The number of bytes of input which are processed by each operation.
+	 * \param function The function which performs a single operation.
+	 * \return Always true so this can be used to initialise a namespace-scope variable.
+	 */
+	template <typename Function>
+	bool Register(const std::string& name, size_t bytes, Function function);
+}
+
+/** Benchmark holds the details of a single benchmark. */
+class Bench::Benchmark final
+{
+public:
+	/** The name of the benchmark in the format module/function/size. */
+	std::string name;
+
+	/** The number of bytes of input which are processed by each operation. */
+	size_t bytes;
+
+	/** Runs the specified number of operations. */
+	std::function<void(size_t)> run;
+
+	/** Creates a new Benchmark with the specified details. */
+	Benchmark(const std::string& n, size_t b, std::function<void(size_t)>&& r)
+		: name(n)
+		, bytes(b)
+		, run(std::move(r))
+	{
+	}
+};
+
+template <typename Function>
+bool Bench::Register(const std::string& name, size_t bytes, Function function)
+{
+	// Loop inside the wrapper so the operation can be inlined into it.
+	GetBenchmarks().emplace_back(name, bytes, [function](size_t iterations) mutable {
+		for (size_t iteration = 0; iteration < iterations; ++iteration)
+			function();
+	});
+	return true;
+}
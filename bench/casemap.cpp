@@ -0,0 +1,66 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <oulu/casemap.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// Characters which are commonly found in nicks and channel names including the folded ones.
+	constexpr std::string_view NAME_CHARACTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_[]\\^{}|`#";
+
+	void RegisterCaseMapping(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto name = Bench::RandomString(size, NAME_CHARACTERS);
+		const auto folded = Oulu::FoldCase(name);
+
+		Bench::Register("casemap/FoldCase" + suffix, name.length(), [=] {
+			Bench::DoNotOptimize(Oulu::FoldCase(name));
+		});
+		Bench::Register("casemap/FoldCaseInPlace" + suffix, name.length(), [=, buffer = name]() mutable {
+			Bench::DoNotOptimize(Oulu::FoldCaseInPlace(buffer));
+		});
+		Bench::Register("casemap/CaseHash" + suffix, name.length(), [=, hash = Oulu::CaseHash()] {
+			Bench::DoNotOptimize(hash(name));
+		});
+		Bench::Register("casemap/CaseEqual" + suffix, name.length(), [=, equal = Oulu::CaseEqual()] {
+			Bench::DoNotOptimize(equal(name, folded));
+		});
+	}
+
+	void RegisterLookup(size_t size)
+	{
+		// Build a table of the specified number of nicks and look them up with different case.
+		std::unordered_map<std::string, size_t, Oulu::CaseHash, Oulu::CaseEqual> nicks;
+		std::vector<std::string> lookups;
+		size_t bytes = 0;
+		for (size_t idx = 0; idx < size; ++idx)
+		{
+			auto nick = Bench::RandomString(5 + idx % 10, NAME_CHARACTERS.substr(0, 52)) + std::to_string(idx);
+			nicks.emplace(nick, idx);
+			Oulu::FoldCaseInPlace(nick);
+			bytes += nick.length();
+			lookups.push_back(std::move(nick));
+		}
+
+		Bench::Register("casemap/unordered_map::find/" + std::to_string(size), bytes, [=] {
+			for (const auto& nick : lookups)
+				Bench::DoNotOptimize(nicks.find(std::string_view(nick)));
+		});
+	}
+
+	[[maybe_unused]] const auto registered = [] {
+		for (const auto size : Bench::SIZES)
+		{
+			RegisterCaseMapping(size);
+			RegisterLookup(size);
+		}
+		return true;
+	}();
+}
@@ -0,0 +1,28 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+
+#include <oulu/command.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// A mix of commands like those received by a server including numerics and unknown commands.
+	constexpr std::array<std::string_view, 16> COMMANDS = {
+		"PRIVMSG", "privmsg", "NOTICE", "PING", "PONG", "JOIN", "PART", "MODE",
+		"001", "353", "366", "433", "TAGMSG", "AUTHENTICATE", "ENCAP", "XYZZY",
+	};
+
+	[[maybe_unused]] const auto registered = [] {
+		size_t bytes = 0;
+		for (const auto& command : COMMANDS)
+			bytes += command.length();
+
+		return Bench::Register("command/IdentifyCommand/" + std::to_string(COMMANDS.size()), bytes, [] {
+			for (const auto& command : COMMANDS)
+				Bench::DoNotOptimize(Oulu::IdentifyCommand(command));
+		});
+	}();
+}
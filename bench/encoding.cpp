@@ -0,0 +1,157 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <oulu/encoding.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// Characters which are commonly found in URLs with a mix of safe and unsafe characters.
+	constexpr std::string_view URL_CHARACTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_./:?&= ";
+
+	void RegisterBase64(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto decoded = Bench::RandomString(size);
+		const auto encoded = Oulu::Base64Encode(decoded);
+
+		Bench::Register("encoding/Base64Encode" + suffix, decoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::Base64Encode(decoded));
+		});
+		Bench::Register("encoding/Base64EncodeTo(string)" + suffix, decoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Oulu::Base64EncodeTo(out, decoded);
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/Base64EncodeTo(span)" + suffix, decoded.length(), [=, out = std::string(encoded.length(), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::Base64EncodeTo(std::span<char>(out), decoded));
+		});
+		Bench::Register("encoding/Base64Encoder" + suffix, decoded.length(), [=, out = std::string()]() mutable {
+			Oulu::Base64Encoder encoder;
+			out.clear();
+			encoder.Update(out, decoded);
+			encoder.Final(out);
+			Bench::DoNotOptimize(out);
+		});
+
+		Bench::Register("encoding/Base64Decode" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::Base64Decode(encoded));
+		});
+		Bench::Register("encoding/Base64DecodeTo(string)" + suffix, encoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Oulu::Base64DecodeTo(out, encoded);
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/Base64DecodeTo(span)" + suffix, encoded.length(), [=, out = std::string(Oulu::Base64DecodedLength(encoded.length()), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::Base64DecodeTo(std::span<char>(out), encoded));
+		});
+		Bench::Register("encoding/Base64DecodeInPlace" + suffix, encoded.length(), [=, buffer = encoded]() mutable {
+			buffer.assign(encoded);
+			Bench::DoNotOptimize(Oulu::Base64DecodeInPlace(buffer));
+		});
+		Bench::Register("encoding/Base64DecodeStrict" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::Base64DecodeStrict(encoded));
+		});
+		Bench::Register("encoding/Base64Decoder" + suffix, encoded.length(), [=, out = std::string()]() mutable {
+			Oulu::Base64Decoder decoder;
+			out.clear();
+			decoder.Update(out, encoded);
+			Bench::DoNotOptimize(decoder.Final());
+			Bench::DoNotOptimize(out);
+		});
+	}
+
+	void RegisterHex(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto decoded = Bench::RandomString(size);
+		const auto encoded = Oulu::HexEncode(decoded);
+		const auto separated = Oulu::HexEncode(decoded, Oulu::HEX_TABLE_LOWER, ':');
+
+		Bench::Register("encoding/HexEncode" + suffix, decoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::HexEncode(decoded));
+		});
+		Bench::Register("encoding/HexEncode(separator)" + suffix, decoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::HexEncode(decoded, Oulu::HEX_TABLE_LOWER, ':'));
+		});
+		Bench::Register("encoding/HexEncodeTo(string)" + suffix, decoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Oulu::HexEncodeTo(out, decoded);
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/HexEncodeTo(span)" + suffix, decoded.length(), [=, out = std::string(encoded.length(), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::HexEncodeTo(std::span<char>(out), decoded));
+		});
+
+		Bench::Register("encoding/HexDecode" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::HexDecode(encoded));
+		});
+		Bench::Register("encoding/HexDecode(separator)" + suffix, separated.length(), [=] {
+			Bench::DoNotOptimize(Oulu::HexDecode(separated, Oulu::HEX_TABLE_LOWER, ':'));
+		});
+		Bench::Register("encoding/HexDecodeTo(string)" + suffix, encoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Bench::DoNotOptimize(Oulu::HexDecodeTo(out, encoded));
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/HexDecodeTo(span)" + suffix, encoded.length(), [=, out = std::string(decoded.length(), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::HexDecodeTo(std::span<char>(out), encoded));
+		});
+		Bench::Register("encoding/HexDecodeInPlace" + suffix, encoded.length(), [=, buffer = encoded]() mutable {
+			buffer.assign(encoded);
+			Bench::DoNotOptimize(Oulu::HexDecodeInPlace(buffer));
+		});
+		Bench::Register("encoding/HexDecodeStrict" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::HexDecodeStrict(encoded));
+		});
+	}
+
+	void RegisterPercent(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto decoded = Bench::RandomString(size, URL_CHARACTERS);
+		const auto encoded = Oulu::PercentEncode(decoded);
+
+		Bench::Register("encoding/PercentEncode" + suffix, decoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::PercentEncode(decoded));
+		});
+		Bench::Register("encoding/PercentEncodeTo(string)" + suffix, decoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Oulu::PercentEncodeTo(out, decoded);
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/PercentEncodeTo(span)" + suffix, decoded.length(), [=, out = std::string(Oulu::PercentEncodedLength(decoded.length()), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::PercentEncodeTo(std::span<char>(out), decoded));
+		});
+
+		Bench::Register("encoding/PercentDecode" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::PercentDecode(encoded));
+		});
+		Bench::Register("encoding/PercentDecodeTo(string)" + suffix, encoded.length(), [=, out = std::string()]() mutable {
+			out.clear();
+			Oulu::PercentDecodeTo(out, encoded);
+			Bench::DoNotOptimize(out);
+		});
+		Bench::Register("encoding/PercentDecodeTo(span)" + suffix, encoded.length(), [=, out = std::string(encoded.length(), '\0')]() mutable {
+			Bench::DoNotOptimize(Oulu::PercentDecodeTo(std::span<char>(out), encoded));
+		});
+		Bench::Register("encoding/PercentDecodeInPlace" + suffix, encoded.length(), [=, buffer = encoded]() mutable {
+			buffer.assign(encoded);
+			Bench::DoNotOptimize(Oulu::PercentDecodeInPlace(buffer));
+		});
+		Bench::Register("encoding/PercentDecodeStrict" + suffix, encoded.length(), [=] {
+			Bench::DoNotOptimize(Oulu::PercentDecodeStrict(encoded));
+		});
+	}
+
+	[[maybe_unused]] const auto registered = [] {
+		for (const auto size : Bench::SIZES)
+		{
+			RegisterBase64(size);
+			RegisterHex(size);
+			RegisterPercent(size);
+		}
+		return true;
+	}();
+}
@@ -0,0 +1,249 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string_view>
+
+#include <oulu/simd.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// The number of allocations which have been made since the program started.
+	std::atomic<size_t> allocations = 0;
+
+	// The number of samples which are taken of each benchmark.
+	constexpr size_t SAMPLES = 5;
+
+	// The formats which results can be written in.
+	enum class Format
+	{
+		CSV,
+		JSON,
+		TEXT,
+	};
+
+	// The results of running a single benchmark.
+	class Result final
+	{
+	public:
+		size_t iterations = 0;
+		double allocations_per_op = 0;
+		double bytes_per_second = 0;
+		double ns_per_op = 0;
+	};
+
+	// Allocates memory and records the allocation.
+	void* Allocate(size_t size)
+	{
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		if (auto* ptr = std::malloc(size ? size : 1))
+			return ptr;
+		throw std::bad_alloc();
+	}
+
+	// Times the specified number of operations of a benchmark in nanoseconds.
+	double Time(const Bench::Benchmark& benchmark, size_t iterations)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		benchmark.run(iterations);
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	// Runs a benchmark for at least the specified number of nanoseconds and returns its results.
+	Result Measure(const Bench::Benchmark& benchmark, double min_time)
+	{
+		// Find a number of iterations which takes long enough for one sample to be accurate.
+		const auto sample_time = min_time / SAMPLES;
+		size_t iterations = 1;
+		for (auto elapsed = Time(benchmark, iterations); elapsed < sample_time; elapsed = Time(benchmark, iterations))
+		{
+			const auto scale = elapsed > 0 ? sample_time / elapsed : 10.0;
+			iterations = static_cast<size_t>(iterations * std::clamp(scale * 1.2, 2.0, 10.0));
+		}
+
+		// Take the median of several samples to reduce the impact of noise.
+		double samples[SAMPLES];
+		const auto allocations_before = allocations.load(std::memory_order_relaxed);
+		for (auto& sample : samples)
+			sample = Time(benchmark, iterations) / iterations;
+		const auto allocations_after = allocations.load(std::memory_order_relaxed);
+		std::sort(std::begin(samples), std::end(samples));
+
+		Result result;
+		result.iterations = iterations * SAMPLES;
+		result.ns_per_op = samples[SAMPLES / 2];
+		result.bytes_per_second = benchmark.bytes * 1e9 / result.ns_per_op;
+		result.allocations_per_op = static_cast<double>(allocations_after - allocations_before) / result.iterations;
+		return result;
+	}
+
+	// Retrieves the name of a SIMD level.
+	const char* GetLevelName(Oulu::SIMD::Level level)
+	{
+		switch (level)
+		{
+			case Oulu::SIMD::Level::SCALAR:
+				return "scalar";
+			case Oulu::SIMD::Level::SSE41:
+				return "sse41";
+			case Oulu::SIMD::Level::AVX2:
+				return "avx2";
+		}
+		return "unknown";
+	}
+
+	// Writes the usage information for the program.
+	int Usage(const char* program)
+	{
+		fprintf(stderr, "Usage: %s [--filter TEXT] [--format csv|json|text] [--level scalar|sse41|avx2] [--list] [--min-time MS]\n", program);
+		return EXIT_FAILURE;
+	}
+}
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+std::string Bench::RandomString(size_t length, std::string_view characters)
+{
+	// Use a fixed seed so every run of the benchmarks processes the same data.
+	std::mt19937 rng(length);
+	std::uniform_int_distribution<size_t> dist(0, characters.empty() ? 255 : characters.length() - 1);
+
+	std::string str;
+	str.reserve(length);
+	while (str.length() < length)
+	{
+		const auto idx = dist(rng);
+		str.push_back(characters.empty() ? static_cast<char>(idx) : characters[idx]);
+	}
+	return str;
+}
+
+std::vector<Bench::Benchmark>& Bench::GetBenchmarks()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+int main(int argc, char** argv)
+{
+	std::string_view filter;
+	auto format = Format::TEXT;
+	auto list = false;
+	double min_time = 100'000'000;
+
+	for (int idx = 1; idx < argc; ++idx)
+	{
+		const std::string_view arg = argv[idx];
+		if (arg == "--list")
+		{
+			list = true;
+			continue;
+		}
+
+		if (idx + 1 >= argc)
+			return Usage(argv[0]);
+
+		const std::string_view value = argv[++idx];
+		if (arg == "--filter")
+			filter = value;
+		else if (arg == "--format" && value == "csv")
+			format = Format::CSV;
+		else if (arg == "--format" && value == "json")
+			format = Format::JSON;
+		else if (arg == "--format" && value == "text")
+			format = Format::TEXT;
+		else if (arg == "--min-time")
+			min_time = std::atof(value.data()) * 1'000'000;
+		else if (arg == "--level")
+		{
+			auto found = false;
+			for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+			{
+				if (value != GetLevelName(level))
+					continue;
+
+				if (!Oulu::SIMD::SetLevel(level))
+				{
+					fprintf(stderr, "The %s level is not supported by this CPU!\n", value.data());
+					return EXIT_FAILURE;
+				}
+				found = true;
+			}
+
+			if (!found)
+				return Usage(argv[0]);
+		}
+		else
+			return Usage(argv[0]);
+	}
+
+	auto& benchmarks = Bench::GetBenchmarks();
+	std::stable_sort(benchmarks.begin(), benchmarks.end(), [](const auto& lhs, const auto& rhs) {
+		// Group benchmarks by function but keep them in size order within a group.
+		const auto lhs_function = std::string_view(lhs.name).substr(0, lhs.name.rfind('/'));
+		const auto rhs_function = std::string_view(rhs.name).substr(0, rhs.name.rfind('/'));
+		return lhs_function < rhs_function;
+	});
+
+	// Listing always writes one name per line so the format only affects the results.
+	const auto* level = GetLevelName(Oulu::SIMD::GetLevel());
+	if (list)
+		format = Format::TEXT;
+	else if (format == Format::CSV)
+		printf("name,level,bytes,iterations,ns_per_op,bytes_per_second,allocations_per_op\n");
+	else if (format == Format::JSON)
+		printf("{\"level\":\"%s\",\"benchmarks\":[", level);
+	else
+		printf("%-48s %12s %14s %12s\n", "Benchmark", "ns/op", "MB/s", "allocs/op");
+
+	auto first = true;
+	for (const auto& benchmark : benchmarks)
+	{
+		if (benchmark.name.find(filter) == std::string::npos)
+			continue;
+
+		if (list)
+		{
+			printf("%s\n", benchmark.name.c_str());
+			continue;
+		}
+
+		const auto result = Measure(benchmark, min_time);
+		switch (format)
+		{
+			case Format::CSV:
+				printf("%s,%s,%zu,%zu,%.3f,%.0f,%.3f\n", benchmark.name.c_str(), level, benchmark.bytes,
+					result.iterations, result.ns_per_op, result.bytes_per_second, result.allocations_per_op);
+				break;
+			case Format::JSON:
+				printf("%s{\"name\":\"%s\",\"bytes\":%zu,\"iterations\":%zu,\"ns_per_op\":%.3f,\"bytes_per_second\":%.0f,\"allocations_per_op\":%.3f}",
+					first ? "" : ",", benchmark.name.c_str(), benchmark.bytes, result.iterations, result.ns_per_op,
+					result.bytes_per_second, result.allocations_per_op);
+				break;
+			case Format::TEXT:
+				printf("%-48s %12.2f %14.2f %12.2f\n", benchmark.name.c_str(), result.ns_per_op,
+					result.bytes_per_second / 1'000'000, result.allocations_per_op);
+				break;
+		}
+		first = false;
+		fflush(stdout);
+	}
+
+	if (format == Format::JSON)
+		printf("]}\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,282 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <oulu/message.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// Characters which are commonly found in tag values including the ones which need escaping.
+	constexpr std::string_view TAG_CHARACTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_. ;\\";
+
+	// Characters which are commonly found in message parameters including the separator.
+	constexpr std::string_view TOKEN_CHARACTERS = "abcdefghijklmnopqrstuvwxyz#    ";
+
+	void RegisterBody(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto plain = Bench::RandomString(size, TOKEN_CHARACTERS);
+
+		// Add a colour code and a bold code every 32 characters.
+		auto formatted = plain;
+		for (size_t idx = formatted.length() & ~size_t(31); idx; idx -= 32)
+			formatted.insert(idx - 1, idx % 64 ? "\x02" : "\x03" "04,12");
+
+		Bench::Register("message/ClassifyBody(plain)" + suffix, plain.length(), [=] {
+			Bench::DoNotOptimize(Oulu::ClassifyBody(plain));
+		});
+		Bench::Register("message/ClassifyBody(formatted)" + suffix, formatted.length(), [=] {
+			Bench::DoNotOptimize(Oulu::ClassifyBody(formatted));
+		});
+		Bench::Register("message/StripFormattingInPlace(plain)" + suffix, plain.length(), [=, buffer = plain]() mutable {
+			Bench::DoNotOptimize(Oulu::StripFormattingInPlace(buffer));
+		});
+		Bench::Register("message/StripFormattingInPlace(formatted)" + suffix, formatted.length(), [=, buffer = formatted]() mutable {
+			buffer.assign(formatted);
+			Bench::DoNotOptimize(Oulu::StripFormattingInPlace(buffer));
+		});
+	}
+
+	void RegisterCTCP(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto ctcp = "\x01" "ACTION " + Bench::RandomString(size, TOKEN_CHARACTERS) + "\x01";
+
+		Bench::Register("message/IsCTCP" + suffix, ctcp.length(), [=] {
+			Bench::DoNotOptimize(Oulu::IsCTCP(ctcp));
+		});
+		Bench::Register("message/ParseCTCP(name)" + suffix, ctcp.length(), [=] {
+			std::string_view name;
+			Bench::DoNotOptimize(Oulu::ParseCTCP(ctcp, name));
+			Bench::DoNotOptimize(name);
+		});
+		Bench::Register("message/ParseCTCP(name,body)" + suffix, ctcp.length(), [=] {
+			std::string_view name;
+			std::string_view body;
+			Bench::DoNotOptimize(Oulu::ParseCTCP(ctcp, name, body));
+			Bench::DoNotOptimize(name);
+			Bench::DoNotOptimize(body);
+		});
+	}
+
+	void RegisterTag(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto unescaped = Bench::RandomString(size, TAG_CHARACTERS);
+		const auto escaped = Oulu::EscapeTag(unescaped);
+
+		Bench::Register("message/EscapeTag" + suffix, unescaped.length(), [=] {
+			Bench::DoNotOptimize(Oulu::EscapeTag(unescaped));
+		});
+		Bench::Register("message/UnescapeTag" + suffix, escaped.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UnescapeTag(escaped));
+		});
+		Bench::Register("message/UnescapeTagInPlace" + suffix, escaped.length(), [=, buffer = escaped]() mutable {
+			buffer.assign(escaped);
+			Bench::DoNotOptimize(Oulu::UnescapeTagInPlace(buffer));
+		});
+
+		// Most tag values don't contain any characters which need escaping.
+		const auto clean = Bench::RandomString(size, TAG_CHARACTERS.substr(0, TAG_CHARACTERS.length() - 3));
+		Bench::Register("message/EscapeTag(clean)" + suffix, clean.length(), [=] {
+			Bench::DoNotOptimize(Oulu::EscapeTag(clean));
+		});
+		Bench::Register("message/EscapeTag(clean,buffer)" + suffix, clean.length(), [=, buffer = std::string()]() mutable {
+			Bench::DoNotOptimize(Oulu::EscapeTag(clean, buffer));
+		});
+		Bench::Register("message/EscapeTag(buffer)" + suffix, unescaped.length(), [=, buffer = std::string()]() mutable {
+			Bench::DoNotOptimize(Oulu::EscapeTag(unescaped, buffer));
+		});
+		Bench::Register("message/UnescapeTag(clean)" + suffix, clean.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UnescapeTag(clean));
+		});
+		Bench::Register("message/UnescapeTag(clean,buffer)" + suffix, clean.length(), [=, buffer = std::string()]() mutable {
+			Bench::DoNotOptimize(Oulu::UnescapeTag(clean, buffer));
+		});
+		Bench::Register("message/UnescapeTag(buffer)" + suffix, escaped.length(), [=, buffer = std::string()]() mutable {
+			Bench::DoNotOptimize(Oulu::UnescapeTag(escaped, buffer));
+		});
+		Bench::Register("message/UnescapeTag(arena)" + suffix, escaped.length(), [=, arena = std::make_shared<Oulu::MessageArena>()] {
+			Bench::DoNotOptimize(Oulu::UnescapeTag(escaped, arena->GetAllocator()));
+			arena->Reset();
+		});
+	}
+
+	void RegisterTagView(size_t size)
+	{
+		// Build a tag block with the tags which are usually looked up at the end.
+		std::string block;
+		for (size_t idx = 0; block.length() < size; ++idx)
+			block.append("+example.com/tag").append(std::to_string(idx)).append("=").append(Bench::RandomString(16, TAG_CHARACTERS)).append(";");
+		block.append("msgid=").append(Bench::RandomString(16, TOKEN_CHARACTERS.substr(0, 26))).append(";time=2024-01-01T00:00:00.000Z");
+
+		const auto suffix = "/" + std::to_string(size);
+		Bench::Register("message/TagView::Get" + suffix, block.length(), [=] {
+			Oulu::TagView tags(block);
+			Bench::DoNotOptimize(tags.Get("msgid"));
+			Bench::DoNotOptimize(tags.Get("time"));
+			Bench::DoNotOptimize(tags.Get("label"));
+		});
+		Bench::Register("message/TagView::Iterator" + suffix, block.length(), [=] {
+			for (const auto& tag : Oulu::TagView(block))
+				Bench::DoNotOptimize(tag);
+		});
+	}
+
+	void RegisterTokenizer(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto middles = Bench::RandomString(size, TOKEN_CHARACTERS);
+		const auto trailing = "PRIVMSG #channel :" + Bench::RandomString(size, TOKEN_CHARACTERS);
+
+		Bench::Register("message/MessageTokenizer::GetMiddle" + suffix, middles.length(), [=] {
+			Oulu::MessageTokenizer tokenizer(middles);
+			std::string_view token;
+			while (tokenizer.GetMiddle(token))
+				Bench::DoNotOptimize(token);
+		});
+		Bench::Register("message/MessageTokenizer::TokenizeAll" + suffix, middles.length(), [=, tokens = std::array<std::string_view, 64>()]() mutable {
+			Oulu::MessageTokenizer tokenizer(middles);
+			while (tokenizer.TokenizeAll(tokens))
+				Bench::DoNotOptimize(tokens);
+		});
+		Bench::Register("message/MessageTokenizer::GetTrailing" + suffix, trailing.length(), [=] {
+			Oulu::MessageTokenizer tokenizer(trailing);
+			std::string_view token;
+			while (tokenizer.GetTrailing(token))
+				Bench::DoNotOptimize(token);
+		});
+	}
+
+	void RegisterLineFramer(size_t size)
+	{
+		// Build a stream of typical lines which is received in chunks of the specified size.
+		std::string stream;
+		while (stream.length() < 16384)
+			stream.append("@msgid=").append(Bench::RandomString(16, TOKEN_CHARACTERS.substr(0, 26))).append(" :nick!user@host PRIVMSG #channel :")
+				.append(Bench::RandomString(stream.length() % 200, TOKEN_CHARACTERS)).append("\r\n");
+
+		const auto suffix = "/" + std::to_string(size);
+		Bench::Register("message/LineFramer" + suffix, stream.length(), [=, framer = Oulu::LineFramer()]() mutable {
+			std::string_view line;
+			for (size_t offset = 0; offset < stream.length(); offset += size)
+			{
+				Bench::DoNotOptimize(framer.Append(std::string_view(stream).substr(offset, size)));
+				while (framer.GetLine(line))
+					Bench::DoNotOptimize(line);
+			}
+		});
+	}
+
+	void RegisterListTokenizer(size_t size)
+	{
+		// Build a list of channels like those sent in a mass JOIN.
+		std::string list;
+		while (list.length() < size)
+			list.append(list.empty() ? "#" : ",#").append(Bench::RandomString(list.length() % 20 + 1, TOKEN_CHARACTERS.substr(0, 26)));
+
+		const auto suffix = "/" + std::to_string(size);
+		Bench::Register("message/ListTokenizer::GetCount" + suffix, list.length(), [=] {
+			Oulu::ListTokenizer tokenizer(list);
+			Bench::DoNotOptimize(tokenizer.GetCount());
+		});
+		Bench::Register("message/ListTokenizer::GetNext" + suffix, list.length(), [=] {
+			Oulu::ListTokenizer tokenizer(list);
+			std::string_view element;
+			while (tokenizer.GetNext(element))
+				Bench::DoNotOptimize(element);
+		});
+	}
+
+	void RegisterMessageBatch(size_t size)
+	{
+		// Build a burst of the specified number of messages like those sent during a netmerge.
+		std::vector<std::string> owned;
+		size_t bytes = 0;
+		for (size_t idx = 0; idx < size; ++idx)
+		{
+			owned.push_back("@time=2024-01-01T00:00:00.000Z :" + Bench::RandomString(9, TOKEN_CHARACTERS.substr(0, 26))
+				+ " UID " + Bench::RandomString(9, TOKEN_CHARACTERS.substr(0, 26)) + " 1700000000 nick host host user 127.0.0.1 1700000000 +i :real name");
+			bytes += owned.back().length();
+		}
+		const std::vector<std::string_view> lines(owned.begin(), owned.end());
+
+		const auto suffix = "/" + std::to_string(size);
+		Bench::Register("message/MessageBatch::Parse" + suffix, bytes, [=, batch = Oulu::MessageBatch()]() mutable {
+			batch.Clear();
+			Bench::DoNotOptimize(batch.Parse(lines));
+		});
+		Bench::Register("message/ParsedMessage::Parse(burst)" + suffix, bytes, [=] {
+			Oulu::ParsedMessage message;
+			for (const auto& line : lines)
+			{
+				Bench::DoNotOptimize(message.Parse(line));
+				Bench::DoNotOptimize(message);
+			}
+		});
+	}
+
+	void RegisterMessageBuilder(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto text = Bench::RandomString(size, TOKEN_CHARACTERS);
+		const auto value = Bench::RandomString(16, TAG_CHARACTERS);
+
+		Bench::Register("message/MessageBuilder::Build" + suffix, text.length(), [=] {
+			Oulu::MessageBuilder builder;
+			builder.SetSource("nick!user@host").SetCommand("PRIVMSG").PushParam("#channel").PushParam(text)
+				.AddTag("msgid", value).AddTag("time", "2024-01-01T00:00:00.000Z").AddTag("+example", value);
+
+			// Simulate delivering to clients with each set of capabilities.
+			for (size_t idx = 0; idx < 100; ++idx)
+				Bench::DoNotOptimize(idx % 2 ? builder.Build() : builder.BuildWithoutTags());
+		});
+	}
+
+	void RegisterParsedMessage(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto line = "@msgid=" + Bench::RandomString(size, TOKEN_CHARACTERS.substr(0, 26)) + " :nick!user@host PRIVMSG #channel :hello world";
+
+		Bench::Register("message/ParsedMessage::Parse" + suffix, line.length(), [=] {
+			Oulu::ParsedMessage message;
+			Bench::DoNotOptimize(message.Parse(line));
+			Bench::DoNotOptimize(message);
+		});
+
+		// Build a mode change with as many list modes as fit in the parameter limit.
+		const auto count = std::clamp<size_t>(size / 16, 1, 13);
+		auto mode = ":nick!user@host MODE #channel +" + std::string(count, 'b');
+		for (size_t idx = 0; idx < count; ++idx)
+			mode.append(" ").append(Bench::RandomString(size / count + idx, TOKEN_CHARACTERS.substr(0, 26)));
+
+		Bench::Register("message/ParsedMessage::Parse(params)" + suffix, mode.length(), [=] {
+			Oulu::ParsedMessage message;
+			Bench::DoNotOptimize(message.Parse(mode));
+			Bench::DoNotOptimize(message);
+		});
+	}
+
+	[[maybe_unused]] const auto registered = [] {
+		for (const auto size : Bench::SIZES)
+		{
+			RegisterBody(size);
+			RegisterCTCP(size);
+			RegisterLineFramer(size);
+			RegisterListTokenizer(size);
+			RegisterMessageBatch(size);
+			RegisterMessageBuilder(size);
+			RegisterParsedMessage(size);
+			RegisterTag(size);
+			RegisterTagView(size);
+			RegisterTokenizer(size);
+		}
+		return true;
+	}();
+}
@@ -0,0 +1,48 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <memory>
+#include <vector>
+
+#include <oulu/mode.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// The characters which are used in nicks.
+	constexpr std::string_view NICK_CHARACTERS = "abcdefghijklmnopqrstuvwxyz";
+
+	void RegisterMode(size_t size)
+	{
+		// Build a mode line like those sent during a netburst with the specified number of changes.
+		const auto table = std::make_shared<const Oulu::ModeTable>("beI,k,l,imnpst", "(qaohv)~&@%+");
+		const auto nicks = Bench::RandomString(size * 9, NICK_CHARACTERS);
+		std::string letters = "+";
+		std::string params;
+		for (size_t idx = 0; idx < size; ++idx)
+		{
+			letters.push_back("ovbh"[idx % 4]);
+			params.append(" ").append(nicks, idx * 9, 9);
+		}
+		const auto modes = letters + params;
+
+		std::vector<Oulu::ModeChange> changes(size);
+		changes.resize(table->Parse(modes, changes));
+
+		const auto suffix = "/" + std::to_string(size);
+		Bench::Register("mode/ModeTable::Parse" + suffix, modes.length(), [=, parsed = std::vector<Oulu::ModeChange>(size)]() mutable {
+			Bench::DoNotOptimize(table->Parse(modes, parsed));
+			Bench::DoNotOptimize(parsed);
+		});
+		Bench::Register("mode/ModeTable::Serialize" + suffix, modes.length(), [=] {
+			Bench::DoNotOptimize(table->Serialize(changes, 12, 400));
+		});
+	}
+
+	[[maybe_unused]] const auto registered = [] {
+		for (const auto size : Bench::SIZES)
+			RegisterMode(size);
+		return true;
+	}();
+}
@@ -0,0 +1,47 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <string>
+
+#include <oulu/utf8.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+	// Characters which are commonly found in message bodies that are not in English.
+	const std::string_view MIXED_PIECES[] = {
+		"hello ", "world ", "caf\xC3\xA9 ", "\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 ",
+		"\xE4\xBD\xA0\xE5\xA5\xBD ", "\xF0\x9F\x98\x80 ",
+	};
+
+	void RegisterUTF8(size_t size)
+	{
+		const auto suffix = "/" + std::to_string(size);
+		const auto ascii = Bench::RandomString(size);
+
+		std::string mixed;
+		for (size_t idx = 0; mixed.length() < size; ++idx)
+			mixed.append(MIXED_PIECES[idx % std::size(MIXED_PIECES)]);
+		mixed = std::string(Oulu::UTF8::Truncate(mixed, size));
+
+		Bench::Register("utf8/IsValid/ascii" + suffix, ascii.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UTF8::IsValid(ascii));
+		});
+		Bench::Register("utf8/IsValid/mixed" + suffix, mixed.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UTF8::IsValid(mixed));
+		});
+		Bench::Register("utf8/Truncate/codepoint" + suffix, mixed.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UTF8::Truncate(mixed, mixed.length() / 2 + 1));
+		});
+		Bench::Register("utf8/Truncate/grapheme" + suffix, mixed.length(), [=] {
+			Bench::DoNotOptimize(Oulu::UTF8::Truncate(mixed, mixed.length() / 2 + 1, Oulu::UTF8::Boundary::GRAPHEME));
+		});
+	}
+
+	[[maybe_unused]] const auto registered = [] {
+		for (const auto size : Bench::SIZES)
+			RegisterUTF8(size);
+		return true;
+	}();
+}
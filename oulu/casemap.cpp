@@ -0,0 +1,100 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <oulu/casemap.hpp>
+#include <oulu/simd.hpp>
+#include <oulu/stats.hpp>
+
+namespace
+{
+#ifdef OULU_ARCH_X86
+	OULU_ATTR_TARGET("sse4.1")
+	size_t FoldCaseSSE41(const char* data, size_t length, char* out, char last)
+	{
+		// Characters above 0x7F are negative so they are never in the folded range.
+		const auto before_first = _mm_set1_epi8('A' - 1);
+		const auto after_last = _mm_set1_epi8(static_cast<char>(last + 1));
+		const auto bit = _mm_set1_epi8(0x20);
+		for (size_t idx = 0; idx + 16 <= length; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto folded = _mm_and_si128(_mm_cmpgt_epi8(input, before_first), _mm_cmplt_epi8(input, after_last));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + idx), _mm_or_si128(input, _mm_and_si128(folded, bit)));
+		}
+		return length - (length % 16);
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t FoldCaseAVX2(const char* data, size_t length, char* out, char last)
+	{
+		// Characters above 0x7F are negative so they are never in the folded range.
+		const auto before_first = _mm256_set1_epi8('A' - 1);
+		const auto after_last = _mm256_set1_epi8(static_cast<char>(last + 1));
+		const auto bit = _mm256_set1_epi8(0x20);
+		for (size_t idx = 0; idx + 32 <= length; idx += 32)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto folded = _mm256_and_si256(_mm256_cmpgt_epi8(input, before_first), _mm256_cmpgt_epi8(after_last, input));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + idx), _mm256_or_si256(input, _mm256_and_si256(folded, bit)));
+		}
+		return length - (length % 32);
+	}
+#endif
+
+	// Folds a string into a buffer which is at least as long as it. The buffer may be the string.
+	void FoldCaseRaw(const char* data, size_t length, char* out, const Oulu::CaseMapping& casemap)
+	{
+		size_t idx = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				idx = FoldCaseAVX2(data, length, out, casemap.GetLast());
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				idx += FoldCaseSSE41(data + idx, length - idx, out + idx, casemap.GetLast());
+				break;
+#endif
+			default:
+				break;
+		}
+
+		// Fold the tail eight characters at a time using SWAR (SIMD within a register).
+		for ( ; idx + 8 <= length; idx += 8)
+		{
+			const auto word = casemap.FoldWord(Oulu::CaseMapping::LoadWord(data + idx, 8));
+			memcpy(out + idx, &word, sizeof(word));
+		}
+
+		for ( ; idx < length; ++idx)
+			out[idx] = casemap.Fold(data[idx]);
+	}
+}
+
+std::string Oulu::FoldCase(const std::string_view& str, const CaseMapping& casemap)
+{
+	OULU_STATS_CALL(FOLD_CASE, str.length());
+	std::string out(str.length(), '\0');
+	FoldCaseRaw(str.data(), str.length(), out.data(), casemap);
+	return out;
+}
+
+std::string_view Oulu::FoldCaseInPlace(std::span<char> str, const CaseMapping& casemap)
+{
+	OULU_STATS_CALL(FOLD_CASE, str.size());
+	FoldCaseRaw(str.data(), str.size(), str.data(), casemap);
+	return { str.data(), str.size() };
+}
+
+std::optional<size_t> Oulu::FoldCaseTo(std::span<char> out, const std::string_view& str, const CaseMapping& casemap)
+{
+	OULU_STATS_CALL(FOLD_CASE, str.length());
+	if (out.size() < str.length())
+	{
+		OULU_STATS_FAILURE(FOLD_CASE);
+		return std::nullopt;
+	}
+
+	FoldCaseRaw(str.data(), str.length(), out.data(), casemap);
+	return str.length();
+}
@@ -0,0 +1,231 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Oulu
+{
+	class CaseEqual;
+	class CaseHash;
+	class CaseMapping;
+}
+
+/** CaseMapping describes how characters are folded when comparing names case-insensitively. All of
+ * the casemappings used by IRC fold a contiguous range of characters starting at 'A' to the
+ * characters 32 code points above them.
+ */
+class Oulu::CaseMapping final
+{
+private:
+	/** The last character which is folded. */
+	char last;
+
+	/** The folded form of every character. */
+	std::array<char, 256> table = { };
+
+public:
+	/** Creates a CaseMapping which folds the characters from 'A' up to and including a character.
+	 * \param l The last character which is folded. This must be from 'A' to '^'.
+	 */
+	explicit constexpr CaseMapping(char l)
+		: last(l)
+	{
+		for (size_t idx = 0; idx < table.size(); ++idx)
+		{
+			const auto chr = static_cast<char>(idx);
+			table[idx] = chr >= 'A' && chr <= last ? static_cast<char>(chr + 32) : chr;
+		}
+	}
+
+	/** Determines whether two strings are equal after folding.
+	 * \param lhs The first string to compare.
+	 * \param rhs The second string to compare.
+	 * \return True if the strings are equal; otherwise, false.
+	 */
+	bool Equals(const std::string_view& lhs, const std::string_view& rhs) const
+	{
+		if (lhs.length() != rhs.length())
+			return false;
+
+		size_t idx = 0;
+		for ( ; idx + 8 <= lhs.length(); idx += 8)
+		{
+			if (FoldWord(LoadWord(lhs.data() + idx, 8)) != FoldWord(LoadWord(rhs.data() + idx, 8)))
+				return false;
+		}
+
+		if (idx == lhs.length())
+			return true;
+
+		// Compare the tail with an overlapping load if possible to avoid a variable length copy.
+		if (idx)
+			idx = lhs.length() - 8;
+		const auto remaining = lhs.length() - idx;
+		return FoldWord(LoadWord(lhs.data() + idx, remaining)) == FoldWord(LoadWord(rhs.data() + idx, remaining));
+	}
+
+	/** Folds a character.
+	 * \param chr The character to fold.
+	 * \return The folded form of the character.
+	 */
+	constexpr char Fold(char chr) const { return table[static_cast<uint8_t>(chr)]; }
+
+	/** Folds eight characters which have been packed into a word at once.
+	 * \param word The characters to fold.
+	 * \return The folded form of the characters.
+	 */
+	constexpr uint64_t FoldWord(uint64_t word) const
+	{
+		// Set the high bit of every byte which is from 'A' to the last folded character. Adding to
+		// the low seven bits of each byte can't carry into the next one.
+		const auto ones = uint64_t(0x0101010101010101);
+		const auto low = word & (ones * 0x7F);
+		const auto after_first = low + ones * (0x80 - 'A');
+		const auto after_last = low + ones * (0x7F - static_cast<uint8_t>(last));
+		const auto folded = after_first & ~after_last & ~word & (ones * 0x80);
+		return word | (folded >> 2);
+	}
+
+	/** Retrieves the last character which is folded. */
+	constexpr char GetLast() const { return last; }
+
+	/** Hashes a string after folding it without making a folded copy.
+	 * \param str The string to hash.
+	 * \return The hash of the folded string.
+	 */
+	size_t Hash(const std::string_view& str) const
+	{
+		auto hash = uint64_t(0x9E3779B97F4A7C15) ^ str.length();
+		size_t idx = 0;
+		for ( ; idx + 8 <= str.length(); idx += 8)
+			hash = MixWord(hash, FoldWord(LoadWord(str.data() + idx, 8)));
+
+		if (idx < str.length())
+		{
+			// Hash the tail with an overlapping load if possible to avoid a variable length copy.
+			if (idx)
+				idx = str.length() - 8;
+			hash = MixWord(hash, FoldWord(LoadWord(str.data() + idx, str.length() - idx)));
+		}
+
+		// Finalise the hash so that every bit of input affects the low bits.
+		hash ^= hash >> 33;
+		hash *= uint64_t(0xFF51AFD7ED558CCD);
+		hash ^= hash >> 33;
+		return static_cast<size_t>(hash);
+	}
+
+	/** Loads up to eight characters into a word. Any bytes which are not loaded are zero.
+	 * \param data The characters to load.
+	 * \param length The number of characters to load.
+	 * \return A word containing the characters.
+	 */
+	static uint64_t LoadWord(const char* data, size_t length)
+	{
+		uint64_t word = 0;
+		memcpy(&word, data, length);
+		return word;
+	}
+
+	/** Mixes a word into a hash.
+	 * \param hash The hash to mix into.
+	 * \param word The word to mix in.
+	 * \return The new hash.
+	 */
+	static constexpr uint64_t MixWord(uint64_t hash, uint64_t word)
+	{
+		hash = (hash ^ word) * uint64_t(0xBF58476D1CE4E5B9);
+		return hash ^ (hash >> 31);
+	}
+};
+
+namespace Oulu
+{
+	/** The casemapping which only folds the ASCII letters. */
+	inline constexpr CaseMapping ASCII_CASEMAPPING('Z');
+
+	/** The casemapping from RFC 1459 which folds the ASCII letters and "[]\^" to "{}|~". */
+	inline constexpr CaseMapping RFC1459_CASEMAPPING('^');
+
+	/** The casemapping from RFC 1459 which folds the ASCII letters and "[]\" to "{}|". */
+	inline constexpr CaseMapping STRICT_RFC1459_CASEMAPPING(']');
+
+	/** Folds a string to its case-insensitive form.
+	 * \param str The string to fold.
+	 * \param casemap The casemapping to fold with.
+	 * \return The folded form of the string.
+	 */
+	std::string FoldCase(const std::string_view& str, const CaseMapping& casemap = RFC1459_CASEMAPPING);
+
+	/** Folds a string to its case-insensitive form in place.
+	 * \param str The string to fold.
+	 * \param casemap The casemapping to fold with.
+	 * \return A view of the folded string.
+	 */
+	std::string_view FoldCaseInPlace(std::span<char> str, const CaseMapping& casemap = RFC1459_CASEMAPPING);
+
+	/** Folds a string to its case-insensitive form into a caller-provided buffer.
+	 * \param out The buffer to write the folded form to. This must be at least as long as the string.
+	 * \param str The string to fold.
+	 * \param casemap The casemapping to fold with.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> FoldCaseTo(std::span<char> out, const std::string_view& str, const CaseMapping& casemap = RFC1459_CASEMAPPING);
+}
+
+/** CaseEqual is a transparent equality functor which compares strings after folding them. */
+class Oulu::CaseEqual final
+{
+private:
+	/** The casemapping to fold with. */
+	const CaseMapping* casemap;
+
+public:
+	/** Allows looking up string keys using string views. */
+	using is_transparent = void;
+
+	/** Creates a CaseEqual which folds with the specified casemapping. */
+	constexpr CaseEqual(const CaseMapping& c = RFC1459_CASEMAPPING)
+		: casemap(&c)
+	{
+	}
+
+	/** Determines whether two strings are equal after folding. */
+	bool operator()(const std::string_view& lhs, const std::string_view& rhs) const
+	{
+		return casemap->Equals(lhs, rhs);
+	}
+};
+
+/** CaseHash is a transparent hash functor which hashes strings after folding them. */
+class Oulu::CaseHash final
+{
+private:
+	/** The casemapping to fold with. */
+	const CaseMapping* casemap;
+
+public:
+	/** Allows looking up string keys using string views. */
+	using is_transparent = void;
+
+	/** Creates a CaseHash which folds with the specified casemapping. */
+	constexpr CaseHash(const CaseMapping& c = RFC1459_CASEMAPPING)
+		: casemap(&c)
+	{
+	}
+
+	/** Hashes a string after folding it. */
+	size_t operator()(const std::string_view& str) const
+	{
+		return casemap->Hash(str);
+	}
+};
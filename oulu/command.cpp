@@ -0,0 +1,175 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+
+#include <oulu/command.hpp>
+#include <oulu/stats.hpp>
+
+namespace
+{
+	// The names of the commands indexed by their identifier.
+	constexpr std::string_view COMMAND_NAMES[] = {
+		"",
+		"ACCOUNT",
+		"ACK",
+		"ADMIN",
+		"AUTHENTICATE",
+		"AWAY",
+		"BATCH",
+		"CAP",
+		"CHGHOST",
+		"CONNECT",
+		"DIE",
+		"ERROR",
+		"FAIL",
+		"HELP",
+		"INFO",
+		"INVITE",
+		"ISON",
+		"JOIN",
+		"KICK",
+		"KILL",
+		"KNOCK",
+		"LINKS",
+		"LIST",
+		"LUSERS",
+		"MODE",
+		"MONITOR",
+		"MOTD",
+		"NAMES",
+		"NICK",
+		"NOTE",
+		"NOTICE",
+		"OPER",
+		"PART",
+		"PASS",
+		"PING",
+		"PONG",
+		"PRIVMSG",
+		"QUIT",
+		"REHASH",
+		"RESTART",
+		"SERVICE",
+		"SERVLIST",
+		"SETNAME",
+		"SQUERY",
+		"SQUIT",
+		"STATS",
+		"SUMMON",
+		"TAGMSG",
+		"TIME",
+		"TOPIC",
+		"TRACE",
+		"USER",
+		"USERHOST",
+		"USERS",
+		"VERSION",
+		"WALLOPS",
+		"WARN",
+		"WEBIRC",
+		"WHO",
+		"WHOIS",
+		"WHOWAS",
+	};
+	static_assert(std::size(COMMAND_NAMES) == static_cast<size_t>(Oulu::Command::NUMERIC));
+
+	// The number of slots in the command hash table. This must be a power of two.
+	constexpr size_t HASH_TABLE_SIZE = 512;
+
+	// The minimum and maximum lengths of a named command.
+	constexpr size_t MIN_COMMAND_LENGTH = 3;
+	constexpr size_t MAX_COMMAND_LENGTH = 12;
+
+	// Folds an ASCII letter to upper case. Other characters are changed but never to a letter.
+	constexpr uint8_t FoldCase(char chr)
+	{
+		return static_cast<uint8_t>(chr) & 0xDF;
+	}
+
+	// Hashes a command which is at least MIN_COMMAND_LENGTH characters long to a slot in the hash
+	// table. Only the length and a few characters are mixed in so this doesn't need a loop.
+	constexpr size_t HashCommand(const std::string_view& name, uint32_t seed)
+	{
+		auto hash = seed;
+		for (const auto value : { static_cast<uint8_t>(name.length()), FoldCase(name[0]), FoldCase(name[1]),
+			FoldCase(name[2]), FoldCase(name[name.length() / 2]), FoldCase(name.back()) })
+		{
+			hash = (hash ^ value) * uint32_t(0x01000193);
+		}
+		return (hash >> 16) & (HASH_TABLE_SIZE - 1);
+	}
+
+	// Finds a seed for which every named command hashes to a different slot.
+	constexpr uint32_t FindHashSeed()
+	{
+		for (uint32_t seed = 0x811C9DC5; seed < 0x811C9DC5 + 100'000; ++seed)
+		{
+			std::array<bool, HASH_TABLE_SIZE> used = { };
+			auto collided = false;
+			for (size_t idx = 1; idx < std::size(COMMAND_NAMES) && !collided; ++idx)
+			{
+				auto& slot = used[HashCommand(COMMAND_NAMES[idx], seed)];
+				collided = slot;
+				slot = true;
+			}
+
+			if (!collided)
+				return seed;
+		}
+		return 0;
+	}
+
+	// The seed which makes HashCommand a perfect hash of the named commands.
+	constexpr auto HASH_SEED = FindHashSeed();
+	static_assert(HASH_SEED, "Unable to find a perfect hash of the command names!");
+
+	// The identifiers of the named commands indexed by their hash.
+	constexpr auto HASH_TABLE = [] {
+		std::array<uint8_t, HASH_TABLE_SIZE> table = { };
+		for (size_t idx = 1; idx < std::size(COMMAND_NAMES); ++idx)
+			table[HashCommand(COMMAND_NAMES[idx], HASH_SEED)] = static_cast<uint8_t>(idx);
+		return table;
+	}();
+}
+
+Oulu::IdentifiedCommand Oulu::IdentifyCommand(const std::string_view& name)
+{
+	OULU_STATS_CALL(IDENTIFY_COMMAND, name.length());
+	if (name.length() == 3)
+	{
+		// Check whether this is a numeric.
+		const auto digit1 = static_cast<uint8_t>(name[0] - '0');
+		const auto digit2 = static_cast<uint8_t>(name[1] - '0');
+		const auto digit3 = static_cast<uint8_t>(name[2] - '0');
+		if ((digit1 < 10) & (digit2 < 10) & (digit3 < 10))
+			return { MakeNumeric(static_cast<uint16_t>(digit1 * 100 + digit2 * 10 + digit3)), name };
+	}
+
+	if (name.length() < MIN_COMMAND_LENGTH || name.length() > MAX_COMMAND_LENGTH)
+	{
+		OULU_STATS_FAILURE(IDENTIFY_COMMAND);
+		return { Command::UNKNOWN, name };
+	}
+
+	// Empty slots have an empty name so they will never match.
+	const auto id = HASH_TABLE[HashCommand(name, HASH_SEED)];
+	const auto& candidate = COMMAND_NAMES[id];
+	if (candidate.length() != name.length())
+	{
+		OULU_STATS_FAILURE(IDENTIFY_COMMAND);
+		return { Command::UNKNOWN, name };
+	}
+
+	uint8_t difference = 0;
+	for (size_t idx = 0; idx < name.length(); ++idx)
+		difference |= FoldCase(name[idx]) ^ static_cast<uint8_t>(candidate[idx]);
+
+	if (difference)
+	{
+		OULU_STATS_FAILURE(IDENTIFY_COMMAND);
+		return { Command::UNKNOWN, name };
+	}
+
+	return { static_cast<Command>(id), candidate };
+}
@@ -0,0 +1,142 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Oulu
+{
+	class IdentifiedCommand;
+
+	/** The commands which can be identified by IdentifyCommand. Numerics are represented by NUMERIC
+	 * plus the value of the numeric so every command has a dense identifier which can be used to
+	 * index a dispatch table.
+	 */
+	enum class Command
+		: uint16_t
+	{
+		/** A command which is not known. */
+		UNKNOWN,
+
+		ACCOUNT,
+		ACK,
+		ADMIN,
+		AUTHENTICATE,
+		AWAY,
+		BATCH,
+		CAP,
+		CHGHOST,
+		CONNECT,
+		DIE,
+		ERROR,
+		FAIL,
+		HELP,
+		INFO,
+		INVITE,
+		ISON,
+		JOIN,
+		KICK,
+		KILL,
+		KNOCK,
+		LINKS,
+		LIST,
+		LUSERS,
+		MODE,
+		MONITOR,
+		MOTD,
+		NAMES,
+		NICK,
+		NOTE,
+		NOTICE,
+		OPER,
+		PART,
+		PASS,
+		PING,
+		PONG,
+		PRIVMSG,
+		QUIT,
+		REHASH,
+		RESTART,
+		SERVICE,
+		SERVLIST,
+		SETNAME,
+		SQUERY,
+		SQUIT,
+		STATS,
+		SUMMON,
+		TAGMSG,
+		TIME,
+		TOPIC,
+		TRACE,
+		USER,
+		USERHOST,
+		USERS,
+		VERSION,
+		WALLOPS,
+		WARN,
+		WEBIRC,
+		WHO,
+		WHOIS,
+		WHOWAS,
+
+		/** The first numeric. This is followed by an identifier for every numeric from 000 to 999. */
+		NUMERIC,
+	};
+
+	/** The number of numerics which can be identified. */
+	inline constexpr size_t NUMERIC_COUNT = 1000;
+
+	/** The number of command identifiers including UNKNOWN and every numeric. */
+	inline constexpr size_t COMMAND_COUNT = static_cast<size_t>(Command::NUMERIC) + NUMERIC_COUNT;
+
+	/** Retrieves the numeric value of a numeric command.
+	 * \param command The command to retrieve the numeric value of.
+	 * \return The numeric value of the command which is only valid if IsNumeric returns true.
+	 */
+	constexpr uint16_t GetNumeric(Command command)
+	{
+		return static_cast<uint16_t>(static_cast<uint16_t>(command) - static_cast<uint16_t>(Command::NUMERIC));
+	}
+
+	/** Identifies a command in the IRC wire format. Commands are matched case-insensitively.
+	 * \param name The command to identify.
+	 * \return The identifier of the command and its name. If the command is known then the name is
+	 *         the canonical upper-case name; otherwise, it is the name which was passed.
+	 */
+	IdentifiedCommand IdentifyCommand(const std::string_view& name);
+
+	/** Determines whether a command is a numeric.
+	 * \param command The command to check.
+	 * \return True if the command is a numeric; otherwise, false.
+	 */
+	constexpr bool IsNumeric(Command command)
+	{
+		return command >= Command::NUMERIC;
+	}
+
+	/** Creates the identifier of a numeric command.
+	 * \param numeric The value of the numeric which must be less than NUMERIC_COUNT.
+	 * \return The identifier of the numeric command.
+	 */
+	constexpr Command MakeNumeric(uint16_t numeric)
+	{
+		return static_cast<Command>(static_cast<uint16_t>(Command::NUMERIC) + numeric);
+	}
+}
+
+/** IdentifiedCommand is the result of identifying a command. */
+class Oulu::IdentifiedCommand final
+{
+public:
+	/** The identifier of the command or Command::UNKNOWN if it is not known. */
+	Command id;
+
+	/** The name of the command. */
+	std::string_view name;
+
+	/** Determines whether the command is known. */
+	explicit operator bool() const { return id != Command::UNKNOWN; }
+};
@@ -1,195 +1,1328 @@
 // Oulu <https://github.com/inspircd/liboulu/>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstring>
 #include <cstdint>
 
 #include <oulu/encoding.hpp>
+#include <oulu/simd.hpp>
+#include <oulu/stats.hpp>
 
-std::string Oulu::Base64Decode(const void* data, size_t length, const char* table)
+namespace
 {
-	if (!table)
-		table = Oulu::BASE64_TABLE;
+	// The number of octets which Base64-encoded blocks of input are processed in by the SIMD kernels.
+	constexpr size_t BASE64_BLOCK_SIZE = 32;
 
-	// Preallocate the output buffer to avoid constant reallocations.
-	std::string buffer;
-	buffer.reserve((length / 4) * 3);
+	// The minimum length of data which is worth handing to the hexadecimal SIMD kernels.
+	constexpr size_t HEX_BLOCK_SIZE = 32;
 
-	uint32_t current_bits = 0;
-	size_t seen_bits = 0;
+	// The minimum length of data which is worth handing to the percent encoding SIMD kernels.
+	constexpr size_t PERCENT_BLOCK_SIZE = 16;
 
-	const auto* cdata = static_cast<const char*>(data);
-	for (size_t idx = 0; idx < length; ++idx)
+	// Determines whether a table is the regular Base64 table with possibly different characters for
+	// the last two indices. Tables like this can be handled by the SIMD kernels.
+	bool IsBase64Variant(const Oulu::Base64Table& btable)
 	{
-		// Attempt to find the octet in the table.
-		const auto* chr = strchr(table, cdata[idx]);
-		if (!chr)
-			continue; // Skip invalid octets.
+		if (&btable == &Oulu::BASE64_TABLE || &btable == &Oulu::BASE64_URL_TABLE)
+			return true;
 
-		// Add the bits for this octet to the active buffer.
-		current_bits = (current_bits << 6) | uint32_t(chr - table);
-		seen_bits += 6;
+		const auto* table = btable.GetCharacters();
+		if (strncmp(table, Oulu::BASE64_TABLE, 62) || !table[62] || !table[63] || table[64])
+			return false;
 
-		if (seen_bits >= 8)
+		// The last two characters must be distinct and not already be in the table.
+		const auto chr62 = table[62];
+		const auto chr63 = table[63];
+		return chr62 != chr63 && !memchr(table, chr62, 62) && !memchr(table, chr63, 62);
+	}
+
+	// Determines whether a table decodes the regular hexadecimal digits in either case. Tables like
+	// this can be handled by the SIMD kernels.
+	bool IsHexVariant(const Oulu::HexTable& table)
+	{
+		if (&table == &Oulu::HEX_TABLE_LOWER || &table == &Oulu::HEX_TABLE_UPPER)
+			return true;
+
+		for (uint8_t idx = 0; idx < 16; ++idx)
 		{
-			// We have seen an entire octet; add it to the buffer.
-			seen_bits -= 8;
-			buffer.push_back((current_bits >> seen_bits) & 0xFF);
+			if (table.Decode(Oulu::HEX_TABLE_LOWER.Encode(idx)) != idx || table.Decode(Oulu::HEX_TABLE_UPPER.Encode(idx)) != idx)
+				return false;
 		}
+		return true;
 	}
 
-	return buffer;
+#ifdef OULU_ARCH_X86
+	OULU_ATTR_TARGET("sse4.1")
+	inline __m128i Base64EncodeLookupSSE41(__m128i indices, __m128i shift_table)
+	{
+		// Map each index to the offset which needs to be added to it to get its character:
+		//   0-25  => 13 ('A')
+		//   26-51 => 0  ('a')
+		//   52-61 => 1-10 ('0')
+		//   62    => 11 (chr62)
+		//   63    => 12 (chr63)
+		auto shift = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		const auto upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+		shift = _mm_or_si128(shift, _mm_and_si128(upper, _mm_set1_epi8(13)));
+		return _mm_add_epi8(indices, _mm_shuffle_epi8(shift_table, shift));
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	inline __m128i Base64EncodeShiftTableSSE41(char chr62, char chr63)
+	{
+		return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, static_cast<char>(chr62 - 62),
+			static_cast<char>(chr63 - 63), 'A', 0, 0);
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t Base64EncodeSSE41(const uint8_t* data, size_t length, char* out, char chr62, char chr63)
+	{
+		const auto shift_table = Base64EncodeShiftTableSSE41(chr62, chr63);
+		const auto shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+		// Each iteration reads 16 octets but only encodes the first 12 of them.
+		size_t idx = 0;
+		for ( ; idx + 16 <= length; idx += 12, out += 16)
+		{
+			// Split every three octets into four 6-bit indices, one per byte.
+			auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			input = _mm_shuffle_epi8(input, shuffle);
+			const auto bits1 = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+			const auto bits2 = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+			const auto indices = _mm_or_si128(bits1, bits2);
+
+			const auto output = Base64EncodeLookupSSE41(indices, shift_table);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), output);
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t Base64EncodeAVX2(const uint8_t* data, size_t length, char* out, char chr62, char chr63)
+	{
+		const auto shift_table = _mm256_broadcastsi128_si256(Base64EncodeShiftTableSSE41(chr62, chr63));
+		const auto shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+		// Each iteration reads 28 octets but only encodes the first 24 of them.
+		size_t idx = 0;
+		for ( ; idx + 28 <= length; idx += 24, out += 32)
+		{
+			// Load twelve octets into each lane and split them into 6-bit indices.
+			const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx + 12));
+			auto input = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+			input = _mm256_shuffle_epi8(input, shuffle);
+			const auto bits1 = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+			const auto bits2 = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+			const auto indices = _mm256_or_si256(bits1, bits2);
+
+			auto shift = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			const auto upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+			shift = _mm256_or_si256(shift, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+			const auto output = _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift_table, shift));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), output);
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t Base64DecodeSSE41(const char* data, size_t length, uint8_t* out, char chr62, char chr63)
+	{
+		const auto pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+		size_t idx = 0;
+		for ( ; idx + 16 <= length; idx += 16, out += 12)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+
+			// Classify the characters and bail out if any of them are padding or invalid.
+			const auto upper = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('Z' + 1)));
+			const auto lower = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('z' + 1)));
+			const auto digit = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+			const auto is62 = _mm_cmpeq_epi8(input, _mm_set1_epi8(chr62));
+			const auto is63 = _mm_cmpeq_epi8(input, _mm_set1_epi8(chr63));
+			const auto valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+			if (_mm_movemask_epi8(valid) != 0xFFFF)
+				break;
+
+			// Convert the characters to their 6-bit indices.
+			const auto shift = _mm_or_si128(_mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+				_mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))), _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+			auto indices = _mm_add_epi8(input, shift);
+			indices = _mm_blendv_epi8(indices, _mm_set1_epi8(62), is62);
+			indices = _mm_blendv_epi8(indices, _mm_set1_epi8(63), is63);
+
+			// Join every four indices into three octets.
+			const auto merged = _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+			const auto joined = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+			const auto output = _mm_shuffle_epi8(joined, pack);
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), output);
+			const auto tail = _mm_extract_epi32(output, 2);
+			memcpy(out + 8, &tail, sizeof(tail));
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t Base64DecodeAVX2(const char* data, size_t length, uint8_t* out, char chr62, char chr63)
+	{
+		const auto pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const auto join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+		size_t idx = 0;
+		for ( ; idx + 32 <= length; idx += 32, out += 24)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+
+			// Classify the characters and bail out if any of them are padding or invalid.
+			const auto upper = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), input));
+			const auto lower = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), input));
+			const auto digit = _mm256_and_si256(_mm256_cmpgt_epi8(input, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), input));
+			const auto is62 = _mm256_cmpeq_epi8(input, _mm256_set1_epi8(chr62));
+			const auto is63 = _mm256_cmpeq_epi8(input, _mm256_set1_epi8(chr63));
+			const auto valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+			if (_mm256_movemask_epi8(valid) != -1)
+				break;
+
+			// Convert the characters to their 6-bit indices.
+			const auto shift = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+				_mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a'))), _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+			auto indices = _mm256_add_epi8(input, shift);
+			indices = _mm256_blendv_epi8(indices, _mm256_set1_epi8(62), is62);
+			indices = _mm256_blendv_epi8(indices, _mm256_set1_epi8(63), is63);
+
+			// Join every four indices into three octets and move them to the start of the register.
+			const auto merged = _mm256_maddubs_epi16(indices, _mm256_set1_epi32(0x01400140));
+			const auto joined = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+			const auto output = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(joined, pack), join);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(output));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_extracti128_si256(output, 1));
+		}
+		return idx;
+	}
+
+	// Converts hexadecimal digits in either case to their values and sets invalid to any lanes
+	// which do not contain a hexadecimal digit.
+	OULU_ATTR_TARGET("sse4.1")
+	inline __m128i HexDecodeDigitsSSE41(__m128i input, __m128i& invalid)
+	{
+		const auto digit = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+		const auto letter = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		const auto is_digit = _mm_cmpeq_epi8(_mm_max_epu8(digit, _mm_set1_epi8(9)), _mm_set1_epi8(9));
+		const auto is_letter = _mm_cmpeq_epi8(_mm_max_epu8(letter, _mm_set1_epi8(5)), _mm_set1_epi8(5));
+		invalid = _mm_or_si128(invalid, _mm_xor_si128(_mm_or_si128(is_digit, is_letter), _mm_set1_epi8(-1)));
+		return _mm_blendv_epi8(_mm_add_epi8(letter, _mm_set1_epi8(10)), digit, is_digit);
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t HexDecodeSSE41(const char* data, size_t length, uint8_t* out, char separator)
+	{
+		size_t idx = 0;
+		if (separator)
+		{
+			// Each iteration decodes eight segments of two digits followed by a separator.
+			const auto sep = _mm_set1_epi8(separator);
+			const auto gather = _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1);
+			for ( ; idx + 28 <= length; idx += 24, out += 8)
+			{
+				const auto input1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+				const auto input2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx + 12));
+				const auto separators = _mm_movemask_epi8(_mm_cmpeq_epi8(input1, sep)) & _mm_movemask_epi8(_mm_cmpeq_epi8(input2, sep));
+				if ((separators & 0x924) != 0x924)
+					break;
+
+				auto invalid = _mm_setzero_si128();
+				const auto digits = _mm_unpacklo_epi64(_mm_shuffle_epi8(input1, gather), _mm_shuffle_epi8(input2, gather));
+				const auto values = HexDecodeDigitsSSE41(digits, invalid);
+				if (_mm_movemask_epi8(invalid))
+					break;
+
+				const auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(pairs, pairs));
+			}
+		}
+		else
+		{
+			// Each iteration decodes sixteen digits into eight octets.
+			for ( ; idx + 16 <= length; idx += 16, out += 8)
+			{
+				auto invalid = _mm_setzero_si128();
+				const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+				const auto values = HexDecodeDigitsSSE41(input, invalid);
+				if (_mm_movemask_epi8(invalid))
+					break;
+
+				const auto pairs = _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(pairs, pairs));
+			}
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t HexDecodeAVX2(const char* data, size_t length, uint8_t* out)
+	{
+		// Each iteration decodes thirty-two digits into sixteen octets.
+		size_t idx = 0;
+		for ( ; idx + 32 <= length; idx += 32, out += 16)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto digit = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+			const auto letter = _mm256_sub_epi8(_mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+			const auto is_digit = _mm256_cmpeq_epi8(_mm256_max_epu8(digit, _mm256_set1_epi8(9)), _mm256_set1_epi8(9));
+			const auto is_letter = _mm256_cmpeq_epi8(_mm256_max_epu8(letter, _mm256_set1_epi8(5)), _mm256_set1_epi8(5));
+			if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1)
+				break;
+
+			const auto values = _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, is_digit);
+			const auto pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+			const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t HexEncodeSSE41(const uint8_t* data, size_t length, char* out, const char* table, char separator)
+	{
+		const auto lookup = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+		const auto low_mask = _mm_set1_epi8(0x0F);
+
+		size_t idx = 0;
+		if (separator)
+		{
+			// Each iteration encodes sixteen octets into forty-eight characters which end with a
+			// separator so we can only use it when there is more data afterwards.
+			const auto sep = _mm_set1_epi8(separator);
+			const auto shuffle1 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+			const auto shuffle2a = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+			const auto shuffle2b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+			const auto shuffle3 = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+			const auto sep1 = _mm_and_si128(sep, _mm_cmpeq_epi8(shuffle1, _mm_set1_epi8(-1)));
+			const auto sep2 = _mm_and_si128(sep, _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0));
+			const auto sep3 = _mm_and_si128(sep, _mm_cmpeq_epi8(shuffle3, _mm_set1_epi8(-1)));
+			for ( ; idx + 16 < length; idx += 16, out += 48)
+			{
+				const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+				const auto high = _mm_and_si128(_mm_srli_epi16(input, 4), low_mask);
+				const auto low = _mm_and_si128(input, low_mask);
+				const auto digits1 = _mm_shuffle_epi8(lookup, _mm_unpacklo_epi8(high, low));
+				const auto digits2 = _mm_shuffle_epi8(lookup, _mm_unpackhi_epi8(high, low));
+
+				const auto output1 = _mm_or_si128(_mm_shuffle_epi8(digits1, shuffle1), sep1);
+				const auto output2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(digits1, shuffle2a), _mm_shuffle_epi8(digits2, shuffle2b)), sep2);
+				const auto output3 = _mm_or_si128(_mm_shuffle_epi8(digits2, shuffle3), sep3);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), output1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), output2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), output3);
+			}
+		}
+		else
+		{
+			// Each iteration encodes sixteen octets into thirty-two characters.
+			for ( ; idx + 16 <= length; idx += 16, out += 32)
+			{
+				const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+				const auto high = _mm_and_si128(_mm_srli_epi16(input, 4), low_mask);
+				const auto low = _mm_and_si128(input, low_mask);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(lookup, _mm_unpacklo_epi8(high, low)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_shuffle_epi8(lookup, _mm_unpackhi_epi8(high, low)));
+			}
+		}
+		return idx;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t HexEncodeAVX2(const uint8_t* data, size_t length, char* out, const char* table)
+	{
+		const auto lookup = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+		const auto low_mask = _mm256_set1_epi8(0x0F);
+
+		// Each iteration encodes thirty-two octets into sixty-four characters.
+		size_t idx = 0;
+		for ( ; idx + 32 <= length; idx += 32, out += 64)
+		{
+			// Reorder the quadwords so the in-lane unpacks produce the digits in order.
+			auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			input = _mm256_permute4x64_epi64(input, 0xD8);
+			const auto high = _mm256_and_si256(_mm256_srli_epi16(input, 4), low_mask);
+			const auto low = _mm256_and_si256(input, low_mask);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(lookup, _mm256_unpacklo_epi8(high, low)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_shuffle_epi8(lookup, _mm256_unpackhi_epi8(high, low)));
+		}
+		return idx;
+	}
+
+	// Finds the characters in a block which are not in a set described by a nibble table.
+	OULU_ATTR_TARGET("sse4.1")
+	inline int PercentUnsafeMaskSSE41(__m128i input, __m128i lookup)
+	{
+		// Bytes with the high bit set select zero from both shuffles so they are never safe.
+		const auto bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+		const auto row = _mm_shuffle_epi8(lookup, input);
+		const auto bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(input, 4), _mm_set1_epi8(0x0F)));
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128()));
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t PercentEncodeRunSSE41(const char* data, size_t length, char* out, const uint8_t* nibbles)
+	{
+		const auto lookup = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles));
+		for (size_t idx = 0; idx + 16 <= length; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto unsafe = PercentUnsafeMaskSSE41(input, lookup);
+			if (unsafe)
+			{
+				const auto run = std::countr_zero(static_cast<unsigned>(unsafe));
+				memmove(out + idx, data + idx, run);
+				return idx + run;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + idx), input);
+		}
+		return length - (length % 16);
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t PercentEncodeRunAVX2(const char* data, size_t length, char* out, const uint8_t* nibbles)
+	{
+		const auto lookup = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles)));
+		const auto bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0,
+			1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0, 0);
+		for (size_t idx = 0; idx + 32 <= length; idx += 32)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto row = _mm256_shuffle_epi8(lookup, input);
+			const auto bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(input, 4), _mm256_set1_epi8(0x0F)));
+			const auto unsafe = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256()));
+			if (unsafe)
+			{
+				const auto run = std::countr_zero(static_cast<unsigned>(unsafe));
+				memmove(out + idx, data + idx, run);
+				return idx + run;
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + idx), input);
+		}
+		return length - (length % 32);
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	size_t PercentDecodeRunSSE41(const char* data, size_t length, char* out)
+	{
+		const auto percent = _mm_set1_epi8('%');
+		for (size_t idx = 0; idx + 16 <= length; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto escapes = _mm_movemask_epi8(_mm_cmpeq_epi8(input, percent));
+			if (escapes)
+			{
+				const auto run = std::countr_zero(static_cast<unsigned>(escapes));
+				memmove(out + idx, data + idx, run);
+				return idx + run;
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + idx), input);
+		}
+		return length - (length % 16);
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	size_t PercentDecodeRunAVX2(const char* data, size_t length, char* out)
+	{
+		const auto percent = _mm256_set1_epi8('%');
+		for (size_t idx = 0; idx + 32 <= length; idx += 32)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto escapes = _mm256_movemask_epi8(_mm256_cmpeq_epi8(input, percent));
+			if (escapes)
+			{
+				const auto run = std::countr_zero(static_cast<unsigned>(escapes));
+				memmove(out + idx, data + idx, run);
+				return idx + run;
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + idx), input);
+		}
+		return length - (length % 32);
+	}
+#endif
+
+	// Encodes as many whole blocks as possible using the best available kernel and returns the
+	// number of octets which were consumed.
+	size_t Base64EncodeBlocks(const uint8_t* data, size_t length, char* out, char chr62, char chr63)
+	{
+		size_t consumed = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				consumed = Base64EncodeAVX2(data, length, out, chr62, chr63);
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				consumed += Base64EncodeSSE41(data + consumed, length - consumed, out + (consumed / 3 * 4), chr62, chr63);
+				break;
+#endif
+			default:
+				break;
+		}
+		return consumed;
+	}
+
+	// Decodes as many whole blocks as possible using the best available kernel and returns the
+	// number of characters which were consumed. Decoding stops at the first block which contains
+	// padding or invalid characters.
+	size_t Base64DecodeBlocks(const char* data, size_t length, uint8_t* out, char chr62, char chr63)
+	{
+		size_t consumed = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				consumed = Base64DecodeAVX2(data, length, out, chr62, chr63);
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				consumed += Base64DecodeSSE41(data + consumed, length - consumed, out + (consumed / 4 * 3), chr62, chr63);
+				break;
+#endif
+			default:
+				break;
+		}
+		return consumed;
+	}
+
+	// Decodes as many whole blocks of hexadecimal digits as possible using the best available kernel
+	// and returns the number of characters which were consumed. Decoding stops at the first block
+	// which contains an invalid digit or a misplaced separator.
+	size_t HexDecodeBlocks(const char* data, size_t length, uint8_t* out, char separator)
+	{
+		size_t consumed = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				if (!separator)
+					consumed = HexDecodeAVX2(data, length, out);
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				consumed += HexDecodeSSE41(data + consumed, length - consumed, out + (consumed / 2), separator);
+				break;
+#endif
+			default:
+				break;
+		}
+		return consumed;
+	}
+
+	// Encodes as many whole blocks of octets as possible using the best available kernel and returns
+	// the number of octets which were consumed.
+	size_t HexEncodeBlocks(const uint8_t* data, size_t length, char* out, const Oulu::HexTable& table, char separator)
+	{
+		// Copy the table so the kernels can load it into a register.
+		char lookup[16];
+		for (size_t idx = 0; idx < sizeof(lookup); ++idx)
+			lookup[idx] = table.Encode(idx);
+
+		size_t consumed = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				if (!separator)
+					consumed = HexEncodeAVX2(data, length, out, lookup);
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				consumed += HexEncodeSSE41(data + consumed, length - consumed, out + (consumed * 2), lookup, separator);
+				break;
+#endif
+			default:
+				break;
+		}
+		return consumed;
+	}
+
+	// Copies the run of characters at the start of the data which are in a set using the best
+	// available kernel and returns its length. Stops early if the data ends within a block.
+	size_t PercentEncodeRun(const char* data, size_t length, char* out, const Oulu::CharacterSet& table)
+	{
+		size_t run = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				run = PercentEncodeRunAVX2(data, length, out, table.GetNibbleTable().data());
+				if (run < length && !table.Contains(data[run]))
+					break;
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				run += PercentEncodeRunSSE41(data + run, length - run, out + run, table.GetNibbleTable().data());
+				break;
+#endif
+			default:
+				break;
+		}
+		return run;
+	}
+
+	// Copies the run of characters at the start of the data which are not escapes using the best
+	// available kernel and returns its length. Stops early if the data ends within a block.
+	size_t PercentDecodeRun(const char* data, size_t length, char* out)
+	{
+		size_t run = 0;
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				run = PercentDecodeRunAVX2(data, length, out);
+				if (run < length && data[run] == '%')
+					break;
+				[[fallthrough]];
+			case Oulu::SIMD::Level::SSE41:
+				run += PercentDecodeRunSSE41(data + run, length - run, out + run);
+				break;
+#endif
+			default:
+				break;
+		}
+		return run;
+	}
 }
 
-std::string Oulu::Base64Encode(const void* data, size_t length, const char* table, char padding)
+namespace
 {
-	// Use the default table if one is not specified.
-	if (!table)
-		table = Oulu::BASE64_TABLE;
+	// Decodes Base64-encoded data into a buffer which is at least Base64DecodedLength bytes long.
+	// Any bits which do not make up a whole octet are left in current_bits and seen_bits.
+	size_t Base64DecodeRaw(const void* data, size_t length, char* buffer, const Oulu::Base64Table& table, uint32_t& current_bits, size_t& seen_bits)
+	{
+		OULU_STATS_CALL(BASE64_DECODE, length);
+		const auto* cdata = static_cast<const char*>(data);
+		auto* out = reinterpret_cast<uint8_t*>(buffer);
+		size_t outlen = 0;
 
-	// Preallocate the output buffer to avoid constant reallocations.
-	std::string buffer;
-	buffer.reserve(4 * ((length + 2) / 3));
+		const auto vectorize = length >= BASE64_BLOCK_SIZE && IsBase64Variant(table);
+		for (size_t idx = 0; idx < length; )
+		{
+			auto scalar_end = length;
+			if (vectorize && !seen_bits)
+			{
+				// We are on an octet boundary so we can decode blocks with the SIMD kernel.
+				const auto consumed = Base64DecodeBlocks(cdata + idx, length - idx, out + outlen, table.Encode(62), table.Encode(63));
+				idx += consumed;
+				outlen += consumed / 4 * 3;
+
+				// The kernel stopped at the end of the data or at a block it can not handle so
+				// decode the next block with the scalar code.
+				scalar_end = std::min(length, idx + BASE64_BLOCK_SIZE);
+			}
+
+			// Keep going until we are back on an octet boundary so we can try the kernel again.
+			for ( ; idx < length && (idx < scalar_end || seen_bits); ++idx)
+			{
+				// Attempt to find the octet in the table.
+				const auto value = table.Decode(cdata[idx]);
+				if (value == Oulu::Base64Table::INVALID)
+					continue; // Skip invalid octets.
+
+				// Add the bits for this octet to the active buffer.
+				current_bits = (current_bits << 6) | value;
+				seen_bits += 6;
+
+				if (seen_bits >= 8)
+				{
+					// We have seen an entire octet; add it to the buffer.
+					seen_bits -= 8;
+					out[outlen++] = (current_bits >> seen_bits) & 0xFF;
+				}
+			}
+		}
+		return outlen;
+	}
+
+	// Encodes data using Base64 into a buffer which is at least Base64EncodedLength characters long.
+	size_t Base64EncodeRaw(const void* data, size_t length, char* buffer, const Oulu::Base64Table& table, char padding)
+	{
+		OULU_STATS_CALL(BASE64_ENCODE, length);
+		const auto* udata = static_cast<const uint8_t*>(data);
+		auto* out = buffer;
+
+		size_t idx = 0;
+		if (length >= BASE64_BLOCK_SIZE && IsBase64Variant(table))
+		{
+			idx = Base64EncodeBlocks(udata, length, out, table.Encode(62), table.Encode(63));
+			out += idx / 3 * 4;
+		}
+
+		// Encode the remaining octets with the scalar code.
+		const std::string_view remaining(reinterpret_cast<const char*>(udata + idx), length - idx);
+		out = Oulu::Base64EncodeTo(out, remaining, table, padding);
+		return out - buffer;
+	}
+
+	// Decodes hexadecimal-encoded data into a buffer which is at least HexDecodedLength bytes long.
+	// Invalid digits are decoded as zero and cause valid to be set to false.
+	size_t HexDecodeRaw(const void* data, size_t length, char* buffer, const Oulu::HexTable& table, char separator, bool& valid)
+	{
+		OULU_STATS_CALL(HEX_DECODE, length);
+		const auto* cdata = static_cast<const char*>(data);
+		auto* out = buffer;
+
+		size_t idx = 0;
+		if (length >= HEX_BLOCK_SIZE && IsHexVariant(table))
+		{
+			idx = HexDecodeBlocks(cdata, length, reinterpret_cast<uint8_t*>(out), separator);
+			out += separator ? idx / 3 : idx / 2;
+		}
+
+		// The size of each hex segment.
+		const size_t segment = (separator ? 3 : 2);
+
+		valid = true;
+		for ( ; idx + 1 < length; idx += segment)
+		{
+			// Attempt to find the octets in the table.
+			const auto value1 = table.Decode(cdata[idx]);
+			const auto value2 = table.Decode(cdata[idx + 1]);
+			if (value1 == Oulu::HexTable::INVALID || value2 == Oulu::HexTable::INVALID)
+				valid = false;
+			else if (separator && idx + 2 < length && cdata[idx + 2] != separator)
+				valid = false;
+
+			const auto pair = ((value1 != Oulu::HexTable::INVALID ? value1 : 0) << 4)
+				+ (value2 != Oulu::HexTable::INVALID ? value2 : 0);
+			*out++ = static_cast<char>(pair);
+		}
+
+		// Well formed data has no dangling digits or separators.
+		const size_t written = out - buffer;
+		valid = valid && length == Oulu::HexEncodedLength(written, separator);
+		if (!valid)
+			OULU_STATS_FAILURE(HEX_DECODE);
+		return written;
+	}
+
+	// Encodes data using hexadecimal encoding into a buffer which is at least HexEncodedLength characters long.
+	size_t HexEncodeRaw(const void* data, size_t length, char* buffer, const Oulu::HexTable& table, char separator)
+	{
+		OULU_STATS_CALL(HEX_ENCODE, length);
+		const auto* udata = static_cast<const uint8_t*>(data);
+		auto* out = buffer;
+
+		size_t idx = 0;
+		if (length >= HEX_BLOCK_SIZE)
+		{
+			idx = HexEncodeBlocks(udata, length, out, table, separator);
+			out += idx * (separator ? 3 : 2);
+		}
+
+		// Encode the remaining octets with the scalar code.
+		const std::string_view remaining(reinterpret_cast<const char*>(udata + idx), length - idx);
+		out = Oulu::HexEncodeTo(out, remaining, table, separator);
+		return out - buffer;
+	}
+
+	// Decodes percent-encoded data into a buffer which is at least PercentDecodedLength bytes long.
+	size_t PercentDecodeRaw(const void* data, size_t length, char* buffer)
+	{
+		OULU_STATS_CALL(PERCENT_DECODE, length);
+		const std::string_view sdata(static_cast<const char*>(data), length);
+		if (length < PERCENT_BLOCK_SIZE || Oulu::SIMD::GetLevel() == Oulu::SIMD::Level::SCALAR)
+			return Oulu::PercentDecodeTo(buffer, sdata) - buffer;
+
+		auto* out = buffer;
+		for (size_t idx = 0; idx < length; )
+		{
+			// Copy everything up to the next escape in bulk.
+			const auto run = PercentDecodeRun(sdata.data() + idx, length - idx, out);
+			idx += run;
+			out += run;
+			if (idx >= length)
+				break;
+
+			// Decode the escape (or the next character if we are at the end of the data).
+			const auto escape = sdata.substr(idx, sdata[idx] == '%' ? 3 : 1);
+			out = Oulu::PercentDecodeTo(out, escape);
+			idx += escape.length();
+		}
+		return out - buffer;
+	}
 
-	const auto* udata = static_cast<const uint8_t*>(data);
-	for (size_t idx = 0; idx < length; )
+	// Encodes data using percent encoding into a buffer which is at least PercentEncodedLength characters long.
+	size_t PercentEncodeRaw(const void* data, size_t length, char* buffer, const Oulu::CharacterSet& table, bool upper)
 	{
-		// Base64 encodes three octets into four characters.
-		uint32_t octet1 = idx < length ? udata[idx++] : 0;
-		uint32_t octet2 = idx < length ? udata[idx++] : 0;
-		uint32_t octet3 = idx < length ? udata[idx++] : 0;
-		uint32_t triple = (octet1 << 16) + (octet2 << 8) + octet3;
+		OULU_STATS_CALL(PERCENT_ENCODE, length);
+		const std::string_view sdata(static_cast<const char*>(data), length);
+		if (length < PERCENT_BLOCK_SIZE || !table.IsASCII() || Oulu::SIMD::GetLevel() == Oulu::SIMD::Level::SCALAR)
+			return Oulu::PercentEncodeTo(buffer, sdata, table, upper) - buffer;
+
+		auto* out = buffer;
+		for (size_t idx = 0; idx < length; )
+		{
+			// Copy everything up to the next unsafe character in bulk.
+			const auto run = PercentEncodeRun(sdata.data() + idx, length - idx, out, table);
+			idx += run;
+			out += run;
+			if (idx >= length)
+				break;
 
-		buffer.push_back(table[(triple >> 3 * 6) & 63]);
-		buffer.push_back(table[(triple >> 2 * 6) & 63]);
-		buffer.push_back(table[(triple >> 1 * 6) & 63]);
-		buffer.push_back(table[(triple >> 0 * 6) & 63]);
+			// Encode the unsafe character (or the next character if we are at the end of the data).
+			out = Oulu::PercentEncodeTo(out, sdata.substr(idx++, 1), table, upper);
+		}
+		return out - buffer;
 	}
 
-	static constexpr size_t padding_count[] = { 0, 2, 1 };
-	if (padding)
+	// Appends up to max_length characters to a string using a raw encoding function.
+	template <typename String, typename Function>
+	void AppendTo(String& out, size_t max_length, Function function)
 	{
-		// Replace any trailing characters with padding.
-		for (size_t idx = 0; idx < padding_count[length % 3]; ++idx)
-			buffer[buffer.length() - 1 - idx] = '=';
+		const auto old_length = out.length();
+		out.resize(old_length + max_length);
+		out.resize(old_length + function(out.data() + old_length));
 	}
-	else
+
+	// Writes up to max_length characters to a span using a raw encoding function.
+	template <typename Function>
+	std::optional<size_t> WriteTo(std::span<char> out, size_t max_length, Function function)
 	{
-		// Remove any trailing characters.
-		buffer.erase(buffer.length() - padding_count[length % 3]);
+		if (out.size() < max_length)
+			return std::nullopt;
+		return function(out.data());
 	}
+}
 
+std::string Oulu::Base64Decode(const void* data, size_t length, const Base64Table& table)
+{
+	std::string buffer;
+	Base64DecodeTo(buffer, data, length, table);
 	return buffer;
 }
 
-std::string Oulu::HexDecode(const void* data, size_t length, const char* table, char separator)
+void Oulu::Base64DecodeTo(std::string& out, const void* data, size_t length, const Base64Table& table)
 {
-	if (!table)
-		table = Oulu::HEX_TABLE_LOWER;
+	AppendTo(out, Base64DecodedLength(length), [&](char* buffer) {
+		uint32_t current_bits = 0;
+		size_t seen_bits = 0;
+		return Base64DecodeRaw(data, length, buffer, table, current_bits, seen_bits);
+	});
+}
+
+void Oulu::Base64DecodeTo(std::pmr::string& out, const void* data, size_t length, const Base64Table& table)
+{
+	AppendTo(out, Base64DecodedLength(length), [&](char* buffer) {
+		uint32_t current_bits = 0;
+		size_t seen_bits = 0;
+		return Base64DecodeRaw(data, length, buffer, table, current_bits, seen_bits);
+	});
+}
 
-	// The size of each hex segment.
-	size_t segment = (separator ? 3 : 2);
+std::optional<size_t> Oulu::Base64DecodeTo(std::span<char> out, const void* data, size_t length, const Base64Table& table)
+{
+	return WriteTo(out, Base64DecodedLength(length), [&](char* buffer) {
+		uint32_t current_bits = 0;
+		size_t seen_bits = 0;
+		return Base64DecodeRaw(data, length, buffer, table, current_bits, seen_bits);
+	});
+}
+
+std::string_view Oulu::Base64DecodeInPlace(std::span<char> data, const Base64Table& table)
+{
+	// The decoders never write past the character they are reading so this is safe.
+	uint32_t current_bits = 0;
+	size_t seen_bits = 0;
+	const auto written = Base64DecodeRaw(data.data(), data.size(), data.data(), table, current_bits, seen_bits);
+	return { data.data(), written };
+}
 
-	// Preallocate the output buffer to avoid constant reallocations.
+std::string Oulu::Base64Encode(const void* data, size_t length, const Base64Table& table, char padding)
+{
 	std::string buffer;
-	buffer.reserve(length / segment);
+	Base64EncodeTo(buffer, data, length, table, padding);
+	return buffer;
+}
 
-	const auto* cdata = static_cast<const char*>(data);
-	for (size_t idx = 0; idx + 1 < length; idx += segment)
-	{
-		// Attempt to find the octets in the table.
-		const auto* table1 = strchr(table, cdata[idx]);
-		const auto* table2 = strchr(table, cdata[idx + 1]);
+void Oulu::Base64EncodeTo(std::string& out, const void* data, size_t length, const Base64Table& table, char padding)
+{
+	AppendTo(out, Base64EncodedLength(length, padding), [&](char* buffer) {
+		return Base64EncodeRaw(data, length, buffer, table, padding);
+	});
+}
 
-		const auto pair = ((table1 ? table1 - table : 0) << 4)
-			+ (table2 ? table2 - table : 0);
-		buffer.push_back(pair);
-	}
+void Oulu::Base64EncodeTo(std::pmr::string& out, const void* data, size_t length, const Base64Table& table, char padding)
+{
+	AppendTo(out, Base64EncodedLength(length, padding), [&](char* buffer) {
+		return Base64EncodeRaw(data, length, buffer, table, padding);
+	});
+}
+
+std::optional<size_t> Oulu::Base64EncodeTo(std::span<char> out, const void* data, size_t length, const Base64Table& table, char padding)
+{
+	return WriteTo(out, Base64EncodedLength(length, padding), [&](char* buffer) {
+		return Base64EncodeRaw(data, length, buffer, table, padding);
+	});
+}
 
+std::string Oulu::HexDecode(const void* data, size_t length, const HexTable& table, char separator)
+{
+	std::string buffer;
+	HexDecodeTo(buffer, data, length, table, separator);
 	return buffer;
 }
 
-std::string Oulu::HexEncode(const void* data, size_t length, const char* table, char separator)
+bool Oulu::HexDecodeTo(std::string& out, const void* data, size_t length, const HexTable& table, char separator)
 {
-	if (!table)
-		table = Oulu::HEX_TABLE_LOWER;
+	bool valid;
+	AppendTo(out, HexDecodedLength(length, separator), [&](char* buffer) {
+		return HexDecodeRaw(data, length, buffer, table, separator, valid);
+	});
+	return valid;
+}
 
-	// Preallocate the output buffer to avoid constant reallocations.
-	std::string buffer;
-	buffer.reserve((length * 2) + (!!separator * length));
+bool Oulu::HexDecodeTo(std::pmr::string& out, const void* data, size_t length, const HexTable& table, char separator)
+{
+	bool valid;
+	AppendTo(out, HexDecodedLength(length, separator), [&](char* buffer) {
+		return HexDecodeRaw(data, length, buffer, table, separator, valid);
+	});
+	return valid;
+}
 
-	const auto* udata = reinterpret_cast<const unsigned char*>(data);
-	for (size_t idx = 0; idx < length; ++idx)
-	{
-		if (idx && separator)
-			buffer.push_back(separator);
+std::optional<size_t> Oulu::HexDecodeTo(std::span<char> out, const void* data, size_t length, const HexTable& table, char separator)
+{
+	bool valid;
+	const auto written = WriteTo(out, HexDecodedLength(length, separator), [&](char* buffer) {
+		return HexDecodeRaw(data, length, buffer, table, separator, valid);
+	});
+	return written && valid ? written : std::nullopt;
+}
 
-		const auto chr = udata[idx];
-		buffer.push_back(table[chr >> 4]);
-		buffer.push_back(table[chr & 15]);
-	}
+std::optional<std::string_view> Oulu::HexDecodeInPlace(std::span<char> data, const HexTable& table, char separator)
+{
+	// The decoders never write past the character they are reading so this is safe.
+	bool valid;
+	const auto written = HexDecodeRaw(data.data(), data.size(), data.data(), table, separator, valid);
+	if (!valid)
+		return std::nullopt;
+	return std::string_view(data.data(), written);
+}
 
+std::string Oulu::HexEncode(const void* data, size_t length, const HexTable& table, char separator)
+{
+	std::string buffer;
+	HexEncodeTo(buffer, data, length, table, separator);
 	return buffer;
 }
 
+void Oulu::HexEncodeTo(std::string& out, const void* data, size_t length, const HexTable& table, char separator)
+{
+	AppendTo(out, HexEncodedLength(length, separator), [&](char* buffer) {
+		return HexEncodeRaw(data, length, buffer, table, separator);
+	});
+}
+
+void Oulu::HexEncodeTo(std::pmr::string& out, const void* data, size_t length, const HexTable& table, char separator)
+{
+	AppendTo(out, HexEncodedLength(length, separator), [&](char* buffer) {
+		return HexEncodeRaw(data, length, buffer, table, separator);
+	});
+}
+
+std::optional<size_t> Oulu::HexEncodeTo(std::span<char> out, const void* data, size_t length, const HexTable& table, char separator)
+{
+	return WriteTo(out, HexEncodedLength(length, separator), [&](char* buffer) {
+		return HexEncodeRaw(data, length, buffer, table, separator);
+	});
+}
+
 std::string Oulu::PercentDecode(const void* data, size_t length)
 {
-	// Preallocate the output buffer to avoid constant reallocations.
 	std::string buffer;
-	buffer.reserve(length * 3);
+	PercentDecodeTo(buffer, data, length);
+	return buffer;
+}
+
+void Oulu::PercentDecodeTo(std::string& out, const void* data, size_t length)
+{
+	AppendTo(out, PercentDecodedLength(length), [&](char* buffer) {
+		return PercentDecodeRaw(data, length, buffer);
+	});
+}
+
+void Oulu::PercentDecodeTo(std::pmr::string& out, const void* data, size_t length)
+{
+	AppendTo(out, PercentDecodedLength(length), [&](char* buffer) {
+		return PercentDecodeRaw(data, length, buffer);
+	});
+}
+
+std::optional<size_t> Oulu::PercentDecodeTo(std::span<char> out, const void* data, size_t length)
+{
+	return WriteTo(out, PercentDecodedLength(length), [&](char* buffer) {
+		return PercentDecodeRaw(data, length, buffer);
+	});
+}
+
+std::string_view Oulu::PercentDecodeInPlace(std::span<char> data)
+{
+	// The decoders never write past the character they are reading so this is safe.
+	const auto written = PercentDecodeRaw(data.data(), data.size(), data.data());
+	return { data.data(), written };
+}
+
+std::string Oulu::PercentEncode(const void* data, size_t length, const CharacterSet& table, bool upper)
+{
+	std::string buffer;
+	PercentEncodeTo(buffer, data, length, table, upper);
+	return buffer;
+}
+
+void Oulu::PercentEncodeTo(std::string& out, const void* data, size_t length, const CharacterSet& table, bool upper)
+{
+	AppendTo(out, PercentEncodedLength(length), [&](char* buffer) {
+		return PercentEncodeRaw(data, length, buffer, table, upper);
+	});
+}
+
+void Oulu::PercentEncodeTo(std::pmr::string& out, const void* data, size_t length, const CharacterSet& table, bool upper)
+{
+	AppendTo(out, PercentEncodedLength(length), [&](char* buffer) {
+		return PercentEncodeRaw(data, length, buffer, table, upper);
+	});
+}
 
-	const auto* cdata = reinterpret_cast<const char*>(data);
-	for (size_t idx = 0; idx < length; ++idx)
+std::optional<size_t> Oulu::PercentEncodeTo(std::span<char> out, const void* data, size_t length, const CharacterSet& table, bool upper)
+{
+	return WriteTo(out, PercentEncodedLength(length), [&](char* buffer) {
+		return PercentEncodeRaw(data, length, buffer, table, upper);
+	});
+}
+
+namespace
+{
+	// Decodes Base64-encoded data into a buffer and reports the first problem with it.
+	template <typename String>
+	Oulu::BasicDecodeResult<String> Base64DecodeStrictRaw(String&& buffer, const void* data, size_t length, const Oulu::Base64Table& table, char padding)
 	{
-		if (cdata[idx] == '%')
+		using Result = Oulu::BasicDecodeResult<String>;
+		const auto* cdata = static_cast<const char*>(data);
+		buffer.resize(Oulu::Base64DecodedLength(length));
+		auto* out = reinterpret_cast<uint8_t*>(buffer.data());
+
+		// The SIMD kernel stops at the first block containing padding or an invalid character so we
+		// only need to check the rest of the data with the scalar code.
+		size_t idx = 0;
+		if (length >= BASE64_BLOCK_SIZE && IsBase64Variant(table))
 		{
-			// Percent encoding encodes two octets into 1-2 characters.
-			const char octet1 = ++idx < length ? toupper(cdata[idx]) : 0;
-			const char octet2 = ++idx < length ? toupper(cdata[idx]) : 0;
+			idx = Base64DecodeBlocks(cdata, length, out, table.Encode(62), table.Encode(63));
+			out += idx / 4 * 3;
+		}
 
-			const auto* table1 = strchr(Oulu::HEX_TABLE_UPPER, octet1);
-			const auto* table2 = strchr(Oulu::HEX_TABLE_UPPER, octet2);
+		uint32_t current_bits = 0;
+		size_t seen_bits = 0;
+		for ( ; idx < length; ++idx)
+		{
+			const auto value = table.Decode(cdata[idx]);
+			if (value == Oulu::Base64Table::INVALID)
+			{
+				if (!padding || cdata[idx] != padding)
+					return Result(Oulu::DecodeError::BAD_CHARACTER, idx);
+
+				// Padding can only replace the last one or two characters of the final group.
+				const auto group_end = idx - (idx % 4) + 4;
+				if (idx % 4 < 2)
+					return Result(Oulu::DecodeError::BAD_PADDING, idx);
+
+				for (auto pidx = idx + 1; pidx < length; ++pidx)
+				{
+					if (pidx >= group_end || cdata[pidx] != padding)
+						return Result(Oulu::DecodeError::BAD_PADDING, pidx);
+				}
+
+				if (length < group_end)
+					return Result(Oulu::DecodeError::TRUNCATED, length);
+
+				buffer.resize(out - reinterpret_cast<uint8_t*>(buffer.data()));
+				return Result(std::move(buffer));
+			}
+
+			// Add the bits for this character to the active buffer.
+			current_bits = (current_bits << 6) | value;
+			seen_bits += 6;
 
-			const auto pair = ((table1 ? table1 - Oulu::HEX_TABLE_UPPER : 0) << 4)
-				+ (table2 ? table2 - Oulu::HEX_TABLE_UPPER : 0);
-			buffer.push_back(pair);
+			if (seen_bits >= 8)
+			{
+				// We have seen an entire octet; add it to the buffer.
+				seen_bits -= 8;
+				*out++ = (current_bits >> seen_bits) & 0xFF;
+			}
 		}
-		else
+
+		// Unpadded data can end part way through a group as long as it contains at least one octet.
+		if (length % 4 == 1 || (padding && length % 4))
+			return Result(Oulu::DecodeError::TRUNCATED, length);
+
+		buffer.resize(out - reinterpret_cast<uint8_t*>(buffer.data()));
+		return Result(std::move(buffer));
+	}
+
+	// Decodes hexadecimal-encoded data into a buffer and reports the first problem with it.
+	template <typename String>
+	Oulu::BasicDecodeResult<String> HexDecodeStrictRaw(String&& buffer, const void* data, size_t length, const Oulu::HexTable& table, char separator)
+	{
+		using Result = Oulu::BasicDecodeResult<String>;
+		const auto* cdata = static_cast<const char*>(data);
+		buffer.resize(Oulu::HexDecodedLength(length, separator));
+		auto* out = buffer.data();
+
+		// The SIMD kernel stops at the first block containing an invalid digit or a misplaced
+		// separator so we only need to check the rest of the data with the scalar code.
+		size_t idx = 0;
+		if (length >= HEX_BLOCK_SIZE && IsHexVariant(table))
 		{
-			buffer.push_back(cdata[idx]);
+			idx = HexDecodeBlocks(cdata, length, reinterpret_cast<uint8_t*>(out), separator);
+			out += separator ? idx / 3 : idx / 2;
 		}
+
+		while (idx < length)
+		{
+			if (idx + 1 >= length)
+				return Result(Oulu::DecodeError::TRUNCATED, length);
+
+			const auto value1 = table.Decode(cdata[idx]);
+			if (value1 == Oulu::HexTable::INVALID)
+				return Result(Oulu::DecodeError::BAD_CHARACTER, idx);
+
+			const auto value2 = table.Decode(cdata[idx + 1]);
+			if (value2 == Oulu::HexTable::INVALID)
+				return Result(Oulu::DecodeError::BAD_CHARACTER, idx + 1);
+
+			*out++ = static_cast<char>((value1 << 4) | value2);
+			idx += 2;
+
+			if (separator && idx < length)
+			{
+				// Every pair apart from the last must be followed by a separator.
+				if (cdata[idx] != separator)
+					return Result(Oulu::DecodeError::BAD_CHARACTER, idx);
+				if (++idx >= length)
+					return Result(Oulu::DecodeError::TRUNCATED, length);
+			}
+		}
+
+		buffer.resize(out - buffer.data());
+		return Result(std::move(buffer));
 	}
 
-	return buffer;
+	// Decodes percent-encoded data into a buffer and reports the first problem with it.
+	template <typename String>
+	Oulu::BasicDecodeResult<String> PercentDecodeStrictRaw(String&& buffer, const void* data, size_t length)
+	{
+		using Result = Oulu::BasicDecodeResult<String>;
+		const auto* cdata = static_cast<const char*>(data);
+		buffer.resize(Oulu::PercentDecodedLength(length));
+		auto* out = buffer.data();
+
+		const auto vectorize = length >= PERCENT_BLOCK_SIZE && Oulu::SIMD::GetLevel() != Oulu::SIMD::Level::SCALAR;
+		for (size_t idx = 0; idx < length; )
+		{
+			if (vectorize)
+			{
+				// Copy everything up to the next escape in bulk.
+				const auto run = PercentDecodeRun(cdata + idx, length - idx, out);
+				idx += run;
+				out += run;
+				if (idx >= length)
+					break;
+			}
+
+			if (cdata[idx] != '%')
+			{
+				*out++ = cdata[idx++];
+				continue;
+			}
+
+			if (idx + 2 >= length)
+				return Result(Oulu::DecodeError::TRUNCATED, length);
+
+			const auto value1 = Oulu::HEX_TABLE_LOWER.Decode(cdata[idx + 1]);
+			if (value1 == Oulu::HexTable::INVALID)
+				return Result(Oulu::DecodeError::BAD_CHARACTER, idx + 1);
+
+			const auto value2 = Oulu::HEX_TABLE_LOWER.Decode(cdata[idx + 2]);
+			if (value2 == Oulu::HexTable::INVALID)
+				return Result(Oulu::DecodeError::BAD_CHARACTER, idx + 2);
+
+			*out++ = static_cast<char>((value1 << 4) | value2);
+			idx += 3;
+		}
+
+		buffer.resize(out - buffer.data());
+		return Result(std::move(buffer));
+	}
 }
 
-std::string Oulu::PercentEncode(const void* data, size_t length, const char* table, bool upper)
+Oulu::DecodeResult Oulu::Base64DecodeStrict(const void* data, size_t length, const Base64Table& table, char padding)
 {
-	if (!table)
-		table = Oulu::PERCENT_TABLE;
+	OULU_STATS_CALL(BASE64_DECODE, length);
+	auto result = Base64DecodeStrictRaw(std::string(), data, length, table, padding);
+	if (!result)
+		OULU_STATS_FAILURE(BASE64_DECODE);
+	return result;
+}
 
-	// Preallocate the output buffer to avoid constant reallocations.
-	std::string buffer;
-	buffer.reserve(length * 3);
+Oulu::PmrDecodeResult Oulu::Base64DecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const Base64Table& table, char padding)
+{
+	OULU_STATS_CALL(BASE64_DECODE, data.length());
+	auto result = Base64DecodeStrictRaw(std::pmr::string(allocator), data.data(), data.length(), table, padding);
+	if (!result)
+		OULU_STATS_FAILURE(BASE64_DECODE);
+	return result;
+}
 
-	const auto* hex_table = upper ? Oulu::HEX_TABLE_UPPER : Oulu::HEX_TABLE_LOWER;
-	const auto* udata = reinterpret_cast<const unsigned char*>(data);
-	for (size_t idx = 0; idx < length; ++idx)
+Oulu::DecodeResult Oulu::HexDecodeStrict(const void* data, size_t length, const HexTable& table, char separator)
+{
+	OULU_STATS_CALL(HEX_DECODE, length);
+	auto result = HexDecodeStrictRaw(std::string(), data, length, table, separator);
+	if (!result)
+		OULU_STATS_FAILURE(HEX_DECODE);
+	return result;
+}
+
+Oulu::PmrDecodeResult Oulu::HexDecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const HexTable& table, char separator)
+{
+	OULU_STATS_CALL(HEX_DECODE, data.length());
+	auto result = HexDecodeStrictRaw(std::pmr::string(allocator), data.data(), data.length(), table, separator);
+	if (!result)
+		OULU_STATS_FAILURE(HEX_DECODE);
+	return result;
+}
+
+Oulu::DecodeResult Oulu::PercentDecodeStrict(const void* data, size_t length)
+{
+	OULU_STATS_CALL(PERCENT_DECODE, length);
+	auto result = PercentDecodeStrictRaw(std::string(), data, length);
+	if (!result)
+		OULU_STATS_FAILURE(PERCENT_DECODE);
+	return result;
+}
+
+Oulu::PmrDecodeResult Oulu::PercentDecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator)
+{
+	OULU_STATS_CALL(PERCENT_DECODE, data.length());
+	auto result = PercentDecodeStrictRaw(std::pmr::string(allocator), data.data(), data.length());
+	if (!result)
+		OULU_STATS_FAILURE(PERCENT_DECODE);
+	return result;
+}
+
+Oulu::Base64Decoder::Base64Decoder(const Base64Table& t)
+	: table(&t)
+{
+}
+
+bool Oulu::Base64Decoder::Final()
+{
+	// A single leftover character can not encode a whole octet.
+	const auto valid = seen_bits != 6;
+	Reset();
+	return valid;
+}
+
+void Oulu::Base64Decoder::Reset()
+{
+	current_bits = 0;
+	seen_bits = 0;
+}
+
+void Oulu::Base64Decoder::Update(std::string& out, const std::string_view& data)
+{
+	AppendTo(out, MaxUpdateLength(data.length()), [&](char* buffer) {
+		return Base64DecodeRaw(data.data(), data.length(), buffer, *table, current_bits, seen_bits);
+	});
+}
+
+std::optional<size_t> Oulu::Base64Decoder::Update(std::span<char> out, const std::string_view& data)
+{
+	return WriteTo(out, MaxUpdateLength(data.length()), [&](char* buffer) {
+		return Base64DecodeRaw(data.data(), data.length(), buffer, *table, current_bits, seen_bits);
+	});
+}
+
+Oulu::Base64Encoder::Base64Encoder(const Base64Table& t, char p, size_t ll)
+	: table(&t)
+	, padding(p)
+	, line_length(ll)
+{
+	if (line_length)
+		line.reserve(line_length + MaxUpdateLength(line_length));
+}
+
+void Oulu::Base64Encoder::Final(std::string& out)
+{
+	// Encode any octets which did not make up an entire group.
+	char group[2];
+	const auto group_length = seen_bits / 8;
+	for (size_t idx = 0; idx < group_length; ++idx)
+		group[idx] = static_cast<char>(current_bits >> (8 * (group_length - idx - 1)));
+
+	Base64EncodeTo(out, std::string_view(group, group_length), *table, padding);
+	current_bits = 0;
+	seen_bits = 0;
+}
+
+void Oulu::Base64Encoder::Reset()
+{
+	current_bits = 0;
+	seen_bits = 0;
+	line.clear();
+}
+
+void Oulu::Base64Encoder::Update(std::string& out, const std::string_view& data)
+{
+	AppendTo(out, MaxUpdateLength(data.length()), [&](char* buffer) {
+		return *Update(std::span<char>(buffer, MaxUpdateLength(data.length())), data);
+	});
+}
+
+std::optional<size_t> Oulu::Base64Encoder::Update(std::span<char> out, const std::string_view& data)
+{
+	if (out.size() < MaxUpdateLength(data.length()))
+		return std::nullopt;
+
+	auto* buffer = out.data();
+	auto remaining = data;
+	if (seen_bits)
 	{
-		const auto chr = udata[idx];
-		if (strchr(table, chr))
-		{
-			// The character is on the safe list; push it as is.
-			buffer.push_back(chr);
-		}
-		else
+		// Try to complete the group which was left over from the last update.
+		for ( ; seen_bits < 24 && !remaining.empty(); seen_bits += 8)
 		{
-			// The character is not on the safe list; percent encode it.
-			buffer.push_back('%');
-			buffer.push_back(hex_table[chr >> 4]);
-			buffer.push_back(hex_table[chr & 15]);
+			current_bits = (current_bits << 8) | static_cast<uint8_t>(remaining.front());
+			remaining.remove_prefix(1);
 		}
+
+		if (seen_bits < 24)
+			return 0; // Still not enough data.
+
+		const char group[] = {
+			static_cast<char>(current_bits >> 16),
+			static_cast<char>(current_bits >> 8),
+			static_cast<char>(current_bits),
+		};
+		buffer = Base64EncodeTo(buffer, std::string_view(group, sizeof(group)), *table, padding);
+		current_bits = 0;
+		seen_bits = 0;
 	}
 
-	return buffer;
+	// Encode all of the whole groups and keep the rest until the next update.
+	const auto whole = remaining.length() - (remaining.length() % 3);
+	buffer += Base64EncodeRaw(remaining.data(), whole, buffer, *table, padding);
+	for (const auto chr : remaining.substr(whole))
+	{
+		current_bits = (current_bits << 8) | static_cast<uint8_t>(chr);
+		seen_bits += 8;
+	}
+	return buffer - out.data();
 }
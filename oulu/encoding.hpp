@@ -3,102 +3,997 @@
 
 #pragma once
 
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Oulu
+{
+	class Base64Decoder;
+	class Base64Encoder;
+	template <typename String> class BasicDecodeResult;
+	class CharacterSet;
+	template <size_t Size> class EncodingTable;
+
+	/** The kinds of error which can be encountered by the strict decoders. */
+	enum class DecodeError
+		: uint8_t
+	{
+		/** The data was decoded successfully. */
+		NONE,
+
+		/** A character which is not valid at its position was found. */
+		BAD_CHARACTER,
+
+		/** A padding character was found somewhere other than at the end of the final group. */
+		BAD_PADDING,
+
+		/** The data ended part way through an escape sequence or group. */
+		TRUNCATED,
+	};
+
+	/** An encoding table which maps 6-bit indices to Base64 characters. */
+	using Base64Table = EncodingTable<64>;
+
+	/** The result of a strict decoder which returns a string. */
+	using DecodeResult = BasicDecodeResult<std::string>;
+
+	/** An encoding table which maps 4-bit indices to hexadecimal digits. */
+	using HexTable = EncodingTable<16>;
+
+	/** The result of a strict decoder which returns a string that uses a polymorphic allocator. */
+	using PmrDecodeResult = BasicDecodeResult<std::pmr::string>;
+}
+
+/** CharacterSet allows checking whether a character is within a set of characters in constant time. */
+class Oulu::CharacterSet final
+{
+private:
+	/** The characters in the set as a null-terminated string. */
+	const char* characters;
+
+	/** A bitmap of the characters which are in the set. */
+	std::array<uint64_t, 4> bitmap = { };
+
+	/** The ASCII characters in the set indexed by their low nibble with one bit per high nibble. */
+	std::array<uint8_t, 16> nibbles = { };
+
+public:
+	/** Creates a CharacterSet from a null-terminated string of characters.
+	 * \param str The characters which are within the set.
+	 */
+	explicit constexpr CharacterSet(const char* str)
+		: characters(str)
+	{
+		for (const auto* chr = str; *chr; ++chr)
+		{
+			const auto uchr = static_cast<uint8_t>(*chr);
+			bitmap[uchr / 64] |= uint64_t(1) << (uchr % 64);
+			if (uchr < 128)
+				nibbles[uchr & 15] |= uint8_t(1) << (uchr >> 4);
+		}
+	}
+
+	/** Determines whether the specified character is within the set.
+	 * \param chr The character to check for.
+	 * \return True if the character is in the set; otherwise, false.
+	 */
+	constexpr bool Contains(char chr) const
+	{
+		const auto uchr = static_cast<uint8_t>(chr);
+		return bitmap[uchr / 64] & (uint64_t(1) << (uchr % 64));
+	}
+
+	/** Retrieves the bitmap of the characters which are in the set. */
+	constexpr const std::array<uint64_t, 4>& GetBitmap() const { return bitmap; }
+
+	/** Retrieves the characters in the set as a null-terminated string. */
+	constexpr const char* GetCharacters() const { return characters; }
+
+	/** Retrieves a table of the ASCII characters in the set which can be used for testing many
+	 * characters at once. Entry N contains bit M if the character 0xMN is in the set.
+	 */
+	constexpr const std::array<uint8_t, 16>& GetNibbleTable() const { return nibbles; }
+
+	/** Determines whether the set only contains ASCII characters. */
+	constexpr bool IsASCII() const { return !bitmap[2] && !bitmap[3]; }
+
+	/** Allows the set to be used where a null-terminated table string is expected. */
+	constexpr operator const char*() const { return characters; }
+};
+
+/** EncodingTable maps between fixed-width indices and characters in both directions in constant time. */
+template <size_t Size>
+class Oulu::EncodingTable final
+{
+public:
+	/** The index which characters that are not in the table decode to. */
+	static constexpr uint8_t INVALID = 0xFF;
+
+private:
+	/** The characters in the table as a null-terminated string. */
+	const char* characters;
+
+	/** A map of characters to their index in the table or INVALID if not present. */
+	std::array<uint8_t, 256> indices = { };
+
+	/** A bitmap of the characters which are in the table. */
+	std::array<uint64_t, 4> bitmap = { };
+
+	/** Adds a character to the reverse map and bitmap. */
+	constexpr void Add(char chr, size_t idx)
+	{
+		const auto uchr = static_cast<uint8_t>(chr);
+		indices[uchr] = static_cast<uint8_t>(idx);
+		bitmap[uchr / 64] |= uint64_t(1) << (uchr % 64);
+	}
+
+public:
+	/** Creates an EncodingTable from a null-terminated string of characters. If a character is in the
+	 * table more than once then the first occurrence is used when decoding.
+	 * \param str The characters in the table in index order.
+	 * \param case_insensitive Whether to also decode ASCII letters in the opposite case.
+	 */
+	explicit constexpr EncodingTable(const char* str, bool case_insensitive = false)
+		: characters(str)
+	{
+		indices.fill(INVALID);
+
+		// Walk the table backwards so that the first occurrence of a character wins.
+		const auto length = std::char_traits<char>::length(str);
+		for (auto idx = length < Size ? length : Size; idx-- > 0; )
+			Add(str[idx], idx);
+
+		if (!case_insensitive)
+			return;
+
+		// Map the opposite case of any letters which are not already in the table.
+		for (size_t idx = 0; idx < Size && idx < length; ++idx)
+		{
+			const auto chr = str[idx];
+			const auto other = chr >= 'a' && chr <= 'z' ? chr - 32 : (chr >= 'A' && chr <= 'Z' ? chr + 32 : 0);
+			if (other && !Contains(static_cast<char>(other)))
+				Add(static_cast<char>(other), idx);
+		}
+	}
+
+	/** Determines whether the specified character is in the table.
+	 * \param chr The character to check for.
+	 * \return True if the character is in the table; otherwise, false.
+	 */
+	constexpr bool Contains(char chr) const
+	{
+		const auto uchr = static_cast<uint8_t>(chr);
+		return bitmap[uchr / 64] & (uint64_t(1) << (uchr % 64));
+	}
+
+	/** Decodes a character to its index in the table.
+	 * \param chr The character to decode.
+	 * \return The index of the character or INVALID if it is not in the table.
+	 */
+	constexpr uint8_t Decode(char chr) const { return indices[static_cast<uint8_t>(chr)]; }
+
+	/** Encodes an index to its character in the table.
+	 * \param idx The index to encode. Must be less than Size.
+	 * \return The character at the specified index.
+	 */
+	constexpr char Encode(size_t idx) const { return characters[idx]; }
+
+	/** Retrieves the bitmap of the characters which are in the table. */
+	constexpr const std::array<uint64_t, 4>& GetBitmap() const { return bitmap; }
+
+	/** Retrieves the characters in the table as a null-terminated string. */
+	constexpr const char* GetCharacters() const { return characters; }
+
+	/** Allows the table to be used where a null-terminated table string is expected. */
+	constexpr operator const char*() const { return characters; }
+};
+
+/** BasicDecodeResult holds either the decoded form of some data or the details of why it could not be decoded. */
+template <typename String>
+class Oulu::BasicDecodeResult final
+{
+public:
+	/** The decoded form of the data. This is empty if an error occurred. */
+	String data;
+
+	/** The kind of error which occurred or DecodeError::NONE if the data was decoded successfully. */
+	DecodeError error = DecodeError::NONE;
+
+	/** If an error occurred then the offset of the character in the encoded data which caused it. If
+	 * the data was truncated then this is the offset of the first missing character.
+	 */
+	size_t position = 0;
+
+	/** Creates a BasicDecodeResult which holds decoded data.
+	 * \param d The decoded form of the data.
+	 */
+	explicit BasicDecodeResult(String&& d = {})
+		: data(std::move(d))
+	{
+	}
+
+	/** Creates a BasicDecodeResult which holds the details of an error.
+	 * \param e The kind of error which occurred.
+	 * \param p The offset of the character in the encoded data which caused the error.
+	 */
+	BasicDecodeResult(DecodeError e, size_t p)
+		: error(e)
+		, position(p)
+	{
+	}
+
+	/** Determines whether the data was decoded successfully. */
+	explicit operator bool() const { return error == DecodeError::NONE; }
+};
 
 namespace Oulu
 {
 	/** The table used when handling regular Base64-encoded strings. */
-	inline constexpr const char* BASE64_TABLE = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	inline constexpr Base64Table BASE64_TABLE("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
 
 	/** The table used when handling Base64URL-encoded strings. */
-	inline constexpr const char* BASE64_URL_TABLE = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+	inline constexpr Base64Table BASE64_URL_TABLE("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_");
+
+	/** The table used for encoding as a lower-case hexadecimal string. Decodes either case. */
+	inline constexpr HexTable HEX_TABLE_LOWER("0123456789abcdef", true);
+
+	/** The table used for encoding as an upper-case hexadecimal string. Decodes either case. */
+	inline constexpr HexTable HEX_TABLE_UPPER("0123456789ABCDEF", true);
+
+	/** The table used to determine what characters are safe within a percent-encoded string. */
+	inline constexpr CharacterSet PERCENT_TABLE("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~");
+
+	/** Calculates the length of the Base64-encoded form of a byte array.
+	 * \param length The length of the byte array.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The number of characters that encoding will produce.
+	 */
+	constexpr size_t Base64EncodedLength(size_t length, char padding = '=')
+	{
+		return padding ? 4 * ((length + 2) / 3) : ((4 * length) + 2) / 3;
+	}
+
+	/** Calculates the maximum length of the decoded form of a Base64-encoded byte array.
+	 * \param length The length of the byte array.
+	 * \return The maximum number of octets that decoding can produce.
+	 */
+	constexpr size_t Base64DecodedLength(size_t length)
+	{
+		return (length * 3) / 4;
+	}
+
+	/** Calculates the length of the hexadecimal-encoded form of a byte array.
+	 * \param length The length of the byte array.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The number of characters that encoding will produce.
+	 */
+	constexpr size_t HexEncodedLength(size_t length, char separator = 0)
+	{
+		return (length * 2) + (separator && length ? length - 1 : 0);
+	}
 
-	/** The table used for encoding as a lower-case hexadecimal string. */
-	inline constexpr const char* HEX_TABLE_LOWER = "0123456789abcdef";
+	/** Calculates the length of the decoded form of a hexadecimal-encoded byte array.
+	 * \param length The length of the byte array.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The number of octets that decoding will produce.
+	 */
+	constexpr size_t HexDecodedLength(size_t length, char separator = 0)
+	{
+		return length < 2 ? 0 : ((length - 2) / (separator ? 3 : 2)) + 1;
+	}
+
+	/** Calculates the maximum length of the percent-encoded form of a byte array.
+	 * \param length The length of the byte array.
+	 * \return The maximum number of characters that encoding can produce.
+	 */
+	constexpr size_t PercentEncodedLength(size_t length)
+	{
+		return length * 3;
+	}
+
+	/** Calculates the maximum length of the decoded form of a percent-encoded byte array.
+	 * \param length The length of the byte array.
+	 * \return The maximum number of octets that decoding can produce.
+	 */
+	constexpr size_t PercentDecodedLength(size_t length)
+	{
+		return length;
+	}
+
+	/** Decodes a Base64-encoded string and writes the decoded form through an output iterator.
+	 * \param out The output iterator to write the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \return The output iterator after the last octet written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator Base64DecodeTo(OutputIterator out, const std::string_view& data, const Base64Table& table = BASE64_TABLE)
+	{
+		uint32_t current_bits = 0;
+		size_t seen_bits = 0;
+		for (const auto chr : data)
+		{
+			// Attempt to find the octet in the table.
+			const auto value = table.Decode(chr);
+			if (value == Base64Table::INVALID)
+				continue; // Skip invalid octets.
+
+			// Add the bits for this octet to the active buffer.
+			current_bits = (current_bits << 6) | value;
+			seen_bits += 6;
+
+			if (seen_bits >= 8)
+			{
+				// We have seen an entire octet; add it to the output.
+				seen_bits -= 8;
+				*out++ = static_cast<char>((current_bits >> seen_bits) & 0xFF);
+			}
+		}
+		return out;
+	}
+
+	/** Decodes a Base64-encoded byte array.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \return The decoded form of the specified data.
+	 */
+	std::string Base64Decode(const void* data, size_t length, const Base64Table& table);
+
+	/** Decodes a Base64-encoded byte array.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \return The decoded form of the specified data.
+	 */
+	inline std::string Base64Decode(const void* data, size_t length, const char* table = nullptr)
+	{
+		return table ? Base64Decode(data, length, Base64Table(table)) : Base64Decode(data, length, BASE64_TABLE);
+	}
+
+	/** Decodes a Base64-encoded string.
+	 * \param data The string view decode from.
+	 * \param table The index table to use for decoding.
+	 * \return The decoded form of the specified data.
+	 */
+	constexpr std::string Base64Decode(const std::string_view& data, const Base64Table& table)
+	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			Base64DecodeTo(std::back_inserter(out), data, table);
+			return out;
+		}
+		return Base64Decode(data.data(), data.length(), table);
+	}
+
+	/** Decodes a Base64-encoded string.
+	 * \param data The string view decode from.
+	 * \param table The index table to use for decoding.
+	 * \return The decoded form of the specified data.
+	 */
+	constexpr std::string Base64Decode(const std::string_view& data, const char* table = nullptr)
+	{
+		if (table)
+			return Base64Decode(data, Base64Table(table));
+		return Base64Decode(data, BASE64_TABLE);
+	}
+
+	/** Decodes a Base64-encoded byte array and appends the decoded form to a string.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 */
+	void Base64DecodeTo(std::string& out, const void* data, size_t length, const Base64Table& table);
+
+	/** Decodes a Base64-encoded string and appends the decoded form to a string.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 */
+	inline void Base64DecodeTo(std::string& out, const std::string_view& data, const Base64Table& table = BASE64_TABLE)
+	{
+		Base64DecodeTo(out, data.data(), data.length(), table);
+	}
+
+	/** Decodes a Base64-encoded byte array and appends the decoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 */
+	void Base64DecodeTo(std::pmr::string& out, const void* data, size_t length, const Base64Table& table);
+
+	/** Decodes a Base64-encoded string and appends the decoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 */
+	inline void Base64DecodeTo(std::pmr::string& out, const std::string_view& data, const Base64Table& table = BASE64_TABLE)
+	{
+		Base64DecodeTo(out, data.data(), data.length(), table);
+	}
+
+	/** Decodes a Base64-encoded string into a string which uses a polymorphic allocator.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \param table The index table to use for decoding.
+	 * \return The decoded form of the specified data.
+	 */
+	inline std::pmr::string Base64Decode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const Base64Table& table = BASE64_TABLE)
+	{
+		std::pmr::string out(allocator);
+		Base64DecodeTo(out, data, table);
+		return out;
+	}
+
+	/** Decodes a Base64-encoded byte array into a caller-provided buffer.
+	 * \param out The buffer to write the decoded form to. This must be at least Base64DecodedLength() octets long.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \return The number of octets written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> Base64DecodeTo(std::span<char> out, const void* data, size_t length, const Base64Table& table);
+
+	/** Decodes a Base64-encoded string into a caller-provided buffer.
+	 * \param out The buffer to write the decoded form to. This must be at least Base64DecodedLength() octets long.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \return The number of octets written or std::nullopt if the buffer is too small.
+	 */
+	inline std::optional<size_t> Base64DecodeTo(std::span<char> out, const std::string_view& data, const Base64Table& table = BASE64_TABLE)
+	{
+		return Base64DecodeTo(out, data.data(), data.length(), table);
+	}
 
-	/** The table used for encoding as an upper-case hexadecimal string. */
-	inline constexpr const char* HEX_TABLE_UPPER = "0123456789ABCDEF";
+	/** Decodes a Base64-encoded buffer in place. Decoding never produces more octets than it consumes
+	 * so the decoded form overwrites the start of the buffer.
+	 * \param data The buffer to decode.
+	 * \param table The index table to use for decoding.
+	 * \return A view of the decoded form at the start of the buffer.
+	 */
+	std::string_view Base64DecodeInPlace(std::span<char> data, const Base64Table& table = BASE64_TABLE);
+
+	/** Encodes a string using Base64 and writes the encoded form through an output iterator.
+	 * \param out The output iterator to write the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The output iterator after the last character written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator Base64EncodeTo(OutputIterator out, const std::string_view& data, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		size_t idx = 0;
+		for ( ; idx + 2 < data.length(); idx += 3)
+		{
+			// Base64 encodes three octets into four characters.
+			const auto triple = (static_cast<uint32_t>(static_cast<uint8_t>(data[idx])) << 16)
+				+ (static_cast<uint32_t>(static_cast<uint8_t>(data[idx + 1])) << 8)
+				+ static_cast<uint8_t>(data[idx + 2]);
+			*out++ = table.Encode((triple >> 3 * 6) & 63);
+			*out++ = table.Encode((triple >> 2 * 6) & 63);
+			*out++ = table.Encode((triple >> 1 * 6) & 63);
+			*out++ = table.Encode((triple >> 0 * 6) & 63);
+		}
+
+		if (idx < data.length())
+		{
+			// Encode the remaining one or two octets and pad them if needed.
+			const auto remaining = data.length() - idx;
+			const uint32_t octet1 = static_cast<uint8_t>(data[idx]);
+			const uint32_t octet2 = remaining > 1 ? static_cast<uint8_t>(data[idx + 1]) : 0;
+			const uint32_t triple = (octet1 << 16) + (octet2 << 8);
+
+			*out++ = table.Encode((triple >> 3 * 6) & 63);
+			*out++ = table.Encode((triple >> 2 * 6) & 63);
+			if (remaining > 1)
+				*out++ = table.Encode((triple >> 1 * 6) & 63);
+			else if (padding)
+				*out++ = padding;
+			if (padding)
+				*out++ = padding;
+		}
+		return out;
+	}
+
+	/** Encodes a byte array using Base64.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The encoded form of the specified data.
+	 */
+	std::string Base64Encode(const void* data, size_t length, const Base64Table& table, char padding = '=');
+
+	/** Encodes a byte array using Base64.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The encoded form of the specified data.
+	 */
+	inline std::string Base64Encode(const void* data, size_t length, const char* table = nullptr, char padding = '=')
+	{
+		return table ? Base64Encode(data, length, Base64Table(table), padding) : Base64Encode(data, length, BASE64_TABLE, padding);
+	}
+
+	/** Encodes a string using Base64.
+	 * \param data The string view encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The encoded form of the specified data.
+	 */
+	constexpr std::string Base64Encode(const std::string_view& data, const Base64Table& table, char padding = '=')
+	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			Base64EncodeTo(std::back_inserter(out), data, table, padding);
+			return out;
+		}
+		return Base64Encode(data.data(), data.length(), table, padding);
+	}
+
+	/** Encodes a string using Base64.
+	 * \param data The string view encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The encoded form of the specified data.
+	 */
+	constexpr std::string Base64Encode(const std::string_view& data, const char* table = nullptr, char padding = '=')
+	{
+		if (table)
+			return Base64Encode(data, Base64Table(table), padding);
+		return Base64Encode(data, BASE64_TABLE, padding);
+	}
+
+	/** Encodes a byte array using Base64 and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 */
+	void Base64EncodeTo(std::string& out, const void* data, size_t length, const Base64Table& table, char padding = '=');
+
+	/** Encodes a string using Base64 and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 */
+	inline void Base64EncodeTo(std::string& out, const std::string_view& data, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		Base64EncodeTo(out, data.data(), data.length(), table, padding);
+	}
+
+	/** Encodes a byte array using Base64 and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 */
+	void Base64EncodeTo(std::pmr::string& out, const void* data, size_t length, const Base64Table& table, char padding = '=');
+
+	/** Encodes a string using Base64 and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 */
+	inline void Base64EncodeTo(std::pmr::string& out, const std::string_view& data, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		Base64EncodeTo(out, data.data(), data.length(), table, padding);
+	}
+
+	/** Encodes a string using Base64 into a string which uses a polymorphic allocator.
+	 * \param data The string view to encode from.
+	 * \param allocator The allocator to allocate the encoded form with.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The encoded form of the specified data.
+	 */
+	inline std::pmr::string Base64Encode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		std::pmr::string out(allocator);
+		Base64EncodeTo(out, data, table, padding);
+		return out;
+	}
+
+	/** Encodes a byte array using Base64 into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least Base64EncodedLength() characters long.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> Base64EncodeTo(std::span<char> out, const void* data, size_t length, const Base64Table& table, char padding = '=');
+
+	/** Encodes a string using Base64 into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least Base64EncodedLength() characters long.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	inline std::optional<size_t> Base64EncodeTo(std::span<char> out, const std::string_view& data, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		return Base64EncodeTo(out, data.data(), data.length(), table, padding);
+	}
+
+	/** Decodes a hexadecimal-encoded string and writes the decoded form through an output iterator.
+	 * Invalid digits are decoded as zero.
+	 * \param out The output iterator to write the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The output iterator after the last octet written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator HexDecodeTo(OutputIterator out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		// The size of each hex segment.
+		const size_t segment = (separator ? 3 : 2);
+
+		for (size_t idx = 0; idx + 1 < data.length(); idx += segment)
+		{
+			// Attempt to find the octets in the table.
+			const auto value1 = table.Decode(data[idx]);
+			const auto value2 = table.Decode(data[idx + 1]);
+
+			const auto pair = ((value1 != HexTable::INVALID ? value1 : 0) << 4)
+				+ (value2 != HexTable::INVALID ? value2 : 0);
+			*out++ = static_cast<char>(pair);
+		}
+		return out;
+	}
+
+	/** Decodes a hexadecimal-encoded byte array. Invalid digits are decoded as zero.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The decoded form of the specified data.
+	 */
+	std::string HexDecode(const void* data, size_t length, const HexTable& table, char separator = 0);
+
+	/** Decodes a hexadecimal-encoded byte array. Invalid digits are decoded as zero.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The decoded form of the specified data.
+	 */
+	inline std::string HexDecode(const void* data, size_t length, const char* table = nullptr, char separator = 0)
+	{
+		return table ? HexDecode(data, length, HexTable(table), separator) : HexDecode(data, length, HEX_TABLE_LOWER, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded string. Invalid digits are decoded as zero.
+	 * \param data The string view decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The decoded form of the specified data.
+	 */
+	constexpr std::string HexDecode(const std::string_view& data, const HexTable& table, char separator = 0)
+	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			HexDecodeTo(std::back_inserter(out), data, table, separator);
+			return out;
+		}
+		return HexDecode(data.data(), data.length(), table, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded string. Invalid digits are decoded as zero.
+	 * \param data The string view decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The decoded form of the specified data.
+	 */
+	constexpr std::string HexDecode(const std::string_view& data, const char* table = nullptr, char separator = 0)
+	{
+		if (table)
+			return HexDecode(data, HexTable(table), separator);
+		return HexDecode(data, HEX_TABLE_LOWER, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded byte array and appends the decoded form to a string. Invalid
+	 * digits are decoded as zero.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return True if the data was well formed; otherwise, false.
+	 */
+	bool HexDecodeTo(std::string& out, const void* data, size_t length, const HexTable& table, char separator = 0);
+
+	/** Decodes a hexadecimal-encoded string and appends the decoded form to a string. Invalid digits
+	 * are decoded as zero.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return True if the data was well formed; otherwise, false.
+	 */
+	inline bool HexDecodeTo(std::string& out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		return HexDecodeTo(out, data.data(), data.length(), table, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded byte array and appends the decoded form to a string which uses a
+	 * polymorphic allocator. Invalid digits are decoded as zero.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return True if the data was well formed; otherwise, false.
+	 */
+	bool HexDecodeTo(std::pmr::string& out, const void* data, size_t length, const HexTable& table, char separator = 0);
+
+	/** Decodes a hexadecimal-encoded string and appends the decoded form to a string which uses a
+	 * polymorphic allocator. Invalid digits are decoded as zero.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return True if the data was well formed; otherwise, false.
+	 */
+	inline bool HexDecodeTo(std::pmr::string& out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		return HexDecodeTo(out, data.data(), data.length(), table, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded string into a string which uses a polymorphic allocator. Invalid
+	 * digits are decoded as zero.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The decoded form of the specified data.
+	 */
+	inline std::pmr::string HexDecode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		std::pmr::string out(allocator);
+		HexDecodeTo(out, data, table, separator);
+		return out;
+	}
+
+	/** Decodes a hexadecimal-encoded byte array into a caller-provided buffer. Unlike the other
+	 * decoding functions this fails if the data is not well formed.
+	 * \param out The buffer to write the decoded form to. This must be at least HexDecodedLength() octets long.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The number of octets written or std::nullopt if the buffer is too small or the data is not well formed.
+	 */
+	std::optional<size_t> HexDecodeTo(std::span<char> out, const void* data, size_t length, const HexTable& table, char separator = 0);
+
+	/** Decodes a hexadecimal-encoded string into a caller-provided buffer. Unlike the other
+	 * decoding functions this fails if the data is not well formed.
+	 * \param out The buffer to write the decoded form to. This must be at least HexDecodedLength() octets long.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return The number of octets written or std::nullopt if the buffer is too small or the data is not well formed.
+	 */
+	inline std::optional<size_t> HexDecodeTo(std::span<char> out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		return HexDecodeTo(out, data.data(), data.length(), table, separator);
+	}
+
+	/** Decodes a hexadecimal-encoded buffer in place. Decoding never produces more octets than it
+	 * consumes so the decoded form overwrites the start of the buffer.
+	 * \param data The buffer to decode.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return A view of the decoded form at the start of the buffer or std::nullopt if the data is malformed.
+	 */
+	std::optional<std::string_view> HexDecodeInPlace(std::span<char> data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0);
+
+	/** Encodes a string using hexadecimal encoding and writes the encoded form through an output iterator.
+	 * \param out The output iterator to write the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The output iterator after the last character written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator HexEncodeTo(OutputIterator out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		for (size_t idx = 0; idx < data.length(); ++idx)
+		{
+			if (idx && separator)
+				*out++ = separator;
 
-	/** The table used to determine what characters are safe within a percent-encoded string. */
-	inline constexpr const char* PERCENT_TABLE = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_.~";
+			const auto chr = static_cast<uint8_t>(data[idx]);
+			*out++ = table.Encode(chr >> 4);
+			*out++ = table.Encode(chr & 15);
+		}
+		return out;
+	}
 
-	/** Decodes a Base64-encoded byte array.
-	 * \param data The byte array to decode from.
+	/** Encodes a byte array using hexadecimal encoding.
+	 * \param data The byte array to encode from.
 	 * \param length The length of the byte array.
-	 * \param table The index table to use for decoding.
-	 * \return The decoded form of the specified data.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The encoded form of the specified data.
 	 */
-	std::string Base64Decode(const void* data, size_t length, const char* table = nullptr);
+	std::string HexEncode(const void* data, size_t length, const HexTable& table, char separator = 0);
 
-	/** Decodes a Base64-encoded string.
-	 * \param data The string view decode from.
-	 * \param table The index table to use for decoding.
-	 * \return The decoded form of the specified data.
+	/** Encodes a byte array using hexadecimal encoding.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The encoded form of the specified data.
 	 */
-	inline std::string Base64Decode(const std::string_view& data, const char* table = nullptr)
+	inline std::string HexEncode(const void* data, size_t length, const char* table = nullptr, char separator = 0)
 	{
-		return Base64Decode(data.data(), data.length(), table);
+		return table ? HexEncode(data, length, HexTable(table), separator) : HexEncode(data, length, HEX_TABLE_LOWER, separator);
 	}
 
-	/** Encodes a byte array using Base64.
-	 * \param data The byte array to encode from.
-	 * \param length The length of the byte array.
+	/** Encodes a string using hexadecimal encoding.
+	 * \param data The string view encode from.
 	 * \param table The index table to use for encoding.
-	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
 	 * \return The encoded form of the specified data.
 	 */
-	std::string Base64Encode(const void* data, size_t length, const char* table = nullptr, char padding = '=');
+	constexpr std::string HexEncode(const std::string_view& data, const HexTable& table, char separator = 0)
+	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			HexEncodeTo(std::back_inserter(out), data, table, separator);
+			return out;
+		}
+		return HexEncode(data.data(), data.length(), table, separator);
+	}
 
-	/** Encodes a string using Base64.
+	/** Encodes a string using hexadecimal encoding.
 	 * \param data The string view encode from.
 	 * \param table The index table to use for encoding.
-	 * \param padding If non-zero then the character to pad encoded strings with.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
 	 * \return The encoded form of the specified data.
 	 */
-	inline std::string Base64Encode(const std::string_view& data, const char* table = nullptr, char padding = '=')
+	constexpr std::string HexEncode(const std::string_view& data, const char* table = nullptr, char separator = 0)
 	{
-		return Base64Encode(data.data(), data.length(), table, padding);
+		if (table)
+			return HexEncode(data, HexTable(table), separator);
+		return HexEncode(data, HEX_TABLE_LOWER, separator);
 	}
 
-	/** Decodes a hexadecimal-encoded byte array.
-	 * \param data The byte array to decode from.
+	/** Encodes a byte array using hexadecimal encoding and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The byte array to encode from.
 	 * \param length The length of the byte array.
-	 * \param separator If non-zero then the character hexadecimal digits are separated with.
-	 * \param table The index table to use for decoding.
-	 * \return The decoded form of the specified data.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
 	 */
-	std::string HexDecode(const void* data, size_t length, const char* table = nullptr, char separator = 0);
+	void HexEncodeTo(std::string& out, const void* data, size_t length, const HexTable& table, char separator = 0);
 
-	/** Decodes a hexadecimal-encoded string.
-	 * \param data The string view decode from.
-	 * \param table The index table to use for decoding.
-	 * \param separator If non-zero then the character hexadecimal digits are separated with.
-	 * \return The decoded form of the specified data.
+	/** Encodes a string using hexadecimal encoding and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
 	 */
-	inline std::string HexDecode(const std::string_view& data, const char* table = nullptr, char separator = 0)
+	inline void HexEncodeTo(std::string& out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
 	{
-		return HexDecode(data.data(), data.length(), table, separator);
+		HexEncodeTo(out, data.data(), data.length(), table, separator);
 	}
 
-	/** Encodes a byte array using hexadecimal encoding.
+	/** Encodes a byte array using hexadecimal encoding and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
 	 * \param data The byte array to encode from.
 	 * \param length The length of the byte array.
 	 * \param table The index table to use for encoding.
 	 * \param separator If non-zero then the character to separate hexadecimal digits with.
-	 * \return The encoded form of the specified data.
 	 */
-	std::string HexEncode(const void* data, size_t length, const char* table = nullptr, char separator = 0);
+	void HexEncodeTo(std::pmr::string& out, const void* data, size_t length, const HexTable& table, char separator = 0);
 
-	/** Encodes a string using Base64.
-	 * \param data The string view encode from.
+	/** Encodes a string using hexadecimal encoding and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 */
+	inline void HexEncodeTo(std::pmr::string& out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		HexEncodeTo(out, data.data(), data.length(), table, separator);
+	}
+
+	/** Encodes a string using hexadecimal encoding into a string which uses a polymorphic allocator.
+	 * \param data The string view to encode from.
+	 * \param allocator The allocator to allocate the encoded form with.
 	 * \param table The index table to use for encoding.
 	 * \param separator If non-zero then the character to separate hexadecimal digits with.
 	 * \return The encoded form of the specified data.
 	 */
-	inline std::string HexEncode(const std::string_view& data, const char* table = nullptr, char separator = 0)
+	inline std::pmr::string HexEncode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
 	{
-		return HexEncode(data.data(), data.length(), table, separator);
+		std::pmr::string out(allocator);
+		HexEncodeTo(out, data, table, separator);
+		return out;
+	}
+
+	/** Encodes a byte array using hexadecimal encoding into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least HexEncodedLength() characters long.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> HexEncodeTo(std::span<char> out, const void* data, size_t length, const HexTable& table, char separator = 0);
+
+	/** Encodes a string using hexadecimal encoding into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least HexEncodedLength() characters long.
+	 * \param data The string view to encode from.
+	 * \param table The index table to use for encoding.
+	 * \param separator If non-zero then the character to separate hexadecimal digits with.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	inline std::optional<size_t> HexEncodeTo(std::span<char> out, const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		return HexEncodeTo(out, data.data(), data.length(), table, separator);
+	}
+
+	/** Decodes a percent-encoded string and writes the decoded form through an output iterator.
+	 * \param out The output iterator to write the decoded form to.
+	 * \param data The string view to decode from.
+	 * \return The output iterator after the last octet written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator PercentDecodeTo(OutputIterator out, const std::string_view& data)
+	{
+		for (size_t idx = 0; idx < data.length(); ++idx)
+		{
+			if (data[idx] != '%')
+			{
+				*out++ = data[idx];
+				continue;
+			}
+
+			// Percent encoding encodes two octets into 1-2 characters.
+			uint8_t values[2] = { };
+			for (auto& value : values)
+			{
+				if (++idx >= data.length())
+					break;
+
+				value = HEX_TABLE_UPPER.Decode(data[idx]);
+				if (value == HexTable::INVALID)
+					value = 0;
+			}
+			*out++ = static_cast<char>((values[0] << 4) + values[1]);
+		}
+		return out;
 	}
 
 	/** Decodes a percent-encoded byte array.
@@ -112,11 +1007,127 @@ namespace Oulu
 	 * \param data The string view decode from.
 	 * \return The decoded form of the specified data.
 	 */
-	inline std::string PercentDecode(const std::string_view& data)
+	constexpr std::string PercentDecode(const std::string_view& data)
 	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			PercentDecodeTo(std::back_inserter(out), data);
+			return out;
+		}
 		return PercentDecode(data.data(), data.length());
 	}
 
+	/** Decodes a percent-encoded byte array and appends the decoded form to a string.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 */
+	void PercentDecodeTo(std::string& out, const void* data, size_t length);
+
+	/** Decodes a percent-encoded string and appends the decoded form to a string.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 */
+	inline void PercentDecodeTo(std::string& out, const std::string_view& data)
+	{
+		PercentDecodeTo(out, data.data(), data.length());
+	}
+
+	/** Decodes a percent-encoded byte array and appends the decoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the decoded form to.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 */
+	void PercentDecodeTo(std::pmr::string& out, const void* data, size_t length);
+
+	/** Decodes a percent-encoded string and appends the decoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the decoded form to.
+	 * \param data The string view to decode from.
+	 */
+	inline void PercentDecodeTo(std::pmr::string& out, const std::string_view& data)
+	{
+		PercentDecodeTo(out, data.data(), data.length());
+	}
+
+	/** Decodes a percent-encoded string into a string which uses a polymorphic allocator.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \return The decoded form of the specified data.
+	 */
+	inline std::pmr::string PercentDecode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator)
+	{
+		std::pmr::string out(allocator);
+		PercentDecodeTo(out, data);
+		return out;
+	}
+
+	/** Decodes a percent-encoded byte array into a caller-provided buffer.
+	 * \param out The buffer to write the decoded form to. This must be at least PercentDecodedLength() octets long.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \return The number of octets written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> PercentDecodeTo(std::span<char> out, const void* data, size_t length);
+
+	/** Decodes a percent-encoded string into a caller-provided buffer.
+	 * \param out The buffer to write the decoded form to. This must be at least PercentDecodedLength() octets long.
+	 * \param data The string view to decode from.
+	 * \return The number of octets written or std::nullopt if the buffer is too small.
+	 */
+	inline std::optional<size_t> PercentDecodeTo(std::span<char> out, const std::string_view& data)
+	{
+		return PercentDecodeTo(out, data.data(), data.length());
+	}
+
+	/** Decodes a percent-encoded buffer in place. Decoding never produces more octets than it
+	 * consumes so the decoded form overwrites the start of the buffer.
+	 * \param data The buffer to decode.
+	 * \return A view of the decoded form at the start of the buffer.
+	 */
+	std::string_view PercentDecodeInPlace(std::span<char> data);
+
+	/** Encodes a string using percent encoding and writes the encoded form through an output iterator.
+	 * \param out The output iterator to write the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The output iterator after the last character written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator PercentEncodeTo(OutputIterator out, const std::string_view& data, const CharacterSet& table = PERCENT_TABLE, bool upper = true)
+	{
+		const auto& hex_table = upper ? HEX_TABLE_UPPER : HEX_TABLE_LOWER;
+		for (const auto chr : data)
+		{
+			const auto uchr = static_cast<uint8_t>(chr);
+			if (table.Contains(chr))
+			{
+				// The character is on the safe list; push it as is.
+				*out++ = chr;
+			}
+			else
+			{
+				// The character is not on the safe list; percent encode it.
+				*out++ = '%';
+				*out++ = hex_table.Encode(uchr >> 4);
+				*out++ = hex_table.Encode(uchr & 15);
+			}
+		}
+		return out;
+	}
+
+	/** Encodes a byte array using percent encoding.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The encoded form of the specified data.
+	 */
+	std::string PercentEncode(const void* data, size_t length, const CharacterSet& table, bool upper = true);
+
 	/** Encodes a byte array using percent encoding.
 	 * \param data The byte array to encode from.
 	 * \param length The length of the byte array.
@@ -124,16 +1135,356 @@ namespace Oulu
 	 * \param upper Whether to use upper or lower case.
 	 * \return The encoded form of the specified data.
 	 */
-	std::string PercentEncode(const void* data, size_t length, const char* table = nullptr, bool upper = true);
+	inline std::string PercentEncode(const void* data, size_t length, const char* table = nullptr, bool upper = true)
+	{
+		return table ? PercentEncode(data, length, CharacterSet(table), upper) : PercentEncode(data, length, PERCENT_TABLE, upper);
+	}
 
 	/** Encodes a string using percent encoding.
 	 * \param data The string view encode from.
-	 * \param table The table of characters that do not require escaping.
+	 * \param table The set of characters that do not require escaping.
 	 * \param upper Whether to use upper or lower case.
 	 * \return The encoded form of the specified data.
 	 */
-	inline std::string PercentEncode(const std::string_view& data, const char* table = nullptr, bool upper = true)
+	constexpr std::string PercentEncode(const std::string_view& data, const CharacterSet& table, bool upper = true)
 	{
+		if (std::is_constant_evaluated())
+		{
+			std::string out;
+			PercentEncodeTo(std::back_inserter(out), data, table, upper);
+			return out;
+		}
 		return PercentEncode(data.data(), data.length(), table, upper);
 	}
+
+	/** Encodes a string using percent encoding.
+	 * \param data The string view encode from.
+	 * \param table The table of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The encoded form of the specified data.
+	 */
+	constexpr std::string PercentEncode(const std::string_view& data, const char* table = nullptr, bool upper = true)
+	{
+		if (table)
+			return PercentEncode(data, CharacterSet(table), upper);
+		return PercentEncode(data, PERCENT_TABLE, upper);
+	}
+
+	/** Encodes a byte array using percent encoding and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 */
+	void PercentEncodeTo(std::string& out, const void* data, size_t length, const CharacterSet& table, bool upper = true);
+
+	/** Encodes a string using percent encoding and appends the encoded form to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 */
+	inline void PercentEncodeTo(std::string& out, const std::string_view& data, const CharacterSet& table = PERCENT_TABLE, bool upper = true)
+	{
+		PercentEncodeTo(out, data.data(), data.length(), table, upper);
+	}
+
+	/** Encodes a byte array using percent encoding and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 */
+	void PercentEncodeTo(std::pmr::string& out, const void* data, size_t length, const CharacterSet& table, bool upper = true);
+
+	/** Encodes a string using percent encoding and appends the encoded form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the encoded form to.
+	 * \param data The string view to encode from.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 */
+	inline void PercentEncodeTo(std::pmr::string& out, const std::string_view& data, const CharacterSet& table = PERCENT_TABLE, bool upper = true)
+	{
+		PercentEncodeTo(out, data.data(), data.length(), table, upper);
+	}
+
+	/** Encodes a string using percent encoding into a string which uses a polymorphic allocator.
+	 * \param data The string view to encode from.
+	 * \param allocator The allocator to allocate the encoded form with.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The encoded form of the specified data.
+	 */
+	inline std::pmr::string PercentEncode(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const CharacterSet& table = PERCENT_TABLE, bool upper = true)
+	{
+		std::pmr::string out(allocator);
+		PercentEncodeTo(out, data, table, upper);
+		return out;
+	}
+
+	/** Encodes a byte array using percent encoding into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least PercentEncodedLength() characters long.
+	 * \param data The byte array to encode from.
+	 * \param length The length of the byte array.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> PercentEncodeTo(std::span<char> out, const void* data, size_t length, const CharacterSet& table, bool upper = true);
+
+	/** Encodes a string using percent encoding into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least PercentEncodedLength() characters long.
+	 * \param data The string view to encode from.
+	 * \param table The set of characters that do not require escaping.
+	 * \param upper Whether to use upper or lower case.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	inline std::optional<size_t> PercentEncodeTo(std::span<char> out, const std::string_view& data, const CharacterSet& table = PERCENT_TABLE, bool upper = true)
+	{
+		return PercentEncodeTo(out, data.data(), data.length(), table, upper);
+	}
+
+	/** Strictly decodes a Base64-encoded byte array. Decoding stops at the first character which is
+	 * not in the table or is misplaced padding.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param padding If non-zero then the character which the data must be padded with; otherwise, the
+	 *                data must not be padded.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	DecodeResult Base64DecodeStrict(const void* data, size_t length, const Base64Table& table = BASE64_TABLE, char padding = '=');
+
+	/** Strictly decodes a Base64-encoded string. Decoding stops at the first character which is not
+	 * in the table or is misplaced padding.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param padding If non-zero then the character which the data must be padded with; otherwise, the
+	 *                data must not be padded.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	inline DecodeResult Base64DecodeStrict(const std::string_view& data, const Base64Table& table = BASE64_TABLE, char padding = '=')
+	{
+		return Base64DecodeStrict(data.data(), data.length(), table, padding);
+	}
+
+	/** Strictly decodes a Base64-encoded string into a string which uses a polymorphic allocator.
+	 * Decoding stops at the first character which is not in the table or is misplaced padding.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \param table The index table to use for decoding.
+	 * \param padding If non-zero then the character which the data must be padded with; otherwise, the
+	 *                data must not be padded.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	PmrDecodeResult Base64DecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const Base64Table& table = BASE64_TABLE, char padding = '=');
+
+	/** Strictly decodes a hexadecimal-encoded byte array. Decoding stops at the first character
+	 * which is not a digit in the table or a separator in the expected position.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	DecodeResult HexDecodeStrict(const void* data, size_t length, const HexTable& table = HEX_TABLE_LOWER, char separator = 0);
+
+	/** Strictly decodes a hexadecimal-encoded string. Decoding stops at the first character which is
+	 * not a digit in the table or a separator in the expected position.
+	 * \param data The string view to decode from.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	inline DecodeResult HexDecodeStrict(const std::string_view& data, const HexTable& table = HEX_TABLE_LOWER, char separator = 0)
+	{
+		return HexDecodeStrict(data.data(), data.length(), table, separator);
+	}
+
+	/** Strictly decodes a hexadecimal-encoded string into a string which uses a polymorphic
+	 * allocator. Decoding stops at the first character which is not a digit in the table or a
+	 * separator in the expected position.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \param table The index table to use for decoding.
+	 * \param separator If non-zero then the character hexadecimal digits are separated with.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	PmrDecodeResult HexDecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator, const HexTable& table = HEX_TABLE_LOWER, char separator = 0);
+
+	/** Strictly decodes a percent-encoded byte array. Decoding stops at the first escape sequence
+	 * which is truncated or contains a character that is not a hexadecimal digit.
+	 * \param data The byte array to decode from.
+	 * \param length The length of the byte array.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	DecodeResult PercentDecodeStrict(const void* data, size_t length);
+
+	/** Strictly decodes a percent-encoded string. Decoding stops at the first escape sequence which
+	 * is truncated or contains a character that is not a hexadecimal digit.
+	 * \param data The string view to decode from.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	inline DecodeResult PercentDecodeStrict(const std::string_view& data)
+	{
+		return PercentDecodeStrict(data.data(), data.length());
+	}
+
+	/** Strictly decodes a percent-encoded string into a string which uses a polymorphic allocator.
+	 * Decoding stops at the first escape sequence which is truncated or contains a character that
+	 * is not a hexadecimal digit.
+	 * \param data The string view to decode from.
+	 * \param allocator The allocator to allocate the decoded form with.
+	 * \return Either the decoded form of the specified data or the details of the first error.
+	 */
+	PmrDecodeResult PercentDecodeStrict(const std::string_view& data, const std::pmr::polymorphic_allocator<char>& allocator);
 }
+
+/** Base64Decoder allows Base64-encoded data which arrives in chunks to be decoded incrementally. */
+class Oulu::Base64Decoder final
+{
+private:
+	/** The table to use for decoding. */
+	const Base64Table* table;
+
+	/** The bits which have been decoded but do not yet make up an entire octet. */
+	uint32_t current_bits = 0;
+
+	/** The number of bits in current_bits which have not been output yet. */
+	size_t seen_bits = 0;
+
+public:
+	/** Creates a Base64Decoder which uses the specified table.
+	 * \param t The index table to use for decoding. This must outlive the decoder.
+	 */
+	explicit Base64Decoder(const Base64Table& t = BASE64_TABLE);
+
+	/** Calculates the maximum number of octets that an update can produce.
+	 * \param length The length of the chunk that will be decoded.
+	 */
+	static constexpr size_t MaxUpdateLength(size_t length) { return Base64DecodedLength(length) + 1; }
+
+	/** Finishes decoding and resets the decoder so it can be reused.
+	 * \return True if the decoded data ended on a valid boundary; otherwise, false.
+	 */
+	bool Final();
+
+	/** Resets the decoder so it can be reused. */
+	void Reset();
+
+	/** Decodes a chunk of data and appends any complete octets to a string.
+	 * \param out The string to append the decoded form to.
+	 * \param data The chunk to decode.
+	 */
+	void Update(std::string& out, const std::string_view& data);
+
+	/** Decodes a chunk of data and writes any complete octets into a caller-provided buffer.
+	 * \param out The buffer to write the decoded form to. This must be at least MaxUpdateLength() octets long.
+	 * \param data The chunk to decode.
+	 * \return The number of octets written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> Update(std::span<char> out, const std::string_view& data);
+};
+
+/** Base64Encoder allows data which arrives in chunks to be Base64-encoded incrementally. */
+class Oulu::Base64Encoder final
+{
+private:
+	/** The table to use for encoding. */
+	const Base64Table* table;
+
+	/** If non-zero then the character to pad the encoded data with. */
+	char padding;
+
+	/** If non-zero then the length of the lines that encoded data is split into. */
+	size_t line_length;
+
+	/** The encoded data which has not yet been emitted as a line. */
+	std::string line;
+
+	/** The octets which have been received but do not yet make up an entire group. */
+	uint32_t current_bits = 0;
+
+	/** The number of bits in current_bits which have not been encoded yet. */
+	size_t seen_bits = 0;
+
+	/** Emits every complete line in the line buffer to a callback. */
+	template <typename Callback>
+	void EmitLines(Callback& callback, bool final)
+	{
+		size_t offset = 0;
+		for ( ; line_length && line.length() - offset >= line_length; offset += line_length)
+			callback(std::string_view(line).substr(offset, line_length));
+
+		if (final && offset < line.length())
+			callback(std::string_view(line).substr(offset));
+
+		line.erase(0, final ? line.length() : offset);
+	}
+
+public:
+	/** Creates a Base64Encoder which uses the specified table.
+	 * \param t The index table to use for encoding. This must outlive the encoder.
+	 * \param p If non-zero then the character to pad the encoded data with.
+	 * \param ll If non-zero then the length of the lines to split the encoded data into.
+	 */
+	explicit Base64Encoder(const Base64Table& t = BASE64_TABLE, char p = '=', size_t ll = 0);
+
+	/** Calculates the maximum number of characters that an update can produce.
+	 * \param length The length of the chunk that will be encoded.
+	 */
+	static constexpr size_t MaxUpdateLength(size_t length) { return Base64EncodedLength(length + 2); }
+
+	/** Finishes encoding, appends any remaining characters to a string, and resets the encoder so
+	 * it can be reused.
+	 * \param out The string to append the encoded form to.
+	 */
+	void Final(std::string& out);
+
+	/** Finishes encoding, emits the final line to a callback, and resets the encoder so it can be
+	 * reused. If the encoded data was empty or its length was a multiple of the line length then no
+	 * final line is emitted.
+	 * \param callback The callback to emit lines of the encoded form to.
+	 */
+	template <std::invocable<std::string_view> Callback>
+	void Final(Callback&& callback)
+	{
+		Final(line);
+		EmitLines(callback, true);
+	}
+
+	/** Retrieves the length of the lines that encoded data is split into. */
+	size_t GetLineLength() const { return line_length; }
+
+	/** Resets the encoder so it can be reused. */
+	void Reset();
+
+	/** Encodes a chunk of data and appends any complete groups to a string.
+	 * \param out The string to append the encoded form to.
+	 * \param data The chunk to encode.
+	 */
+	void Update(std::string& out, const std::string_view& data);
+
+	/** Encodes a chunk of data and writes any complete groups into a caller-provided buffer.
+	 * \param out The buffer to write the encoded form to. This must be at least MaxUpdateLength() characters long.
+	 * \param data The chunk to encode.
+	 * \return The number of characters written or std::nullopt if the buffer is too small.
+	 */
+	std::optional<size_t> Update(std::span<char> out, const std::string_view& data);
+
+	/** Encodes a chunk of data and emits every complete line to a callback. If the encoder was
+	 * created without a line length then the encoded data is emitted as a single line by Final.
+	 * \param data The chunk to encode.
+	 * \param callback The callback to emit lines of the encoded form to.
+	 */
+	template <std::invocable<std::string_view> Callback>
+	void Update(const std::string_view& data, Callback&& callback)
+	{
+		Update(line, data);
+		EmitLines(callback, false);
+	}
+};
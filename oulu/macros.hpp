@@ -29,3 +29,59 @@
  */
 #define OULU_STRINGIFY(ARG) OULU_STRINGIFY_INTERNAL(ARG)
 #define OULU_STRINGIFY_INTERNAL(ARG) #ARG
+
+/** \def OULU_ARCH_X86
+ * Defined if the target architecture is x86 or x86-64 and SIMD kernels using the SSE and AVX
+ * instruction sets can be built.
+ */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+# define OULU_ARCH_X86
+#endif
+
+/** \def OULU_ATTR_TARGET(TARGET)
+ * Allows a function to be compiled for a specific instruction set without enabling it for the rest
+ * of the translation unit. Functions marked with this attribute must only be called once the CPU
+ * has been checked for support of the instruction set.
+ */
+#ifdef __GNUC__
+# define OULU_ATTR_TARGET(TARGET) __attribute__((target(TARGET)))
+#else
+# define OULU_ATTR_TARGET(TARGET)
+#endif
+
+/** \def OULU_ENABLE_STATS
+ * If defined then the public functions which process strings record how often they are called into
+ * per-thread counters which can be read using Oulu::Stats::GetSnapshot. If not defined then the
+ * instrumentation is not compiled in at all. This is normally set using the OULU_ENABLE_STATS CMake
+ * option and must be the same for the library and its consumers.
+ */
+
+/** \def OULU_STATS_CALL(FUNCTION, BYTES)
+ * Records a call to a public function which was passed the specified number of bytes. If cycle
+ * histograms are enabled then the duration of the rest of the enclosing scope is also recorded. This
+ * can not be used in constexpr functions.
+ */
+
+/** \def OULU_STATS_COUNT(FUNCTION, BYTES)
+ * Records a call to a public function like OULU_STATS_CALL without recording its duration. This can
+ * be used in constexpr functions.
+ */
+
+/** \def OULU_STATS_FAILURE(FUNCTION)
+ * Records that a call to a public function failed or rejected its input.
+ */
+
+/** \def OULU_STATS_SLOW_PATH(FUNCTION)
+ * Records that a call to a public function could not use its fast path.
+ */
+#ifdef OULU_ENABLE_STATS
+# define OULU_STATS_CALL(FUNCTION, BYTES) const Oulu::Stats::CallScope oulu_stats_call(Oulu::Stats::Function::FUNCTION, BYTES)
+# define OULU_STATS_COUNT(FUNCTION, BYTES) Oulu::Stats::RecordCall(Oulu::Stats::Function::FUNCTION, BYTES)
+# define OULU_STATS_FAILURE(FUNCTION) Oulu::Stats::RecordFailure(Oulu::Stats::Function::FUNCTION)
+# define OULU_STATS_SLOW_PATH(FUNCTION) Oulu::Stats::RecordSlowPath(Oulu::Stats::Function::FUNCTION)
+#else
+# define OULU_STATS_CALL(FUNCTION, BYTES) static_cast<void>(0)
+# define OULU_STATS_COUNT(FUNCTION, BYTES) static_cast<void>(0)
+# define OULU_STATS_FAILURE(FUNCTION) static_cast<void>(0)
+# define OULU_STATS_SLOW_PATH(FUNCTION) static_cast<void>(0)
+#endif
@@ -1,198 +1,1201 @@
 // Oulu <https://github.com/inspircd/liboulu/>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
 #include <oulu/message.hpp>
+#include <oulu/simd.hpp>
+#include <oulu/stats.hpp>
 
-std::string Oulu::EscapeTag(const std::string_view& str)
+namespace
 {
-	std::string ret;
-	ret.reserve(str.size());
+	// The number of characters which are scanned for separators at once.
+	constexpr size_t SCAN_BLOCK_SIZE = 64;
+
+#ifdef OULU_ARCH_X86
+	OULU_ATTR_TARGET("sse4.1")
+	uint64_t SeparatorMaskSSE41(const char* data, char separator)
+	{
+		const auto sep = _mm_set1_epi8(separator);
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto matches = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(input, sep)));
+			mask |= static_cast<uint64_t>(matches) << idx;
+		}
+		return mask;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	uint64_t SeparatorMaskAVX2(const char* data, char separator)
+	{
+		const auto sep = _mm256_set1_epi8(separator);
+		const auto input1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		const auto input2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+		const auto matches1 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(input1, sep)));
+		const auto matches2 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(input2, sep)));
+		return (static_cast<uint64_t>(matches2) << 32) | matches1;
+	}
+#endif
+
+	// Builds a bitmask of the positions of a separator within a block of SCAN_BLOCK_SIZE characters
+	// using the best available kernel.
+	uint64_t SeparatorMask(const char* data, char separator)
+	{
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				return SeparatorMaskAVX2(data, separator);
+			case Oulu::SIMD::Level::SSE41:
+				return SeparatorMaskSSE41(data, separator);
+#endif
+			default:
+				break;
+		}
+
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; ++idx)
+			mask |= static_cast<uint64_t>(data[idx] == separator) << idx;
+		return mask;
+	}
+
+	// Gathers the high bit of each byte in a little-endian word into the low eight bits.
+	constexpr uint64_t GatherHighBits(uint64_t word)
+	{
+		return (((word >> 7) & uint64_t(0x0101010101010101)) * uint64_t(0x0102040810204080)) >> 56;
+	}
+
+	// Sets the high bit of each byte in a word which is equal to a character.
+	constexpr uint64_t MatchBytes(uint64_t word, char chr)
+	{
+		const auto low_bits = uint64_t(0x7F7F7F7F7F7F7F7F);
+		const auto diff = word ^ (uint64_t(0x0101010101010101) * static_cast<uint8_t>(chr));
+		return ~(((diff & low_bits) + low_bits) | diff | low_bits);
+	}
+
+	// Builds a bitmask of the positions of the characters which match a predicate within up to
+	// SCAN_BLOCK_SIZE characters. The word predicate must set the high bit of each matching byte in
+	// a word of eight characters.
+	template <typename Predicate, typename WordPredicate>
+	uint64_t ScalarMask(const char* data, size_t length, Predicate predicate, WordPredicate word_predicate)
+	{
+		uint64_t mask = 0;
+		size_t idx = 0;
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			// Check eight characters at a time using SWAR (SIMD within a register).
+			for ( ; idx + 8 <= length; idx += 8)
+			{
+				uint64_t chunk;
+				memcpy(&chunk, data + idx, sizeof(chunk));
+				mask |= GatherHighBits(word_predicate(chunk)) << idx;
+			}
+		}
+
+		for ( ; idx < length; ++idx)
+			mask |= static_cast<uint64_t>(predicate(data[idx])) << idx;
+		return mask;
+	}
+
+	// Builds a bitmask of the positions of a separator within the block at the specified offset. If
+	// the data ends within the block then the positions past the end are treated as separators.
+	uint64_t SeparatorMask(const std::string_view& str, size_t offset, char separator)
+	{
+		const auto remaining = str.length() - offset;
+		if (remaining >= SCAN_BLOCK_SIZE)
+			return SeparatorMask(str.data() + offset, separator);
+
+		return (~uint64_t(0) << remaining) | ScalarMask(str.data() + offset, remaining,
+			[separator](char chr) { return chr == separator; },
+			[separator](uint64_t word) { return MatchBytes(word, separator); });
+	}
+
+	// Determines whether a line which is split into two parts is within the length limits. The line
+	// may still be incomplete in which case it must not exceed the limits so far.
+	bool IsWithinLimits(std::string_view head, std::string_view tail)
+	{
+		// The carriage return of a line terminator is not part of the line.
+		if (!tail.empty())
+		{
+			if (tail.back() == '\r')
+				tail.remove_suffix(1);
+		}
+		else if (!head.empty() && head.back() == '\r')
+			head.remove_suffix(1);
+
+		// Most lines are short enough that we don't need to look for the tags section.
+		const auto length = head.length() + tail.length();
+		if (length <= Oulu::LineFramer::MAX_LINE_LENGTH - 2)
+			return true;
+
+		const auto first = head.empty() ? tail.front() : head.front();
+		if (first != '@')
+			return false;
+
+		size_t tags_length;
+		if (const auto head_space = head.find(' '); head_space != std::string_view::npos)
+			tags_length = head_space + 1;
+		else if (const auto tail_space = tail.find(' '); tail_space != std::string_view::npos)
+			tags_length = head.length() + tail_space + 1;
+		else
+			return length <= Oulu::LineFramer::MAX_TAGS_LENGTH;
+
+		return tags_length <= Oulu::LineFramer::MAX_TAGS_LENGTH
+			&& length - tags_length <= Oulu::LineFramer::MAX_LINE_LENGTH - 2;
+	}
 
-	for (const auto chr : str)
+#ifdef OULU_ARCH_X86
+	OULU_ATTR_TARGET("sse4.1")
+	uint64_t ControlMaskSSE41(const char* data)
+	{
+		const auto last_control = _mm_set1_epi8(0x1F);
+		const auto del = _mm_set1_epi8(0x7F);
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto controls = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(input, last_control), input), _mm_cmpeq_epi8(input, del));
+			mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(controls))) << idx;
+		}
+		return mask;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	uint64_t ControlMaskAVX2(const char* data)
+	{
+		const auto last_control = _mm256_set1_epi8(0x1F);
+		const auto del = _mm256_set1_epi8(0x7F);
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; idx += 32)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto controls = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(input, last_control), input), _mm256_cmpeq_epi8(input, del));
+			mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(controls))) << idx;
+		}
+		return mask;
+	}
+#endif
+
+	// Determines whether a character is a control character.
+	constexpr bool IsControl(char chr)
+	{
+		return static_cast<uint8_t>(chr) < 0x20 || chr == 0x7F;
+	}
+
+	// Builds a bitmask of the positions of control characters within the block at the specified
+	// offset. If the data ends within the block then the positions past the end are not set.
+	uint64_t ControlMask(const std::string_view& str, size_t offset)
+	{
+		const auto remaining = str.length() - offset;
+		if (remaining >= SCAN_BLOCK_SIZE)
+		{
+			switch (Oulu::SIMD::GetLevel())
+			{
+#ifdef OULU_ARCH_X86
+				case Oulu::SIMD::Level::AVX2:
+					return ControlMaskAVX2(str.data() + offset);
+				case Oulu::SIMD::Level::SSE41:
+					return ControlMaskSSE41(str.data() + offset);
+#endif
+				default:
+					break;
+			}
+		}
+
+		return ScalarMask(str.data() + offset, std::min(remaining, SCAN_BLOCK_SIZE), IsControl, [](uint64_t word) {
+			// Adding to the low seven bits of each byte can't carry into the next one.
+			const auto ones = uint64_t(0x0101010101010101);
+			const auto high_bits = ones * 0x80;
+			const auto low = word & ~high_bits;
+			const auto below_space = ~(low + ones * 0x60) & ~word & high_bits;
+			const auto del = (low + ones) & ~word & high_bits;
+			return below_space | del;
+		});
+	}
+
+	// The formatting codes which are used by IRC clients.
+	constexpr uint32_t FORMATTING_CODES = (1 << 0x02) // Bold
+		| (1 << 0x03) // Colour
+		| (1 << 0x04) // Hex colour
+		| (1 << 0x0F) // Reset
+		| (1 << 0x11) // Monospace
+		| (1 << 0x16) // Reverse
+		| (1 << 0x1D) // Italic
+		| (1 << 0x1E) // Strikethrough
+		| (1 << 0x1F); // Underline
+
+	// Determines whether a control character is a formatting code.
+	constexpr bool IsFormatting(char chr)
+	{
+		return static_cast<uint8_t>(chr) < 0x20 && (FORMATTING_CODES >> chr) & 1;
+	}
+
+	// Determines the length of the formatting code at the start of a string including any colours
+	// which follow it.
+	size_t GetFormattingLength(const std::string_view& str)
+	{
+		// Consumes up to the specified number of characters which match a predicate.
+		const auto consume = [&str](size_t start, size_t max, auto predicate) {
+			auto end = start;
+			while (end < str.length() && end - start < max && predicate(str[end]))
+				end++;
+			return end;
+		};
+		const auto is_digit = [](char chr) { return chr >= '0' && chr <= '9'; };
+		const auto is_hex = [](char chr) { return (chr >= '0' && chr <= '9') || ((chr | 0x20) >= 'a' && (chr | 0x20) <= 'f'); };
+
+		if (str[0] == '\x03')
+		{
+			// The colour code is followed by a foreground and an optional background of up to two
+			// digits each. If there is no foreground then the comma is part of the text.
+			const auto foreground = consume(1, 2, is_digit);
+			if (foreground == 1 || foreground >= str.length() || str[foreground] != ',')
+				return foreground;
+
+			const auto background = consume(foreground + 1, 2, is_digit);
+			return background == foreground + 1 ? foreground : background;
+		}
+
+		if (str[0] == '\x04')
+		{
+			// The hex colour code is followed by a foreground and an optional background of exactly
+			// six digits each.
+			const auto foreground = consume(1, 6, is_hex);
+			if (foreground != 7)
+				return 1;
+
+			if (foreground >= str.length() || str[foreground] != ',')
+				return foreground;
+
+			const auto background = consume(foreground + 1, 6, is_hex);
+			return background == foreground + 7 ? background : foreground;
+		}
+
+		return 1;
+	}
+
+#ifdef OULU_ARCH_X86
+	OULU_ATTR_TARGET("sse4.1")
+	uint64_t EscapeMaskSSE41(const char* data)
+	{
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; idx += 16)
+		{
+			const auto input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			auto escapes = _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(input, _mm_set1_epi8(';')));
+			escapes = _mm_or_si128(escapes, _mm_cmpeq_epi8(input, _mm_set1_epi8('\\')));
+			escapes = _mm_or_si128(escapes, _mm_cmpeq_epi8(input, _mm_set1_epi8('\n')));
+			escapes = _mm_or_si128(escapes, _mm_cmpeq_epi8(input, _mm_set1_epi8('\r')));
+			mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(escapes))) << idx;
+		}
+		return mask;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	uint64_t EscapeMaskAVX2(const char* data)
+	{
+		uint64_t mask = 0;
+		for (size_t idx = 0; idx < SCAN_BLOCK_SIZE; idx += 32)
+		{
+			const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			auto escapes = _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(input, _mm256_set1_epi8(';')));
+			escapes = _mm256_or_si256(escapes, _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\\')));
+			escapes = _mm256_or_si256(escapes, _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\n')));
+			escapes = _mm256_or_si256(escapes, _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\r')));
+			mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(escapes))) << idx;
+		}
+		return mask;
+	}
+#endif
+
+	// Determines whether a character must be escaped in the IRCv3 tag format.
+	constexpr bool IsTagEscape(char chr)
+	{
+		return chr == ' ' || chr == ';' || chr == '\\' || chr == '\n' || chr == '\r';
+	}
+
+	// Builds a bitmask of the positions of characters which must be escaped in the IRCv3 tag format
+	// within the block at the specified offset. If the data ends within the block then the positions
+	// past the end are not set.
+	uint64_t EscapeMask(const std::string_view& str, size_t offset)
+	{
+		const auto remaining = str.length() - offset;
+		if (remaining >= SCAN_BLOCK_SIZE)
+		{
+			switch (Oulu::SIMD::GetLevel())
+			{
+#ifdef OULU_ARCH_X86
+				case Oulu::SIMD::Level::AVX2:
+					return EscapeMaskAVX2(str.data() + offset);
+				case Oulu::SIMD::Level::SSE41:
+					return EscapeMaskSSE41(str.data() + offset);
+#endif
+				default:
+					break;
+			}
+		}
+
+		return ScalarMask(str.data() + offset, std::min(remaining, SCAN_BLOCK_SIZE), IsTagEscape, [](uint64_t word) {
+			return MatchBytes(word, ' ') | MatchBytes(word, ';') | MatchBytes(word, '\\') | MatchBytes(word, '\n') | MatchBytes(word, '\r');
+		});
+	}
+
+	// Builds a bitmask of the positions of backslashes within the block at the specified offset. If
+	// the data ends within the block then the positions past the end are not set.
+	uint64_t BackslashMask(const std::string_view& str, size_t offset)
+	{
+		const auto remaining = str.length() - offset;
+		const auto mask = SeparatorMask(str, offset, '\\');
+		return remaining >= SCAN_BLOCK_SIZE ? mask : mask & ~(~uint64_t(0) << remaining);
+	}
+
+	// Finds the first character at or after the specified offset which has a bit set by a mask
+	// function or std::string_view::npos if there is none.
+	template <typename MaskFunction>
+	size_t FindFirst(const std::string_view& str, size_t offset, MaskFunction mask_function)
+	{
+		for ( ; offset < str.length(); offset += SCAN_BLOCK_SIZE)
+		{
+			if (const auto mask = mask_function(str, offset))
+				return offset + std::countr_zero(mask);
+		}
+		return std::string_view::npos;
+	}
+
+	// Retrieves the character which follows a backslash when escaping a character.
+	constexpr char GetTagEscape(char chr)
 	{
 		switch (chr)
 		{
 			case ' ':
-				ret.append("\\s");
-				break;
+				return 's';
 			case ';':
-				ret.append("\\:");
-				break;
-			case '\\':
-				ret.append("\\\\");
-				break;
+				return ':';
 			case '\n':
-				ret.append("\\n");
-				break;
+				return 'n';
 			case '\r':
-				ret.append("\\r");
-				break;
+				return 'r';
 			default:
-				ret.push_back(chr);
-				break;
+				return chr;
 		}
 	}
+
+	// Retrieves the character which an escape sequence is unescaped to.
+	constexpr char GetTagUnescape(char chr)
+	{
+		switch (chr)
+		{
+			case 's':
+				return ' ';
+			case ':':
+				return ';';
+			case 'n':
+				return '\n';
+			case 'r':
+				return '\r';
+			default:
+				return chr;
+		}
+	}
+
+	// Escapes a string to the IRCv3 tag format and appends the escaped form to another string. The
+	// characters before the specified offset must not need escaping.
+	template <typename String>
+	void EscapeTagAppend(String& out, const std::string_view& str, size_t offset = 0)
+	{
+		// Copy the runs of characters between the ones which need escaping in one go.
+		size_t run = 0;
+		for ( ; offset < str.length(); offset += SCAN_BLOCK_SIZE)
+		{
+			for (auto escapes = EscapeMask(str, offset); escapes; escapes &= escapes - 1)
+			{
+				const auto position = offset + std::countr_zero(escapes);
+				out.append(str.data() + run, position - run);
+				out.push_back('\\');
+				out.push_back(GetTagEscape(str[position]));
+				run = position + 1;
+			}
+		}
+		out.append(str.data() + run, str.length() - run);
+	}
+
+	// Unescapes a string from the IRCv3 tag format and appends the unescaped form to another string.
+	// The characters before the specified offset must not be escaped.
+	template <typename String>
+	void UnescapeTagAppend(String& out, const std::string_view& str, size_t offset = 0)
+	{
+		// Copy the runs of characters between the escape sequences in one go.
+		size_t run = 0;
+		for ( ; offset < str.length(); offset += SCAN_BLOCK_SIZE)
+		{
+			for (auto escapes = BackslashMask(str, offset); escapes; escapes &= escapes - 1)
+			{
+				const auto position = offset + std::countr_zero(escapes);
+				if (position < run)
+					continue; // This is an escaped backslash.
+
+				out.append(str.data() + run, position - run);
+				if (position + 1 < str.length())
+					out.push_back(GetTagUnescape(str[position + 1]));
+				run = std::min(position + 2, str.length());
+			}
+		}
+		out.append(str.data() + run, str.length() - run);
+	}
+
+	// Escapes a string to the IRCv3 tag format into a buffer if anything needs escaping.
+	template <typename String>
+	std::string_view EscapeTagBuffer(const std::string_view& str, String& buffer)
+	{
+		OULU_STATS_CALL(ESCAPE_TAG, str.length());
+		const auto first = FindFirst(str, 0, EscapeMask);
+		if (first == std::string_view::npos)
+			return str; // Nothing needs escaping.
+
+		OULU_STATS_SLOW_PATH(ESCAPE_TAG);
+		buffer.clear();
+		buffer.reserve(str.size() + 16);
+		EscapeTagAppend(buffer, str, first);
+		return buffer;
+	}
+
+	// Strips formatting codes from a string into a new string.
+	template <typename String>
+	String StripFormattingCopy(const std::string_view& str, const typename String::allocator_type& allocator)
+	{
+		String out(str, allocator);
+		out.resize(Oulu::StripFormattingInPlace(out).length());
+		return out;
+	}
+
+	// Unescapes a string from the IRCv3 tag format into a buffer if anything needs unescaping.
+	template <typename String>
+	std::string_view UnescapeTagBuffer(const std::string_view& str, String& buffer)
+	{
+		OULU_STATS_CALL(UNESCAPE_TAG, str.length());
+		const auto first = FindFirst(str, 0, BackslashMask);
+		if (first == std::string_view::npos)
+			return str; // Nothing needs unescaping.
+
+		OULU_STATS_SLOW_PATH(UNESCAPE_TAG);
+		buffer.clear();
+		buffer.reserve(str.size());
+		UnescapeTagAppend(buffer, str, first);
+		return buffer;
+	}
+}
+
+void Oulu::EscapeTagTo(std::string& out, const std::string_view& str)
+{
+	OULU_STATS_CALL(ESCAPE_TAG, str.length());
+	out.reserve(out.size() + str.size());
+	EscapeTagAppend(out, str);
+}
+
+void Oulu::EscapeTagTo(std::pmr::string& out, const std::string_view& str)
+{
+	OULU_STATS_CALL(ESCAPE_TAG, str.length());
+	out.reserve(out.size() + str.size());
+	EscapeTagAppend(out, str);
+}
+
+std::string_view Oulu::EscapeTag(const std::string_view& str, std::string& buffer)
+{
+	return EscapeTagBuffer(str, buffer);
+}
+
+std::pmr::string Oulu::EscapeTag(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator)
+{
+	std::pmr::string ret(allocator);
+	EscapeTagTo(ret, str);
 	return ret;
 }
 
-bool Oulu::IsCTCP(const std::string_view& str)
+std::string_view Oulu::EscapeTag(const std::string_view& str, std::pmr::string& buffer)
 {
-	// According to draft-oakley-irc-ctcp-02 a valid CTCP must begin with SOH and
-	// contain at least one octet which is not NUL, SOH, CR, LF, or SPACE. As most
-	// of these are restricted at the protocol level we only need to check for SOH
-	// and SPACE.
-	return (str.length() >= 2) && (str[0] == '\x1') && (str[1] != '\x1') && (str[1] != ' ');
+	return EscapeTagBuffer(str, buffer);
 }
 
-bool Oulu::ParseCTCP(const std::string_view& str, std::string_view& name)
+Oulu::BodyClassification Oulu::ClassifyBody(const std::string_view& body)
 {
-	if (!IsCTCP(str))
+	OULU_STATS_CALL(CLASSIFY_BODY, body.length());
+	BodyClassification classification;
+	classification.ctcp = ParseCTCP(body, classification.ctcp_name, classification.ctcp_body);
+	classification.action = classification.ctcp && classification.ctcp_name == "ACTION";
+
+	// The delimiters of a CTCP are not control characters.
+	size_t start = 0;
+	auto str = body;
+	if (classification.ctcp)
 	{
-		name = {};
-		return false;
+		start = 1;
+		if (str.back() == '\x1')
+			str.remove_suffix(1);
 	}
 
-	auto end_of_name = str.find(' ', 2);
-	if (end_of_name == std::string_view::npos)
+	for (size_t offset = 0; offset < str.length(); offset += SCAN_BLOCK_SIZE)
 	{
-		// The CTCP only contains a name.
-		auto end_of_ctcp = str.back() == '\x1' ? 1 : 0;
-		name = str.substr(1, str.length() - end_of_ctcp - 1);
-		return true;
+		auto controls = ControlMask(str, offset);
+		if (!offset)
+			controls &= ~uint64_t(0) << start;
+
+		for ( ; controls; controls &= controls - 1)
+		{
+			if (IsFormatting(str[offset + std::countr_zero(controls)]))
+				classification.formatting = true;
+			else
+				classification.control = true;
+		}
+
+		// Once we've seen both kinds there is nothing left to find.
+		if (classification.formatting && classification.control)
+			break;
 	}
+	return classification;
+}
 
-	// The CTCP contains a name and a body.
-	name = str.substr(1, end_of_name - 1);
-	return true;
+std::string Oulu::StripFormatting(const std::string_view& str)
+{
+	return StripFormattingCopy<std::string>(str, {});
 }
 
-bool Oulu::ParseCTCP(const std::string_view& str, std::string_view& name, std::string_view& body)
+std::pmr::string Oulu::StripFormatting(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator)
 {
-	if (!IsCTCP(str))
+	return StripFormattingCopy<std::pmr::string>(str, allocator);
+}
+
+std::string_view Oulu::StripFormattingInPlace(std::span<char> str)
+{
+	OULU_STATS_CALL(STRIP_FORMATTING, str.size());
+	const std::string_view input(str.data(), str.size());
+	size_t read = 0;
+	size_t write = 0;
+	for (size_t offset = 0; offset < input.length(); offset += SCAN_BLOCK_SIZE)
 	{
-		name = body = {};
-		return false;
+		for (auto controls = ControlMask(input, offset); controls; controls &= controls - 1)
+		{
+			const auto position = offset + std::countr_zero(controls);
+			if (position < read || !IsFormatting(input[position]))
+				continue; // Either a colour digit we already skipped or a non-formatting character.
+
+			// Move the text before the formatting code back over any which we have removed.
+			if (write != read)
+				memmove(str.data() + write, str.data() + read, position - read);
+			write += position - read;
+			read = position + GetFormattingLength(input.substr(position));
+		}
 	}
 
-	auto end_of_name = str.find(' ', 2);
-	auto end_of_ctcp = str.back() == '\x1' ? 1 : 0;
-	if (end_of_name == std::string_view::npos)
+	if (write != read)
 	{
-		// The CTCP only contains a name.
-		name = str.substr(1, str.length() - end_of_ctcp - 1);
-		body = {};
-		return true;
+		OULU_STATS_SLOW_PATH(STRIP_FORMATTING);
+		memmove(str.data() + write, str.data() + read, input.length() - read);
 	}
+	write += input.length() - read;
+	return { str.data(), write };
+}
+
+void Oulu::UnescapeTagTo(std::string& out, const std::string_view& str)
+{
+	OULU_STATS_CALL(UNESCAPE_TAG, str.length());
+	out.reserve(out.size() + str.size());
+	UnescapeTagAppend(out, str);
+}
 
-	// The CTCP contains a name and a body.
-	name = str.substr(1, end_of_name - 1);
+void Oulu::UnescapeTagTo(std::pmr::string& out, const std::string_view& str)
+{
+	OULU_STATS_CALL(UNESCAPE_TAG, str.length());
+	out.reserve(out.size() + str.size());
+	UnescapeTagAppend(out, str);
+}
+
+std::string_view Oulu::UnescapeTag(const std::string_view& str, std::string& buffer)
+{
+	return UnescapeTagBuffer(str, buffer);
+}
+
+std::pmr::string Oulu::UnescapeTag(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator)
+{
+	std::pmr::string ret(allocator);
+	UnescapeTagTo(ret, str);
+	return ret;
+}
+
+std::string_view Oulu::UnescapeTag(const std::string_view& str, std::pmr::string& buffer)
+{
+	return UnescapeTagBuffer(str, buffer);
+}
 
-	auto start_of_body = str.find_first_not_of(' ', end_of_name + 1);
-	if (start_of_body == std::string_view::npos)
+std::string_view Oulu::UnescapeTagInPlace(std::span<char> str)
+{
+	OULU_STATS_CALL(UNESCAPE_TAG, str.size());
+	const std::string_view input(str.data(), str.size());
+	const auto first = FindFirst(input, 0, BackslashMask);
+	if (first == std::string_view::npos)
+		return input; // Nothing needs unescaping.
+
+	OULU_STATS_SLOW_PATH(UNESCAPE_TAG);
+
+	// Unescaping never writes past the character it is reading so this is safe.
+	size_t run = first;
+	size_t write = first;
+	for (auto offset = first; offset < input.length(); offset += SCAN_BLOCK_SIZE)
 	{
-		// The CTCP body is provided but empty.
-		body = {};
-		return true;
+		for (auto escapes = BackslashMask(input, offset); escapes; escapes &= escapes - 1)
+		{
+			const auto position = offset + std::countr_zero(escapes);
+			if (position < run)
+				continue; // This is an escaped backslash.
+
+			memmove(str.data() + write, str.data() + run, position - run);
+			write += position - run;
+			if (position + 1 < input.length())
+				str[write++] = GetTagUnescape(input[position + 1]);
+			run = std::min(position + 2, input.length());
+		}
 	}
 
-	// The CTCP body provided was non-empty.
-	body = str.substr(start_of_body, str.length() - start_of_body - end_of_ctcp);
-	return true;
+	memmove(str.data() + write, str.data() + run, input.length() - run);
+	write += input.length() - run;
+	return { str.data(), write };
 }
 
-std::string Oulu::UnescapeTag(const std::string_view& str)
+Oulu::ListTokenizer::ListTokenizer(const std::string_view& l, char s, bool ae)
+	: allow_empty(ae)
+	, list(l)
+	, position(l.empty() ? 1 : 0)
+	, separator(s)
 {
-	std::string ret;
-	ret.reserve(str.size());
+}
 
-	for (auto it = str.cbegin(); it != str.cend(); ++it)
+size_t Oulu::ListTokenizer::FindSeparator(size_t offset)
+{
+	while (true)
 	{
-		auto chr = *it;
-		if (chr != '\\')
+		// Build the mask for a new block if the offset is not within the cached one.
+		if (offset < block_offset || offset - block_offset >= SCAN_BLOCK_SIZE)
 		{
-			ret.push_back(chr);
-			continue;
+			block_offset = offset;
+			block_mask = SeparatorMask(list, offset, separator);
 		}
 
-		it++;
-		if (it == str.cend())
-			break;
+		// The positions past the end of the list are treated as separators so this always ends.
+		const auto separators = block_mask >> (offset - block_offset);
+		if (separators)
+			return std::min(offset + std::countr_zero(separators), list.length());
 
-		chr = *it;
-		switch (chr)
+		offset = block_offset + SCAN_BLOCK_SIZE;
+	}
+}
+
+size_t Oulu::ListTokenizer::GetCount() const
+{
+	if (position > list.length())
+		return 0;
+
+	// Empty elements are delimited by every separator so we only need to count them. Otherwise, an
+	// element starts at every non-separator which follows a separator like in TokenizeAll.
+	size_t count = allow_empty ? 1 : 0;
+	uint64_t previous = 1;
+	for (size_t offset = position; offset < list.length(); offset += SCAN_BLOCK_SIZE)
+	{
+		const auto separators = SeparatorMask(list, offset, separator);
+		if (allow_empty)
 		{
-			case 's':
-				ret.push_back(' ');
-				break;
-			case ':':
-				ret.push_back(';');
-				break;
-			case '\\':
-				ret.push_back('\\');
-				break;
-			case 'n':
-				ret.push_back('\n');
-				break;
-			case 'r':
-				ret.push_back('\r');
-				break;
-			default:
-				ret.push_back(chr);
-				break;
+			const auto remaining = list.length() - offset;
+			const auto valid = remaining < SCAN_BLOCK_SIZE ? (uint64_t(1) << remaining) - 1 : ~uint64_t(0);
+			count += std::popcount(separators & valid);
+		}
+		else
+		{
+			count += std::popcount(~separators & ((separators << 1) | previous));
+			previous = separators >> (SCAN_BLOCK_SIZE - 1);
 		}
 	}
-	return ret;
+	return count;
 }
 
-Oulu::MessageTokenizer::MessageTokenizer(const std::string_view& m)
-	: message(m)
+bool Oulu::ListTokenizer::GetNext(std::string_view& element)
 {
+	while (position <= list.length())
+	{
+		const auto end = FindSeparator(position);
+		element = list.substr(position, end - position);
+		position = end + 1;
+		if (allow_empty || !element.empty())
+			return true;
+	}
+
+	element = {};
+	return false;
 }
 
-bool Oulu::MessageTokenizer::GetMiddle(std::string_view& token)
+Oulu::MessageArena::MessageArena(size_t size, std::pmr::memory_resource* upstream)
+	: buffer(std::make_unique_for_overwrite<std::byte[]>(size))
+	, resource(buffer.get(), size, upstream)
 {
-	// If we are past the end of the string we can't do anything.
-	if (this->message.empty())
+}
+
+Oulu::LineFramer::LineFramer()
+{
+	buffer.reserve(MAX_LINE_LENGTH + MAX_TAGS_LENGTH);
+}
+
+bool Oulu::LineFramer::Append(const std::string_view& data)
+{
+	OULU_STATS_CALL(LINE_FRAMER_APPEND, data.length());
+
+	// Check every line in the data against the limits before we copy any of it.
+	const auto old_lines = lines.size();
+	std::string_view head(buffer.data() + partial, buffer.length() - partial);
+	size_t start = 0;
+	for (size_t offset = 0; offset < data.length(); offset += SCAN_BLOCK_SIZE)
+	{
+		auto newlines = SeparatorMask(data, offset, '\n');
+		if (const auto remaining = data.length() - offset; remaining < SCAN_BLOCK_SIZE)
+			newlines &= (uint64_t(1) << remaining) - 1;
+
+		for ( ; newlines; newlines &= newlines - 1)
+		{
+			const auto end = offset + std::countr_zero(newlines);
+			if (!IsWithinLimits(head, data.substr(start, end - start)))
+			{
+				OULU_STATS_FAILURE(LINE_FRAMER_APPEND);
+				lines.resize(old_lines);
+				return false;
+			}
+
+			lines.push_back(head.length() + end - start + 1);
+			head = {};
+			start = end + 1;
+		}
+	}
+
+	if (!IsWithinLimits(head, data.substr(start)))
 	{
-		token = {};
+		OULU_STATS_FAILURE(LINE_FRAMER_APPEND);
+		lines.resize(old_lines);
 		return false;
 	}
 
-	// If we can't find another separator this is the last token in the message.
-	auto separator = this->message.find(' ');
-	if (separator == std::string_view::npos)
+	if (read == buffer.length())
+	{
+		// Everything has been read so we can just start again.
+		buffer.clear();
+		partial = read = 0;
+	}
+	else if (read && buffer.length() + data.length() > buffer.capacity())
 	{
-		token = this->message;
-		this->message = {};
-		return true;
+		// Discard the lines which have been read so that we don't need to reallocate.
+		const auto unread = buffer.length() - read;
+		memmove(buffer.data(), buffer.data() + read, unread);
+		buffer.resize(unread);
+		partial -= read;
+		read = 0;
 	}
 
-	token = this->message.substr(0, separator);
+	buffer.append(data);
+	if (start)
+		partial = buffer.length() - data.length() + start;
+	return true;
+}
+
+void Oulu::LineFramer::Clear()
+{
+	buffer.clear();
+	lines.clear();
+	next_line = partial = read = 0;
+}
 
-	separator = this->message.find_first_not_of(' ', separator);
-	if (separator != std::string_view::npos)
-		this->message.remove_prefix(separator);
+bool Oulu::LineFramer::GetLine(std::string_view& line)
+{
+	while (next_line < lines.size())
+	{
+		const auto length = lines[next_line++];
+		line = std::string_view(buffer).substr(read, length - 1);
+		read += length;
 
-	return true;
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+
+		if (!line.empty())
+			return true;
+	}
+
+	lines.clear();
+	next_line = 0;
+	line = {};
+	return false;
+}
+
+void Oulu::MessageBatch::Clear()
+{
+	command_names.clear();
+	commands.clear();
+	lines.clear();
+	param_index.resize(1);
+	params.clear();
+	sources.clear();
+	tags.clear();
+}
+
+size_t Oulu::MessageBatch::Parse(std::span<const std::string_view> messages)
+{
+	OULU_STATS_CALL(MESSAGE_BATCH_PARSE, messages.size());
+	const auto old_size = lines.size();
+	command_names.reserve(old_size + messages.size());
+	commands.reserve(old_size + messages.size());
+	lines.reserve(old_size + messages.size());
+	param_index.reserve(old_size + messages.size() + 1);
+	sources.reserve(old_size + messages.size());
+	tags.reserve(old_size + messages.size());
+
+	ParsedMessage message;
+	for (const auto& line : messages)
+	{
+		if (!message.Parse(line))
+			continue;
+
+		const auto command = IdentifyCommand(message.GetCommand());
+		command_names.push_back(command.name);
+		commands.push_back(command.id);
+		lines.push_back(line);
+		sources.push_back(message.GetSource());
+		tags.push_back(message.GetTags());
+
+		for (const auto& param : message.GetParams())
+		{
+			const auto offset = static_cast<uint32_t>(param.data() - line.data());
+			params.push_back({ offset, static_cast<uint32_t>(param.length()) });
+		}
+		param_index.push_back(static_cast<uint32_t>(params.size()));
+	}
+	return lines.size() - old_size;
+}
+
+Oulu::MessageBuilder& Oulu::MessageBuilder::AddTag(const std::string_view& key, const std::string_view& value)
+{
+	all_tags = nullptr;
+
+	const auto offset = tag_buffer.length();
+	tag_buffer.append(key);
+	if (!value.empty())
+	{
+		// Escape the value straight into the tag buffer.
+		tag_buffer.push_back('=');
+		EscapeTagAppend(tag_buffer, value);
+	}
+
+	tags.push_back({ offset, key.length(), tag_buffer.length() - offset });
+	return *this;
+}
+
+Oulu::MessageBuilder::Line Oulu::MessageBuilder::Build()
+{
+	// If there are no tags then we can share the tagless form.
+	if (tags.empty())
+		return BuildWithoutTags();
+
+	OULU_STATS_CALL(MESSAGE_BUILDER_BUILD, 0);
+	if (!all_tags)
+	{
+		OULU_STATS_SLOW_PATH(MESSAGE_BUILDER_BUILD);
+		all_tags = Serialize([](const std::string_view&) { return true; });
+	}
+	return all_tags;
+}
+
+Oulu::MessageBuilder::Line Oulu::MessageBuilder::BuildWithoutTags()
+{
+	OULU_STATS_CALL(MESSAGE_BUILDER_BUILD, 0);
+	if (!no_tags)
+	{
+		OULU_STATS_SLOW_PATH(MESSAGE_BUILDER_BUILD);
+		no_tags = Serialize([](const std::string_view&) { return false; });
+	}
+	return no_tags;
 }
 
-bool Oulu::MessageTokenizer::GetTrailing(std::string_view& token)
+void Oulu::MessageBuilder::Clear()
 {
-	// If we are past the end of the string we can't do anything.
-	if (this->message.empty())
+	all_tags = no_tags = nullptr;
+	command.clear();
+	params.clear();
+	source.clear();
+	tag_buffer.clear();
+	tags.clear();
+	trailing = false;
+}
+
+Oulu::MessageBuilder& Oulu::MessageBuilder::PushParam(const std::string_view& param)
+{
+	if (trailing)
+		return *this;
+
+	all_tags = no_tags = nullptr;
+	params.push_back(' ');
+	if (param.empty() || param.front() == ':' || param.find(' ') != std::string_view::npos)
+	{
+		// This parameter can only be sent as a <trailing> token.
+		params.push_back(':');
+		trailing = true;
+	}
+	params.append(param);
+	return *this;
+}
+
+Oulu::MessageBuilder& Oulu::MessageBuilder::SetCommand(const std::string_view& cmd)
+{
+	all_tags = no_tags = nullptr;
+	command = cmd;
+	return *this;
+}
+
+Oulu::MessageBuilder& Oulu::MessageBuilder::SetSource(const std::string_view& src)
+{
+	all_tags = no_tags = nullptr;
+	source = src;
+	return *this;
+}
+
+size_t Oulu::MessageTokenizer::TokenizeBlocks(std::span<std::string_view> tokens)
+{
+	OULU_STATS_CALL(MESSAGE_TOKENIZER_TOKENIZE_ALL, this->message.length());
+	if (tokens.empty() || this->message.empty())
+		return 0;
+
+	// A leading separator results in an empty token like with GetMiddle.
+	size_t count = 0;
+	if (this->message.front() == ' ')
+	{
+		tokens[count++] = this->message.substr(0, 0);
+		if (count >= tokens.size())
+		{
+			// We are out of space so leave the rest of the tokens for later.
+			const auto next = this->message.find_first_not_of(' ');
+			this->message.remove_prefix(next == std::string_view::npos ? this->message.length() : next);
+			return count;
+		}
+	}
+
+	// Tokens start at a non-separator which follows a separator and end at a separator which follows
+	// a non-separator. We can find both of these for a whole block at once using the bitmask of
+	// the separator positions in it and the one before it. If the message fills its last block
+	// then we scan an empty block after it so the last token is ended by the padding.
+	size_t start = 0;
+	uint64_t previous = 1;
+	for (size_t offset = 0; offset <= this->message.length(); offset += SCAN_BLOCK_SIZE)
+	{
+		const auto separators = SeparatorMask(this->message, offset, ' ');
+		const auto shifted = (separators << 1) | previous;
+		auto starts = ~separators & shifted;
+		auto ends = separators & ~shifted;
+
+		// If the previous block ended with a non-separator then a token is already in progress and
+		// it ends before the next one starts.
+		auto in_token = !previous;
+		previous = separators >> (SCAN_BLOCK_SIZE - 1);
+		for (; starts || ends; in_token = !in_token)
+		{
+			if (in_token)
+			{
+				if (!ends)
+					break; // The token continues into the next block.
+
+				const auto end = offset + std::countr_zero(ends);
+				ends &= ends - 1;
+
+				tokens[count++] = this->message.substr(start, end - start);
+				if (count >= tokens.size())
+				{
+					// We are out of space so leave the rest of the tokens for later.
+					const auto next = this->message.find_first_not_of(' ', end);
+					this->message.remove_prefix(next == std::string_view::npos ? this->message.length() : next);
+					return count;
+				}
+				continue;
+			}
+
+			start = offset + std::countr_zero(starts);
+			starts &= starts - 1;
+
+			// If this is true then we have a <trailing> token!
+			if (this->message[start] == ':')
+			{
+				tokens[count++] = this->message.substr(start + 1);
+				this->message = {};
+				return count;
+			}
+		}
+	}
+
+	this->message = {};
+	return count;
+}
+
+bool Oulu::ParsedMessage::Parse(const std::string_view& line)
+{
+	OULU_STATS_CALL(PARSED_MESSAGE_PARSE, line.length());
+	command = host = nick = source = tags = user = {};
+	param_count = 0;
+
+	MessageTokenizer tokenizer(line);
+	std::string_view token;
+	if (!tokenizer.GetMiddle(token))
+	{
+		OULU_STATS_FAILURE(PARSED_MESSAGE_PARSE);
+		return false;
+	}
+
+	if (token.starts_with('@'))
+	{
+		// The message has tags.
+		tags = token.substr(1);
+		if (!tokenizer.GetMiddle(token))
+		{
+			OULU_STATS_FAILURE(PARSED_MESSAGE_PARSE);
+			return false;
+		}
+	}
+
+	if (token.starts_with(':'))
+	{
+		// The message has a source in the format nick[!user][@host].
+		source = token.substr(1);
+		nick = source.substr(0, source.find_first_of("!@"));
+
+		const auto at = source.find('@', nick.length());
+		if (at != std::string_view::npos)
+			host = source.substr(at + 1);
+
+		if (nick.length() < source.length() && source[nick.length()] == '!')
+			user = source.substr(nick.length() + 1, at == std::string_view::npos ? at : at - nick.length() - 1);
+
+		if (!tokenizer.GetMiddle(token))
+		{
+			OULU_STATS_FAILURE(PARSED_MESSAGE_PARSE);
+			return false;
+		}
+	}
+
+	if (token.empty())
 	{
-		token = {};
+		OULU_STATS_FAILURE(PARSED_MESSAGE_PARSE);
 		return false;
 	}
+	command = token;
+
+	// Building the separator masks for TokenizeAll costs more than it saves at the length of IRC
+	// lines so we read the parameters one at a time.
+	while (tokenizer.GetTrailing(token))
+	{
+		if (param_count < MAX_PARAMS)
+		{
+			params[param_count++] = token;
+			continue;
+		}
+
+		// There are too many parameters so the last one covers the rest of the message.
+		auto& last = params[MAX_PARAMS - 1];
+		last = line.substr(last.data() - line.data());
+		break;
+	}
+	return true;
+}
+
+std::optional<std::string_view> Oulu::TagView::Tag::Unescape(std::span<char> buffer) const
+{
+	OULU_STATS_CALL(UNESCAPE_TAG, value.length());
+	if (!IsEscaped())
+		return value;
+
+	OULU_STATS_SLOW_PATH(UNESCAPE_TAG);
+	if (buffer.size() < value.size())
+	{
+		OULU_STATS_FAILURE(UNESCAPE_TAG);
+		return std::nullopt;
+	}
+
+	const auto* end = Oulu::UnescapeTagTo(buffer.data(), value);
+	return std::string_view(buffer.data(), end - buffer.data());
+}
 
-	// If this is true then we have a <trailing> token!
-	if (message.front() == ':')
+Oulu::TagView::Iterator& Oulu::TagView::Iterator::operator++()
+{
+	while (!remaining.empty())
 	{
-		token = message.substr(1);
-		this->message = {};
-		return true;
+		// Tags are separated by semicolons. Empty tags are not valid but we skip them to be lenient.
+		const auto separator = remaining.find(';');
+		const auto tag = remaining.substr(0, separator);
+		remaining.remove_prefix(separator == std::string_view::npos ? remaining.length() : separator + 1);
+		if (tag.empty())
+			continue;
+
+		// The value is optional and can be omitted along with the equals sign.
+		const auto equals = tag.find('=');
+		current.key = tag.substr(0, equals);
+		current.value = equals == std::string_view::npos ? std::string_view() : tag.substr(equals + 1);
+		return *this;
 	}
 
-	// There is no <trailing> token so it must be a <middle> token.
-	return this->GetMiddle(token);
+	current = {};
+	done = true;
+	return *this;
+}
+
+void Oulu::TagView::BuildIndex()
+{
+	indexed = true;
+
+	Iterator it(tags);
+	for ( ; it != end() && index_size < MAX_INDEXED_TAGS; ++it)
+		index[index_size++] = *it;
+
+	// If there are too many tags to index then remember where to start scanning from.
+	if (it != end())
+		unindexed = tags.substr(it->key.data() - tags.data());
+}
+
+const Oulu::TagView::Tag* Oulu::TagView::Find(const std::string_view& key)
+{
+	if (!indexed)
+		BuildIndex();
+
+	for (size_t idx = 0; idx < index_size; ++idx)
+	{
+		if (index[idx].key == key)
+			return &index[idx];
+	}
+
+	for (Iterator it(unindexed); it != end(); ++it)
+	{
+		if (it->key == key)
+		{
+			scanned = *it;
+			return &scanned;
+		}
+	}
+	return nullptr;
+}
+
+std::optional<std::string_view> Oulu::TagView::Get(const std::string_view& key)
+{
+	OULU_STATS_CALL(TAG_VIEW_GET, key.length());
+	const auto* tag = Find(key);
+	if (!tag)
+	{
+		OULU_STATS_FAILURE(TAG_VIEW_GET);
+		return std::nullopt;
+	}
+
+	if (tag->value.size() <= inline_buffer.size())
+		return tag->Unescape(inline_buffer);
+
+	// The value is too long for the inline buffer so we need to unescape onto the heap.
+	return UnescapeTag(tag->value, overflow_buffer);
 }
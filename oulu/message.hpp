@@ -3,29 +3,167 @@
 
 #pragma once
 
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <oulu/command.hpp>
+#include <oulu/stats.hpp>
 
 namespace Oulu
 {
+	class BodyClassification;
+	class LineFramer;
+	class ListTokenizer;
+	class MessageArena;
+	class MessageBatch;
+	class MessageBuilder;
 	class MessageTokenizer;
+	class ParsedMessage;
+	class TagView;
+
+	/** Classifies the body of a PRIVMSG or NOTICE message in a single pass.
+	 * \param body The body of the message.
+	 * \return The classification of the message body.
+	 */
+	BodyClassification ClassifyBody(const std::string_view& body);
+
+	/** Escapes a string to the IRCv3 tag format and writes the escaped form through an output iterator.
+	 * \param out The output iterator to write the escaped form to.
+	 * \param str The string to escape.
+	 * \return The output iterator after the last character written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator EscapeTagTo(OutputIterator out, const std::string_view& str)
+	{
+		for (const auto chr : str)
+		{
+			switch (chr)
+			{
+				case ' ':
+					*out++ = '\\';
+					*out++ = 's';
+					break;
+				case ';':
+					*out++ = '\\';
+					*out++ = ':';
+					break;
+				case '\\':
+					*out++ = '\\';
+					*out++ = '\\';
+					break;
+				case '\n':
+					*out++ = '\\';
+					*out++ = 'n';
+					break;
+				case '\r':
+					*out++ = '\\';
+					*out++ = 'r';
+					break;
+				default:
+					*out++ = chr;
+					break;
+			}
+		}
+		return out;
+	}
+
+	/** Escapes a string to the IRCv3 tag format and appends the escaped form to a string.
+	 * \param out The string to append the escaped form to.
+	 * \param str The string to escape.
+	 */
+	void EscapeTagTo(std::string& out, const std::string_view& str);
+
+	/** Escapes a string to the IRCv3 tag format and appends the escaped form to a string which uses a
+	 * polymorphic allocator.
+	 * \param out The string to append the escaped form to.
+	 * \param str The string to escape.
+	 */
+	void EscapeTagTo(std::pmr::string& out, const std::string_view& str);
 
 	/** Escapes a string to the IRCv3 tag format.
 	 * \param str The string to escape.
 	 */
-	std::string EscapeTag(const std::string_view& str);
+	constexpr std::string EscapeTag(const std::string_view& str)
+	{
+		std::string ret;
+		if (std::is_constant_evaluated())
+			EscapeTagTo(std::back_inserter(ret), str);
+		else
+			EscapeTagTo(ret, str);
+		return ret;
+	}
+
+	/** Escapes a string to the IRCv3 tag format without copying it if nothing needs escaping.
+	 * \param str The string to escape.
+	 * \param buffer The buffer to write the escaped form to if anything needs escaping.
+	 * \return Either the string itself or a view of the escaped form in the buffer.
+	 */
+	std::string_view EscapeTag(const std::string_view& str, std::string& buffer);
+
+	/** Escapes a string to the IRCv3 tag format into a string which uses a polymorphic allocator.
+	 * \param str The string to escape.
+	 * \param allocator The allocator to allocate the escaped form with.
+	 */
+	std::pmr::string EscapeTag(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator);
+
+	/** Escapes a string to the IRCv3 tag format without copying it if nothing needs escaping.
+	 * \param str The string to escape.
+	 * \param buffer The buffer to write the escaped form to if anything needs escaping.
+	 * \return Either the string itself or a view of the escaped form in the buffer.
+	 */
+	std::string_view EscapeTag(const std::string_view& str, std::pmr::string& buffer);
 
 	/** Determines whether the specified string contains a CTCP.
 	 * \param str The string to check for a CTCP.
 	 */
-	bool IsCTCP(const std::string_view& str);
+	constexpr bool IsCTCP(const std::string_view& str)
+	{
+		// According to draft-oakley-irc-ctcp-02 a valid CTCP must begin with SOH and
+		// contain at least one octet which is not NUL, SOH, CR, LF, or SPACE. As most
+		// of these are restricted at the protocol level we only need to check for SOH
+		// and SPACE.
+		return (str.length() >= 2) && (str[0] == '\x1') && (str[1] != '\x1') && (str[1] != ' ');
+	}
 
 	/** Parses a CTCP and extracts the name.
 	 * \param str A string containing a CTCP.
 	 * \param name The location to store the name of the CTCP.
 	 * \return True if the message contained a well formed CTCP; otherwise, false.
 	 */
-	bool ParseCTCP(const std::string_view& str, std::string_view& name);
+	constexpr bool ParseCTCP(const std::string_view& str, std::string_view& name)
+	{
+		OULU_STATS_COUNT(PARSE_CTCP, str.length());
+		if (!IsCTCP(str))
+		{
+			OULU_STATS_FAILURE(PARSE_CTCP);
+			name = {};
+			return false;
+		}
+
+		auto end_of_name = str.find(' ', 2);
+		if (end_of_name == std::string_view::npos)
+		{
+			// The CTCP only contains a name.
+			auto end_of_ctcp = str.back() == '\x1' ? 1 : 0;
+			name = str.substr(1, str.length() - end_of_ctcp - 1);
+			return true;
+		}
+
+		// The CTCP contains a name and a body.
+		name = str.substr(1, end_of_name - 1);
+		return true;
+	}
 
 	/** Parses a CTCP and extracts the name and body.
 	 * \param str A string containing a CTCP.
@@ -33,12 +171,548 @@ namespace Oulu
 	 * \param body The location to store the body of the CTCP.
 	 * \return True if the message contained a well formed CTCP; otherwise, false.
 	 */
-	bool ParseCTCP(const std::string_view& str, std::string_view& name, std::string_view& body);
+	constexpr bool ParseCTCP(const std::string_view& str, std::string_view& name, std::string_view& body)
+	{
+		OULU_STATS_COUNT(PARSE_CTCP, str.length());
+		if (!IsCTCP(str))
+		{
+			OULU_STATS_FAILURE(PARSE_CTCP);
+			name = body = {};
+			return false;
+		}
+
+		auto end_of_name = str.find(' ', 2);
+		auto end_of_ctcp = str.back() == '\x1' ? 1 : 0;
+		if (end_of_name == std::string_view::npos)
+		{
+			// The CTCP only contains a name.
+			name = str.substr(1, str.length() - end_of_ctcp - 1);
+			body = {};
+			return true;
+		}
+
+		// The CTCP contains a name and a body.
+		name = str.substr(1, end_of_name - 1);
+
+		auto start_of_body = str.find_first_not_of(' ', end_of_name + 1);
+		if (start_of_body == std::string_view::npos)
+		{
+			// The CTCP body is provided but empty.
+			body = {};
+			return true;
+		}
+
+		// The CTCP body provided was non-empty.
+		body = str.substr(start_of_body, str.length() - start_of_body - end_of_ctcp);
+		return true;
+	}
+
+	/** Strips formatting codes such as bold, colours, and underline from a string.
+	 * \param str The string to strip formatting codes from.
+	 */
+	std::string StripFormatting(const std::string_view& str);
+
+	/** Strips formatting codes such as bold, colours, and underline from a string into a string which
+	 * uses a polymorphic allocator.
+	 * \param str The string to strip formatting codes from.
+	 * \param allocator The allocator to allocate the stripped form with.
+	 */
+	std::pmr::string StripFormatting(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator);
+
+	/** Strips formatting codes such as bold, colours, and underline from a buffer in place. Stripping
+	 * never makes a string longer so the stripped form overwrites the start of the buffer.
+	 * \param str The buffer to strip formatting codes from.
+	 * \return A view of the stripped form at the start of the buffer.
+	 */
+	std::string_view StripFormattingInPlace(std::span<char> str);
+
+	/** Unescapes a string from the IRCv3 tag format and writes the unescaped form through an output
+	 * iterator.
+	 * \param out The output iterator to write the unescaped form to.
+	 * \param str The string to unescape.
+	 * \return The output iterator after the last character written.
+	 */
+	template <std::output_iterator<char> OutputIterator>
+	constexpr OutputIterator UnescapeTagTo(OutputIterator out, const std::string_view& str)
+	{
+		for (auto it = str.cbegin(); it != str.cend(); ++it)
+		{
+			if (*it != '\\')
+			{
+				*out++ = *it;
+				continue;
+			}
+
+			it++;
+			if (it == str.cend())
+				break;
+
+			switch (*it)
+			{
+				case 's':
+					*out++ = ' ';
+					break;
+				case ':':
+					*out++ = ';';
+					break;
+				case 'n':
+					*out++ = '\n';
+					break;
+				case 'r':
+					*out++ = '\r';
+					break;
+				default:
+					*out++ = *it;
+					break;
+			}
+		}
+		return out;
+	}
+
+	/** Unescapes a string from the IRCv3 tag format and appends the unescaped form to a string.
+	 * \param out The string to append the unescaped form to.
+	 * \param str The string to unescape.
+	 */
+	void UnescapeTagTo(std::string& out, const std::string_view& str);
+
+	/** Unescapes a string from the IRCv3 tag format and appends the unescaped form to a string which
+	 * uses a polymorphic allocator.
+	 * \param out The string to append the unescaped form to.
+	 * \param str The string to unescape.
+	 */
+	void UnescapeTagTo(std::pmr::string& out, const std::string_view& str);
 
 	/** Unescapes a string from the IRCv3 tag format.
 	 * \param str The string to unescape.
 	 */
-	std::string UnescapeTag(const std::string_view& str);
+	constexpr std::string UnescapeTag(const std::string_view& str)
+	{
+		std::string ret;
+		if (std::is_constant_evaluated())
+			UnescapeTagTo(std::back_inserter(ret), str);
+		else
+			UnescapeTagTo(ret, str);
+		return ret;
+	}
+
+	/** Unescapes a string from the IRCv3 tag format without copying it if nothing needs unescaping.
+	 * \param str The string to unescape.
+	 * \param buffer The buffer to write the unescaped form to if anything needs unescaping.
+	 * \return Either the string itself or a view of the unescaped form in the buffer.
+	 */
+	std::string_view UnescapeTag(const std::string_view& str, std::string& buffer);
+
+	/** Unescapes a string from the IRCv3 tag format into a string which uses a polymorphic allocator.
+	 * \param str The string to unescape.
+	 * \param allocator The allocator to allocate the unescaped form with.
+	 */
+	std::pmr::string UnescapeTag(const std::string_view& str, const std::pmr::polymorphic_allocator<char>& allocator);
+
+	/** Unescapes a string from the IRCv3 tag format without copying it if nothing needs unescaping.
+	 * \param str The string to unescape.
+	 * \param buffer The buffer to write the unescaped form to if anything needs unescaping.
+	 * \return Either the string itself or a view of the unescaped form in the buffer.
+	 */
+	std::string_view UnescapeTag(const std::string_view& str, std::pmr::string& buffer);
+
+	/** Unescapes a buffer from the IRCv3 tag format in place. Unescaping never makes a string longer
+	 * so the unescaped form overwrites the start of the buffer.
+	 * \param str The buffer to unescape.
+	 * \return A view of the unescaped form at the start of the buffer.
+	 */
+	std::string_view UnescapeTagInPlace(std::span<char> str);
+}
+
+/** BodyClassification describes the contents of the body of a PRIVMSG or NOTICE message. */
+class Oulu::BodyClassification final
+{
+public:
+	/** Whether the body is a CTCP ACTION. */
+	bool action = false;
+
+	/** Whether the body contains control characters other than formatting codes and CTCP delimiters. */
+	bool control = false;
+
+	/** Whether the body is a CTCP. */
+	bool ctcp = false;
+
+	/** The body of the CTCP as returned by ParseCTCP or an empty string view if not a CTCP. */
+	std::string_view ctcp_body;
+
+	/** The name of the CTCP as returned by ParseCTCP or an empty string view if not a CTCP. */
+	std::string_view ctcp_name;
+
+	/** Whether the body contains formatting codes such as bold, colours, and underline. */
+	bool formatting = false;
+};
+
+/** LineFramer splits data received from a connection into lines in the IRC wire format. */
+class Oulu::LineFramer final
+{
+public:
+	/** The maximum length of a line excluding the tags section but including the line terminator. */
+	static constexpr size_t MAX_LINE_LENGTH = 512;
+
+	/** The maximum length of the tags section of a line including the leading '@' and trailing space. */
+	static constexpr size_t MAX_TAGS_LENGTH = 8191;
+
+private:
+	/** The data which has been received. */
+	std::string buffer;
+
+	/** The lengths of the complete lines in the buffer including their line terminators. */
+	std::vector<size_t> lines;
+
+	/** The index of the next complete line to read. */
+	size_t next_line = 0;
+
+	/** The offset of the incomplete line at the end of the buffer. */
+	size_t partial = 0;
+
+	/** The offset of the next complete line in the buffer. */
+	size_t read = 0;
+
+public:
+	/** Creates a LineFramer with enough space to buffer a line of the maximum length. */
+	LineFramer();
+
+	/** Appends data which has been received to the buffer. If any line in the data exceeds the length
+	 * limits then none of it is buffered. This invalidates any lines which have been read.
+	 * \param data The data which has been received.
+	 * \return True if the data was buffered; otherwise, false.
+	 */
+	bool Append(const std::string_view& data);
+
+	/** Removes all data from the buffer. */
+	void Clear();
+
+	/** Retrieves the next complete line from the buffer. Lines may be terminated by either "\r\n" or
+	 * "\n" and empty lines are skipped.
+	 * \param line The next line without its line terminator, or an empty string view if none remain.
+	 * \return True if a line was retrieved; otherwise, false.
+	 */
+	bool GetLine(std::string_view& line);
+
+	/** Retrieves the number of bytes which are buffered but have not been read as a line. */
+	size_t GetPending() const { return buffer.length() - read; }
+};
+
+/** ListTokenizer splits a list such as the targets of a JOIN or the tokens of an ISUPPORT value into
+ * its elements without copying them.
+ */
+class Oulu::ListTokenizer final
+{
+private:
+	/** Whether empty elements are returned instead of being skipped. */
+	bool allow_empty;
+
+	/** The bitmask of the separator positions in the block which starts at block_offset. */
+	uint64_t block_mask = 0;
+
+	/** The offset of the block which block_mask was built for. */
+	size_t block_offset = std::string_view::npos;
+
+	/** The list we are parsing elements from. */
+	std::string_view list;
+
+	/** The offset of the next element which is past the end of the list once all have been read. */
+	size_t position = 0;
+
+	/** The character which separates elements. */
+	char separator;
+
+	/** Finds the next separator at or after an offset using the cached block mask.
+	 * \param offset The offset to start searching from.
+	 * \return The offset of the next separator or the length of the list if there are none.
+	 */
+	size_t FindSeparator(size_t offset);
+
+public:
+	/** Creates a ListTokenizer for the specified list.
+	 * \param l The list to split into elements.
+	 * \param s The character which separates elements.
+	 * \param ae Whether empty elements are returned instead of being skipped.
+	 */
+	ListTokenizer(const std::string_view& l, char s = ',', bool ae = false);
+
+	/** Retrieves the number of elements which remain in the list without reading them. */
+	size_t GetCount() const;
+
+	/** Retrieves the next element in the list.
+	 * \param element The next element, or an empty string view if none remain.
+	 * \return True if an element was retrieved; otherwise, false.
+	 */
+	bool GetNext(std::string_view& element);
+
+	/** Retrieves the part of the list which has not been read yet. */
+	std::string_view GetRemaining() const { return position < list.length() ? list.substr(position) : std::string_view(); }
+};
+
+/** MessageArena provides the scratch memory for processing a single line. Memory is handed out from
+ * a monotonic buffer and is all freed at once when the arena is reset after the line has been
+ * dispatched so short-lived strings do not fragment the heap.
+ */
+class Oulu::MessageArena final
+{
+public:
+	/** The default size of the initial buffer which fits two copies of a line of the maximum length. */
+	static constexpr size_t DEFAULT_SIZE = 2 * (LineFramer::MAX_LINE_LENGTH + LineFramer::MAX_TAGS_LENGTH);
+
+private:
+	/** The initial buffer which memory is allocated from. */
+	std::unique_ptr<std::byte[]> buffer;
+
+	/** The resource which allocates from the initial buffer and then from upstream once it is full. */
+	std::pmr::monotonic_buffer_resource resource;
+
+public:
+	/** Creates a MessageArena with an initial buffer of the specified size.
+	 * \param size The size of the initial buffer in bytes.
+	 * \param upstream The resource to allocate from once the initial buffer is full.
+	 */
+	explicit MessageArena(size_t size = DEFAULT_SIZE, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+	/** Retrieves an allocator which allocates from the arena. */
+	std::pmr::polymorphic_allocator<char> GetAllocator() { return &resource; }
+
+	/** Retrieves the memory resource which allocates from the arena. */
+	std::pmr::memory_resource* GetResource() { return &resource; }
+
+	/** Frees all of the memory which has been allocated from the arena. Anything which was allocated
+	 * from the arena must not be used after this is called.
+	 */
+	void Reset() { resource.release(); }
+};
+
+/** MessageBatch parses many messages in the IRC wire format at once into separate arrays for each
+ * component so that later stages can process every message without chasing pointers.
+ */
+class Oulu::MessageBatch final
+{
+public:
+	/** The location of a component within a message. */
+	class Range final
+	{
+	public:
+		/** The offset of the component from the start of the message. */
+		uint32_t offset;
+
+		/** The length of the component. */
+		uint32_t length;
+	};
+
+private:
+	/** The names of the commands of the messages. */
+	std::vector<std::string_view> command_names;
+
+	/** The identifiers of the commands of the messages. */
+	std::vector<Command> commands;
+
+	/** The messages which have been parsed. */
+	std::vector<std::string_view> lines;
+
+	/** The index of the first parameter of each message in params with a final entry for the end. */
+	std::vector<uint32_t> param_index = { 0 };
+
+	/** The locations of the parameters of every message. */
+	std::vector<Range> params;
+
+	/** The sources of the messages without the leading colon or an empty string view if not present. */
+	std::vector<std::string_view> sources;
+
+	/** The tags of the messages without the leading at sign or an empty string view if not present. */
+	std::vector<std::string_view> tags;
+
+public:
+	/** Removes all messages from the batch. */
+	void Clear();
+
+	/** Retrieves the names of the commands of the messages in the batch. If a command is known then
+	 * its name is the canonical upper-case name; otherwise, it points into the message.
+	 */
+	std::span<const std::string_view> GetCommandNames() const { return command_names; }
+
+	/** Retrieves the identifiers of the commands of the messages in the batch as returned by
+	 * IdentifyCommand.
+	 */
+	std::span<const Command> GetCommands() const { return commands; }
+
+	/** Retrieves the messages in the batch. */
+	std::span<const std::string_view> GetLines() const { return lines; }
+
+	/** Retrieves a parameter of a message in the batch.
+	 * \param message The index of the message.
+	 * \param param The index of the parameter which must be less than the parameter count.
+	 * \return The value of the parameter.
+	 */
+	std::string_view GetParam(size_t message, size_t param) const
+	{
+		const auto& range = params[param_index[message] + param];
+		return lines[message].substr(range.offset, range.length);
+	}
+
+	/** Retrieves the locations of the parameters of a message in the batch.
+	 * \param message The index of the message.
+	 */
+	std::span<const Range> GetParams(size_t message) const
+	{
+		return { params.data() + param_index[message], params.data() + param_index[message + 1] };
+	}
+
+	/** Retrieves the number of messages in the batch. */
+	size_t GetSize() const { return lines.size(); }
+
+	/** Retrieves the sources of the messages in the batch without the leading colon or an empty
+	 * string view if not present.
+	 */
+	std::span<const std::string_view> GetSources() const { return sources; }
+
+	/** Retrieves the tags of the messages in the batch without the leading at sign or an empty string
+	 * view if not present.
+	 */
+	std::span<const std::string_view> GetTags() const { return tags; }
+
+	/** Parses messages in the IRC wire format and adds them to the batch. The messages must outlive
+	 * this object and must not include the trailing line terminator. Messages which do not contain
+	 * a command are skipped. The parameters are split in the same way as ParsedMessage.
+	 * \param messages The messages to parse.
+	 * \return The number of messages which were added to the batch.
+	 */
+	size_t Parse(std::span<const std::string_view> messages);
+};
+
+/** MessageBuilder serializes a message to the IRC wire format once so that it can be sent to many
+ * connections with differing capabilities.
+ */
+class Oulu::MessageBuilder final
+{
+public:
+	/** An immutable serialized message which can be shared between connections. */
+	using Line = std::shared_ptr<const std::string>;
+
+private:
+	/** The location of a tag within the tag buffer. */
+	class TagEntry final
+	{
+	public:
+		/** The offset of the tag within the tag buffer. */
+		size_t offset;
+
+		/** The length of the key of the tag. */
+		size_t key_length;
+
+		/** The length of the tag including the value. */
+		size_t length;
+	};
+
+	/** The cached form of the message with all tags. */
+	Line all_tags;
+
+	/** The command of the message. */
+	std::string command;
+
+	/** The cached form of the message with no tags. */
+	Line no_tags;
+
+	/** The parameters of the message, each with a leading space. */
+	std::string params;
+
+	/** The source of the message. */
+	std::string source;
+
+	/** The tags of the message in their escaped wire form without any separators. */
+	std::string tag_buffer;
+
+	/** The locations of the tags within the tag buffer. */
+	std::vector<TagEntry> tags;
+
+	/** Whether a parameter which must be the last one has been added. */
+	bool trailing = false;
+
+	/** Serializes the message with the tags which match a predicate. */
+	template <typename Predicate>
+	Line Serialize(Predicate predicate) const;
+
+public:
+	/** Adds a tag to the message. The value is escaped as it is added.
+	 * \param key The key of the tag including any client-only prefix and vendor.
+	 * \param value The unescaped value of the tag or an empty string view for no value.
+	 * \return A reference to this object for chaining.
+	 */
+	MessageBuilder& AddTag(const std::string_view& key, const std::string_view& value = {});
+
+	/** Adds a parameter to the message. A parameter which is empty, contains a space, or starts with
+	 * a colon must be the last one so any parameters after it are ignored.
+	 * \param param The parameter to add.
+	 * \return A reference to this object for chaining.
+	 */
+	MessageBuilder& PushParam(const std::string_view& param);
+
+	/** Removes all components from the message so the builder can be reused. */
+	void Clear();
+
+	/** Serializes the message with all of its tags. The result is cached until the message is modified.
+	 * \return The message in the IRC wire format including the line terminator.
+	 */
+	Line Build();
+
+	/** Serializes the message with the tags which match a predicate.
+	 * \param predicate A function which takes the key of a tag and returns true if it should be included.
+	 * \return The message in the IRC wire format including the line terminator.
+	 */
+	template <std::predicate<std::string_view> Predicate>
+	Line Build(Predicate predicate)
+	{
+		// If no tags match then we can share the tagless form.
+		for (const auto& tag : tags)
+		{
+			if (predicate(std::string_view(tag_buffer).substr(tag.offset, tag.key_length)))
+				return Serialize(predicate);
+		}
+		return BuildWithoutTags();
+	}
+
+	/** Serializes the message without any tags. The result is cached until the message is modified.
+	 * \return The message in the IRC wire format including the line terminator.
+	 */
+	Line BuildWithoutTags();
+
+	/** Sets the command of the message.
+	 * \param cmd The command to set.
+	 * \return A reference to this object for chaining.
+	 */
+	MessageBuilder& SetCommand(const std::string_view& cmd);
+
+	/** Sets the source of the message.
+	 * \param src The source to set without the leading colon or an empty string view for no source.
+	 * \return A reference to this object for chaining.
+	 */
+	MessageBuilder& SetSource(const std::string_view& src);
+};
+
+template <typename Predicate>
+Oulu::MessageBuilder::Line Oulu::MessageBuilder::Serialize(Predicate predicate) const
+{
+	std::string line;
+	line.reserve(tag_buffer.length() + tags.size() + source.length() + command.length() + params.length() + 6);
+
+	for (const auto& tag : tags)
+	{
+		if (!predicate(std::string_view(tag_buffer).substr(tag.offset, tag.key_length)))
+			continue;
+
+		line.push_back(line.empty() ? '@' : ';');
+		line.append(tag_buffer, tag.offset, tag.length);
+	}
+
+	if (!line.empty())
+		line.push_back(' ');
+
+	if (!source.empty())
+		line.append(":").append(source).push_back(' ');
+
+	line.append(command).append(params).append("\r\n");
+	return std::make_shared<const std::string>(std::move(line));
 }
 
 /** MessageTokenizer allows tokens in the IRC wire format to be read from a message. */
@@ -48,19 +722,341 @@ private:
 	/** The message we are parsing tokens from. */
 	std::string_view message;
 
+	/** Implements TokenizeAll using the block scanner which can not be used in constant expressions. */
+	size_t TokenizeBlocks(std::span<std::string_view> tokens);
+
 public:
 	/** Creates a MessageTokenizer for the specified message. */
-	MessageTokenizer(const std::string_view& m);
+	constexpr MessageTokenizer(const std::string_view& m)
+		: message(m)
+	{
+	}
 
 	/** Retrieve the next \<GetMiddle> token in the message.
 	 * \param token The next token available, or an empty string view if none remain.
 	 * \return True if a token was retrieved; otherwise, false.
 	 */
-	bool GetMiddle(std::string_view& token);
+	constexpr bool GetMiddle(std::string_view& token)
+	{
+		// If we are past the end of the string we can't do anything.
+		if (this->message.empty())
+		{
+			token = {};
+			return false;
+		}
+
+		// If we can't find another separator this is the last token in the message.
+		auto separator = this->message.find(' ');
+		if (separator == std::string_view::npos)
+		{
+			token = this->message;
+			this->message = {};
+			return true;
+		}
+
+		token = this->message.substr(0, separator);
+
+		// If there is nothing but spaces after the separator then there are no more tokens.
+		separator = this->message.find_first_not_of(' ', separator);
+		if (separator != std::string_view::npos)
+			this->message.remove_prefix(separator);
+		else
+			this->message = {};
+
+		return true;
+	}
 
 	/** Retrieve the next \<GetTrailing> token in the message.
 	 * \param token The next token available, or an empty string view if none remain.
 	 * \return True if a token was retrieved; otherwise, false.
 	 */
-	bool GetTrailing(std::string_view& token);
+	constexpr bool GetTrailing(std::string_view& token)
+	{
+		// If we are past the end of the string we can't do anything.
+		if (this->message.empty())
+		{
+			token = {};
+			return false;
+		}
+
+		// If this is true then we have a <trailing> token!
+		if (message.front() == ':')
+		{
+			token = message.substr(1);
+			this->message = {};
+			return true;
+		}
+
+		// There is no <trailing> token so it must be a <middle> token.
+		return this->GetMiddle(token);
+	}
+
+	/** Retrieve as many of the remaining tokens in the message as will fit in the specified array.
+	 * The tokens are the same as would be returned by calling GetTrailing until it fails.
+	 * \param tokens The array to store the tokens in.
+	 * \return The number of tokens which were stored in the array.
+	 */
+	constexpr size_t TokenizeAll(std::span<std::string_view> tokens)
+	{
+		if (!std::is_constant_evaluated())
+			return TokenizeBlocks(tokens);
+
+		size_t count = 0;
+		while (count < tokens.size() && GetTrailing(tokens[count]))
+			count++;
+		return count;
+	}
+};
+
+/** ParsedMessage is a view of the components of a message in the IRC wire format. */
+class Oulu::ParsedMessage final
+{
+public:
+	/** The maximum number of parameters which a message can have. */
+	static constexpr size_t MAX_PARAMS = 15;
+
+private:
+	/** The command of the message. */
+	std::string_view command;
+
+	/** The host part of the message source or an empty string view if not present. */
+	std::string_view host;
+
+	/** The nick part of the message source or an empty string view if not present. If the source is
+	 * a server then this contains the server name.
+	 */
+	std::string_view nick;
+
+	/** The number of parameters in params which are in use. */
+	size_t param_count = 0;
+
+	/** The parameters of the message. */
+	std::array<std::string_view, MAX_PARAMS> params;
+
+	/** The source of the message without the leading colon or an empty string view if not present. */
+	std::string_view source;
+
+	/** The tags of the message without the leading at sign or an empty string view if not present. */
+	std::string_view tags;
+
+	/** The user part of the message source or an empty string view if not present. */
+	std::string_view user;
+
+public:
+	/** Retrieves the command of the message. */
+	const std::string_view& GetCommand() const { return command; }
+
+	/** Retrieves the host part of the message source or an empty string view if not present. */
+	const std::string_view& GetHost() const { return host; }
+
+	/** Retrieves the nick part of the message source or an empty string view if not present. If the
+	 * source is a server then this contains the server name.
+	 */
+	const std::string_view& GetNick() const { return nick; }
+
+	/** Retrieves the parameters of the message. */
+	std::span<const std::string_view> GetParams() const { return { params.data(), param_count }; }
+
+	/** Retrieves the source of the message without the leading colon or an empty string view if not
+	 * present.
+	 */
+	const std::string_view& GetSource() const { return source; }
+
+	/** Retrieves the tags of the message without the leading at sign or an empty string view if not
+	 * present.
+	 */
+	const std::string_view& GetTags() const { return tags; }
+
+	/** Retrieves the user part of the message source or an empty string view if not present. */
+	const std::string_view& GetUser() const { return user; }
+
+	/** Parses a message in the IRC wire format. The message must outlive this object and must not
+	 * include the trailing line terminator. If the message has more than MAX_PARAMS parameters then
+	 * the last parameter covers the rest of the message.
+	 * \param line The message to parse.
+	 * \return True if the message contained a command; otherwise, false.
+	 */
+	bool Parse(const std::string_view& line);
+};
+
+/** TagView allows the tags of a message in the IRCv3 wire format to be read without copying. */
+class Oulu::TagView final
+{
+public:
+	/** A single tag within a tag block. */
+	class Tag final
+	{
+	public:
+		/** The key of the tag including any client-only prefix and vendor. */
+		std::string_view key;
+
+		/** The value of the tag in its escaped form or an empty string view if not present. */
+		std::string_view value;
+
+		/** Retrieves the name of the tag without any client-only prefix or vendor. */
+		std::string_view GetName() const
+		{
+			const auto name = IsClientOnly() ? key.substr(1) : key;
+			const auto slash = name.find('/');
+			return slash == std::string_view::npos ? name : name.substr(slash + 1);
+		}
+
+		/** Retrieves the vendor of the tag or an empty string view if it does not have one. */
+		std::string_view GetVendor() const
+		{
+			const auto name = IsClientOnly() ? key.substr(1) : key;
+			const auto slash = name.find('/');
+			return slash == std::string_view::npos ? std::string_view() : name.substr(0, slash);
+		}
+
+		/** Determines whether the tag is a client-only tag. */
+		bool IsClientOnly() const { return key.starts_with('+'); }
+
+		/** Determines whether the value of the tag contains escape sequences. */
+		bool IsEscaped() const { return value.find('\\') != std::string_view::npos; }
+
+		/** Unescapes the value of the tag into a caller-provided buffer if necessary.
+		 * \param buffer The buffer to unescape into. This must be at least as long as the escaped value.
+		 * \return The unescaped value or std::nullopt if the buffer is too small. If the value does not
+		 *         contain any escape sequences then it is returned as is.
+		 */
+		std::optional<std::string_view> Unescape(std::span<char> buffer) const;
+	};
+
+	/** Iterates over the tags in a tag block in the order they were sent. */
+	class Iterator final
+	{
+	private:
+		friend class TagView;
+
+		/** The tag which the iterator currently points to. */
+		Tag current;
+
+		/** Whether the iterator has reached the end of the tags. */
+		bool done = false;
+
+		/** The tags which have not been visited yet. */
+		std::string_view remaining;
+
+	public:
+		using difference_type = std::ptrdiff_t;
+		using value_type = Tag;
+
+		/** Creates an iterator which has reached the end of the tags. */
+		Iterator() = default;
+
+		/** Creates an iterator over the tags in the specified tag block. */
+		explicit Iterator(const std::string_view& tags)
+			: remaining(tags)
+		{
+			++*this;
+		}
+
+		const Tag& operator*() const { return current; }
+		const Tag* operator->() const { return &current; }
+
+		/** Advances the iterator to the next tag. */
+		Iterator& operator++();
+
+		Iterator operator++(int)
+		{
+			auto old = *this;
+			++*this;
+			return old;
+		}
+
+		bool operator==(std::default_sentinel_t) const { return done; }
+	};
+
+	/** The maximum length of an escaped value which can be unescaped into the inline buffer. */
+	static constexpr size_t INLINE_BUFFER_SIZE = 128;
+
+	/** The maximum number of tags which are indexed. Any tags after this are found by scanning. */
+	static constexpr size_t MAX_INDEXED_TAGS = 16;
+
+private:
+	/** The tags which have been indexed. */
+	std::array<Tag, MAX_INDEXED_TAGS> index;
+
+	/** Whether the tag block has been indexed yet. */
+	bool indexed = false;
+
+	/** The number of tags in index which are in use. */
+	size_t index_size = 0;
+
+	/** The buffer used for unescaping values which will fit in it. */
+	std::array<char, INLINE_BUFFER_SIZE> inline_buffer;
+
+	/** The buffer used for unescaping values which are too long for the inline buffer. */
+	std::string overflow_buffer;
+
+	/** The most recent tag which was found by scanning the unindexed tags. */
+	Tag scanned;
+
+	/** The tag block which is being viewed. */
+	std::string_view tags;
+
+	/** The tags which did not fit in the index. */
+	std::string_view unindexed;
+
+	/** Indexes the tag block if it has not already been indexed. */
+	void BuildIndex();
+
+public:
+	/** Creates a TagView for the specified tag block.
+	 * \param t The tags of a message without the leading at sign. This must outlive the TagView.
+	 */
+	explicit TagView(const std::string_view& t = {})
+		: tags(t)
+	{
+	}
+
+	/** Retrieves an iterator to the first tag in the tag block. */
+	Iterator begin() const { return Iterator(tags); }
+
+	/** Retrieves a sentinel for the end of the tag block. */
+	std::default_sentinel_t end() const { return {}; }
+
+	/** Finds a tag by its key. If the key exists more than once then the first occurrence is found.
+	 * \param key The key of the tag including any client-only prefix and vendor.
+	 * \return The tag with the specified key or nullptr if it does not exist.
+	 */
+	const Tag* Find(const std::string_view& key);
+
+	/** Retrieves the unescaped value of a tag. Values which need unescaping are unescaped into an
+	 * internal buffer so the returned view is only valid until the next call to this method.
+	 * \param key The key of the tag including any client-only prefix and vendor.
+	 * \return The unescaped value of the tag or std::nullopt if it does not exist.
+	 */
+	std::optional<std::string_view> Get(const std::string_view& key);
+
+	/** Retrieves the unescaped value of a tag using a caller-provided buffer for unescaping.
+	 * \param key The key of the tag including any client-only prefix and vendor.
+	 * \param buffer The buffer to unescape into. This must be at least as long as the escaped value.
+	 * \return The unescaped value of the tag or std::nullopt if it does not exist or the buffer is too small.
+	 */
+	std::optional<std::string_view> Get(const std::string_view& key, std::span<char> buffer)
+	{
+		OULU_STATS_CALL(TAG_VIEW_GET, key.length());
+		const auto* tag = Find(key);
+		if (!tag)
+		{
+			OULU_STATS_FAILURE(TAG_VIEW_GET);
+			return std::nullopt;
+		}
+		return tag->Unescape(buffer);
+	}
+
+	/** Retrieves the escaped value of a tag.
+	 * \param key The key of the tag including any client-only prefix and vendor.
+	 * \return The escaped value of the tag or std::nullopt if it does not exist.
+	 */
+	std::optional<std::string_view> GetRaw(const std::string_view& key)
+	{
+		const auto* tag = Find(key);
+		return tag ? std::make_optional(tag->value) : std::nullopt;
+	}
+
+	/** Retrieves the tag block which is being viewed. */
+	const std::string_view& GetTags() const { return tags; }
 };
@@ -0,0 +1,188 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <utility>
+
+#include <oulu/message.hpp>
+#include <oulu/mode.hpp>
+#include <oulu/stats.hpp>
+
+namespace
+{
+	// The types of the mode groups in the CHANMODES ISUPPORT token in the order they are sent.
+	constexpr Oulu::ModeType CHANMODES_GROUPS[] = {
+		Oulu::ModeType::LIST,
+		Oulu::ModeType::PARAM,
+		Oulu::ModeType::PARAM_SET,
+		Oulu::ModeType::FLAG,
+	};
+
+	// Parses the mode changes from a mode string using a callback to retrieve the next parameter.
+	template <typename NextParam>
+	size_t ParseModes(const Oulu::ModeTable& table, const std::string_view& modestr, NextParam&& next_param, std::span<Oulu::ModeChange> changes)
+	{
+		size_t count = 0;
+		auto adding = true;
+		for (const auto chr : modestr)
+		{
+			if (chr == '+' || chr == '-')
+			{
+				adding = chr == '+';
+				continue;
+			}
+
+			// Servers ignore changes which are missing their parameter so we do too.
+			std::string_view param;
+			if (table.HasParam(chr, adding) && !next_param(param))
+				continue;
+
+			if (count >= changes.size())
+				break;
+
+			changes[count++] = { adding, chr, param };
+		}
+		return count;
+	}
+}
+
+Oulu::ModeTable::ModeTable(const std::string_view& chanmodes, const std::string_view& prefix)
+{
+	ListTokenizer groups(chanmodes, ',', true);
+	std::string_view group;
+	for (const auto type : CHANMODES_GROUPS)
+	{
+		if (!groups.GetNext(group))
+			break;
+
+		for (const auto chr : group)
+			types[static_cast<uint8_t>(chr)] = type;
+	}
+
+	// The PREFIX token is in the format "(modes)prefixes" with each mode paired with a prefix.
+	const auto end = prefix.find(')');
+	if (prefix.empty() || prefix.front() != '(' || end == std::string_view::npos)
+		return;
+
+	const auto letters = prefix.substr(1, end - 1);
+	const auto symbols = prefix.substr(end + 1);
+	for (size_t idx = 0; idx < std::min(letters.length(), symbols.length()); ++idx)
+	{
+		const auto letter = static_cast<uint8_t>(letters[idx]);
+		types[letter] = ModeType::PREFIX;
+		prefixes[letter] = symbols[idx];
+	}
+}
+
+size_t Oulu::ModeTable::Parse(std::span<const std::string_view> params, std::span<ModeChange> changes) const
+{
+	OULU_STATS_CALL(MODE_TABLE_PARSE, params.empty() ? 0 : params[0].length());
+	if (params.empty())
+		return 0;
+
+	size_t param = 1;
+	return ParseModes(*this, params[0], [&params, &param](std::string_view& value) {
+		if (param >= params.size())
+			return false;
+
+		value = params[param++];
+		return true;
+	}, changes);
+}
+
+size_t Oulu::ModeTable::Parse(const std::string_view& modes, std::span<ModeChange> changes) const
+{
+	OULU_STATS_CALL(MODE_TABLE_PARSE, modes.length());
+	MessageTokenizer tokenizer(modes);
+	std::string_view modestr;
+	if (!tokenizer.GetTrailing(modestr))
+		return 0;
+
+	return ParseModes(*this, modestr, [&tokenizer](std::string_view& value) {
+		return tokenizer.GetTrailing(value);
+	}, changes);
+}
+
+std::vector<std::string> Oulu::ModeTable::Serialize(std::span<const ModeChange> changes, size_t max_modes, size_t max_length) const
+{
+	OULU_STATS_CALL(MODE_TABLE_SERIALIZE, changes.size());
+
+	// Walk the changes backwards so only the last change to each mode is kept. List and prefix
+	// modes are identified by their parameter and all other modes by their letter.
+	std::vector<bool> overridden(changes.size());
+	std::vector<size_t> keyed;
+	std::array<bool, 256> seen_letters = { };
+	for (size_t idx = changes.size(); idx-- > 0; )
+	{
+		const auto& change = changes[idx];
+		const auto type = GetType(change.letter);
+		if (type == ModeType::LIST || type == ModeType::PREFIX || (type == ModeType::UNKNOWN && !change.param.empty()))
+		{
+			keyed.push_back(idx);
+			continue;
+		}
+
+		auto& seen = seen_letters[static_cast<uint8_t>(change.letter)];
+		overridden[idx] = seen;
+		seen = true;
+	}
+
+	// Sorting the parameterised changes groups changes to the same mode with the last one first.
+	const auto key = [&changes](size_t idx) { return std::make_pair(changes[idx].letter, changes[idx].param); };
+	std::stable_sort(keyed.begin(), keyed.end(), [&key](size_t lhs, size_t rhs) { return key(lhs) < key(rhs); });
+	for (size_t idx = 1; idx < keyed.size(); ++idx)
+	{
+		if (key(keyed[idx]) == key(keyed[idx - 1]))
+			overridden[keyed[idx]] = true;
+	}
+
+	std::vector<ModeChange> merged;
+	merged.reserve(changes.size());
+	for (size_t idx = 0; idx < changes.size(); ++idx)
+	{
+		if (!overridden[idx])
+			merged.push_back(changes[idx]);
+	}
+
+	// Now no two changes affect the same mode we can group them by direction to avoid repeating
+	// the signs.
+	std::stable_partition(merged.begin(), merged.end(), [](const ModeChange& change) { return change.adding; });
+
+	std::vector<std::string> lines;
+	std::string letters;
+	std::string params;
+	size_t param_count = 0;
+	char current_sign = 0;
+	for (const auto& change : merged)
+	{
+		const auto sign = change.adding ? '+' : '-';
+		const auto has_param = GetType(change.letter) == ModeType::UNKNOWN ? !change.param.empty() : HasParam(change.letter, change.adding);
+		const auto length = (sign != current_sign) + 1 + (has_param ? change.param.length() + 1 : 0);
+		const auto full = has_param && max_modes && param_count >= max_modes;
+		if (!letters.empty() && (full || letters.length() + params.length() + length > max_length))
+		{
+			lines.push_back(letters + params);
+			letters.clear();
+			params.clear();
+			param_count = 0;
+			current_sign = 0;
+		}
+
+		if (sign != current_sign)
+		{
+			letters.push_back(sign);
+			current_sign = sign;
+		}
+		letters.push_back(change.letter);
+
+		if (has_param)
+		{
+			params.append(" ").append(change.param);
+			param_count++;
+		}
+	}
+
+	if (!letters.empty())
+		lines.push_back(letters + params);
+	return lines;
+}
@@ -0,0 +1,147 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Oulu
+{
+	class ModeChange;
+	class ModeTable;
+
+	/** The types of channel mode which can be advertised by the CHANMODES and PREFIX ISUPPORT tokens. */
+	enum class ModeType
+		: uint8_t
+	{
+		/** A mode which is not known. Unknown modes are assumed to not have a parameter. */
+		UNKNOWN,
+
+		/** A type A mode which adds or removes an entry from a list and always has a parameter. */
+		LIST,
+
+		/** A type B mode which changes a setting and always has a parameter. */
+		PARAM,
+
+		/** A type C mode which changes a setting and only has a parameter when being set. */
+		PARAM_SET,
+
+		/** A type D mode which changes a setting and never has a parameter. */
+		FLAG,
+
+		/** A mode which grants or revokes a status prefix from a user and always has a parameter. */
+		PREFIX,
+	};
+}
+
+/** ModeChange is a single change from a mode line. */
+class Oulu::ModeChange final
+{
+public:
+	/** Whether the mode is being added or removed. */
+	bool adding;
+
+	/** The character which identifies the mode. */
+	char letter;
+
+	/** The parameter of the mode or an empty string view if it does not have one. */
+	std::string_view param;
+
+	/** Determines whether this change is equal to another change. */
+	bool operator==(const ModeChange& other) const = default;
+};
+
+/** ModeTable classifies the channel modes advertised by a server so that mode lines can be parsed
+ * and serialized.
+ */
+class Oulu::ModeTable final
+{
+public:
+	/** The value of the CHANMODES ISUPPORT token which is assumed if the server does not send one. */
+	static constexpr std::string_view DEFAULT_CHANMODES = "beI,k,l,imnpst";
+
+	/** The value of the PREFIX ISUPPORT token which is assumed if the server does not send one. */
+	static constexpr std::string_view DEFAULT_PREFIX = "(ov)@+";
+
+private:
+	/** The status prefix of every prefix mode indexed by the mode character. */
+	std::array<char, 256> prefixes = { };
+
+	/** The type of every mode indexed by the mode character. */
+	std::array<ModeType, 256> types = { };
+
+public:
+	/** Creates a ModeTable from the values of the CHANMODES and PREFIX ISUPPORT tokens. Modes in the
+	 * groups after the fourth group of CHANMODES are left unknown as their type can not be known.
+	 * \param chanmodes The value of the CHANMODES ISUPPORT token.
+	 * \param prefix The value of the PREFIX ISUPPORT token.
+	 */
+	explicit ModeTable(const std::string_view& chanmodes = DEFAULT_CHANMODES, const std::string_view& prefix = DEFAULT_PREFIX);
+
+	/** Retrieves the status prefix of a prefix mode.
+	 * \param letter The character which identifies the mode.
+	 * \return The status prefix of the mode or a null character if it is not a prefix mode.
+	 */
+	char GetPrefix(char letter) const { return prefixes[static_cast<uint8_t>(letter)]; }
+
+	/** Retrieves the type of a mode.
+	 * \param letter The character which identifies the mode.
+	 * \return The type of the mode or ModeType::UNKNOWN if it is not known.
+	 */
+	ModeType GetType(char letter) const { return types[static_cast<uint8_t>(letter)]; }
+
+	/** Determines whether a mode has a parameter when it is changed.
+	 * \param letter The character which identifies the mode.
+	 * \param adding Whether the mode is being added or removed.
+	 * \return True if the mode has a parameter; otherwise, false.
+	 */
+	bool HasParam(char letter, bool adding) const
+	{
+		switch (GetType(letter))
+		{
+			case ModeType::LIST:
+			case ModeType::PARAM:
+			case ModeType::PREFIX:
+				return true;
+			case ModeType::PARAM_SET:
+				return adding;
+			default:
+				return false;
+		}
+	}
+
+	/** Parses the mode changes from the parameters of a MODE message. Changes which need a parameter
+	 * but do not have one are skipped and changes which do not fit in the array are discarded.
+	 * \param params The parameters of the message starting with the mode string.
+	 * \param changes The array to store the changes in. The parameters of the changes point into
+	 *                the parameters of the message.
+	 * \return The number of changes which were stored in the array.
+	 */
+	size_t Parse(std::span<const std::string_view> params, std::span<ModeChange> changes) const;
+
+	/** Parses the mode changes from a mode string followed by its space-separated parameters.
+	 * \param modes The mode string and parameters, e.g. "+ov-b nick1 nick2 mask".
+	 * \param changes The array to store the changes in. The parameters of the changes point into
+	 *                the mode string.
+	 * \return The number of changes which were stored in the array.
+	 */
+	size_t Parse(const std::string_view& modes, std::span<ModeChange> changes) const;
+
+	/** Serializes mode changes into as few mode strings as possible. Changes which are overridden
+	 * by a later change to the same mode are removed and changes which add modes are placed before
+	 * changes which remove them. The parameters of the changes must be valid \<middle> tokens.
+	 * \param changes The changes to serialize.
+	 * \param max_modes The maximum number of changes with a parameter in each mode string which is
+	 *                  usually the value of the MODES ISUPPORT token or zero for no limit.
+	 * \param max_length The maximum length of each mode string and its parameters. A change which
+	 *                   is longer than this on its own is placed in a mode string by itself.
+	 * \return The mode strings and their parameters in the same format as accepted by Parse.
+	 */
+	std::vector<std::string> Serialize(std::span<const ModeChange> changes, size_t max_modes, size_t max_length) const;
+};
@@ -0,0 +1,72 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <atomic>
+
+#include <oulu/simd.hpp>
+
+namespace
+{
+	Oulu::SIMD::Level DetectLevel()
+	{
+#if defined(OULU_ARCH_X86) && defined(__GNUC__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return Oulu::SIMD::Level::AVX2;
+		if (__builtin_cpu_supports("sse4.1"))
+			return Oulu::SIMD::Level::SSE41;
+#elif defined(OULU_ARCH_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const auto max_leaf = info[0];
+
+		__cpuid(info, 1);
+		const auto sse41 = !!(info[2] & (1 << 19));
+		const auto osxsave = !!(info[2] & (1 << 27));
+		const auto avx = !!(info[2] & (1 << 28));
+
+		// AVX2 also requires the OS to save the YMM registers on context switch.
+		if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5))
+				return Oulu::SIMD::Level::AVX2;
+		}
+
+		if (sse41)
+			return Oulu::SIMD::Level::SSE41;
+#endif
+		return Oulu::SIMD::Level::SCALAR;
+	}
+
+	Oulu::SIMD::Level GetSupportedLevel()
+	{
+		static const auto supported_level = DetectLevel();
+		return supported_level;
+	}
+
+	std::atomic<Oulu::SIMD::Level>& GetActiveLevel()
+	{
+		static std::atomic<Oulu::SIMD::Level> active_level(GetSupportedLevel());
+		return active_level;
+	}
+}
+
+Oulu::SIMD::Level Oulu::SIMD::GetLevel()
+{
+	return GetActiveLevel().load(std::memory_order_relaxed);
+}
+
+bool Oulu::SIMD::IsSupported(Level level)
+{
+	return level <= GetSupportedLevel();
+}
+
+bool Oulu::SIMD::SetLevel(Level level)
+{
+	if (!IsSupported(level))
+		return false;
+
+	GetActiveLevel().store(level, std::memory_order_relaxed);
+	return true;
+}
@@ -0,0 +1,51 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+
+#include <oulu/macros.hpp>
+
+#ifdef OULU_ARCH_X86
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+# include <immintrin.h>
+#endif
+
+namespace Oulu::SIMD
+{
+	/** The instruction set levels which Oulu has kernels for. */
+	enum class Level
+		: uint8_t
+	{
+		/** Portable kernels which do not use any SIMD instructions. */
+		SCALAR,
+
+		/** x86 kernels which use instructions up to and including SSE4.1. */
+		SSE41,
+
+		/** x86 kernels which use instructions up to and including AVX2. */
+		AVX2,
+	};
+
+	/** Retrieves the level that kernels are currently being dispatched to. This is detected once on
+	 * first use and is the best level supported by the CPU unless overridden with SetLevel.
+	 */
+	Level GetLevel();
+
+	/** Determines whether the CPU supports kernels from the specified level.
+	 * \param level The level to check for support of.
+	 * \return True if the level is supported; otherwise, false.
+	 */
+	bool IsSupported(Level level);
+
+	/** Overrides the level that kernels are dispatched to. This is intended for comparing kernels
+	 * against each other in tests and benchmarks and is not safe to call whilst other threads are
+	 * using the library.
+	 * \param level The level to dispatch kernels to.
+	 * \return True if the level was changed; otherwise, false if the level is not supported.
+	 */
+	bool SetLevel(Level level);
+}
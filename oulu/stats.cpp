@@ -0,0 +1,180 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <oulu/stats.hpp>
+
+namespace
+{
+	// The names of the functions indexed by their identifier.
+	constexpr std::string_view FUNCTION_NAMES[] = {
+		"Base64Decode",
+		"Base64Encode",
+		"ClassifyBody",
+		"EscapeTag",
+		"FoldCase",
+		"HexDecode",
+		"HexEncode",
+		"IdentifyCommand",
+		"LineFramer::Append",
+		"MessageBatch::Parse",
+		"MessageBuilder::Build",
+		"MessageTokenizer::TokenizeAll",
+		"ModeTable::Parse",
+		"ModeTable::Serialize",
+		"ParseCTCP",
+		"ParsedMessage::Parse",
+		"PercentDecode",
+		"PercentEncode",
+		"StripFormatting",
+		"TagView::Get",
+		"UnescapeTag",
+		"UTF8::IsValid",
+		"UTF8::Truncate",
+	};
+	static_assert(std::size(FUNCTION_NAMES) == Oulu::Stats::FUNCTION_COUNT);
+
+#ifdef OULU_ENABLE_STATS
+	// Reads the counters of a thread into a snapshot.
+	void ReadInto(Oulu::Stats::Snapshot& snapshot, const Oulu::Stats::ThreadStats& stats)
+	{
+		for (size_t idx = 0; idx < Oulu::Stats::FUNCTION_COUNT; ++idx)
+		{
+			const auto& entry = stats.entries[idx];
+			auto& function = snapshot.functions[idx];
+			function.bytes += entry.bytes.load(std::memory_order_relaxed);
+			function.calls += entry.calls.load(std::memory_order_relaxed);
+			for (size_t bucket = 0; bucket < Oulu::Stats::HISTOGRAM_BUCKETS; ++bucket)
+				function.cycles[bucket] += entry.cycles[bucket].load(std::memory_order_relaxed);
+			function.failures += entry.failures.load(std::memory_order_relaxed);
+			function.slow_paths += entry.slow_paths.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Keeps track of the counters of every thread which has recorded statistics.
+	class Registry final
+	{
+	public:
+		// The totals of the threads which have exited.
+		Oulu::Stats::Snapshot exited;
+
+		// Protects the other members.
+		std::mutex mutex;
+
+		// The counters of the threads which are running.
+		std::vector<const Oulu::Stats::ThreadStats*> threads;
+	};
+
+	// The registry is never destroyed so threads which exit during static destruction can still
+	// deregister from it.
+	Registry& GetRegistry()
+	{
+		static auto* registry = new Registry();
+		return *registry;
+	}
+
+	// Owns the counters of the current thread and merges them into the totals when it exits.
+	class ThreadOwner final
+	{
+	public:
+		// The counters of the current thread.
+		std::unique_ptr<Oulu::Stats::ThreadStats> stats;
+
+		~ThreadOwner()
+		{
+			if (!stats)
+				return;
+
+			auto& registry = GetRegistry();
+			const std::lock_guard lock(registry.mutex);
+			ReadInto(registry.exited, *stats);
+			std::erase(registry.threads, stats.get());
+			Oulu::Stats::current_thread = nullptr;
+		}
+	};
+
+	thread_local ThreadOwner owner;
+#endif
+}
+
+#ifdef OULU_ENABLE_STATS
+constinit thread_local Oulu::Stats::ThreadStats* Oulu::Stats::current_thread = nullptr;
+
+Oulu::Stats::ThreadStats& Oulu::Stats::ThreadStats::Register()
+{
+	owner.stats = std::make_unique<ThreadStats>();
+
+	auto& registry = GetRegistry();
+	const std::lock_guard lock(registry.mutex);
+	registry.threads.push_back(owner.stats.get());
+	current_thread = owner.stats.get();
+	return *current_thread;
+}
+#endif
+
+Oulu::Stats::FunctionStats& Oulu::Stats::FunctionStats::Merge(const FunctionStats& other)
+{
+	bytes += other.bytes;
+	calls += other.calls;
+	for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket)
+		cycles[bucket] += other.cycles[bucket];
+	failures += other.failures;
+	slow_paths += other.slow_paths;
+	return *this;
+}
+
+Oulu::Stats::Snapshot& Oulu::Stats::Snapshot::Merge(const Snapshot& other)
+{
+	for (size_t idx = 0; idx < FUNCTION_COUNT; ++idx)
+		functions[idx].Merge(other.functions[idx]);
+	return *this;
+}
+
+std::string_view Oulu::Stats::GetName(Function function)
+{
+	const auto idx = static_cast<size_t>(function);
+	return idx < FUNCTION_COUNT ? FUNCTION_NAMES[idx] : std::string_view();
+}
+
+Oulu::Stats::Snapshot Oulu::Stats::GetSnapshot()
+{
+	Snapshot snapshot;
+#ifdef OULU_ENABLE_STATS
+	auto& registry = GetRegistry();
+	const std::lock_guard lock(registry.mutex);
+	snapshot = registry.exited;
+	for (const auto* stats : registry.threads)
+		ReadInto(snapshot, *stats);
+#endif
+	return snapshot;
+}
+
+Oulu::Stats::Snapshot Oulu::Stats::GetThreadSnapshot()
+{
+	Snapshot snapshot;
+#ifdef OULU_ENABLE_STATS
+	if (current_thread)
+		ReadInto(snapshot, *current_thread);
+#endif
+	return snapshot;
+}
+
+bool Oulu::Stats::IsHistogramEnabled()
+{
+#ifdef OULU_ENABLE_STATS
+	return histogram_enabled.load(std::memory_order_relaxed);
+#else
+	return false;
+#endif
+}
+
+void Oulu::Stats::SetHistogramEnabled([[maybe_unused]] bool enabled)
+{
+#ifdef OULU_ENABLE_STATS
+	histogram_enabled.store(enabled, std::memory_order_relaxed);
+#endif
+}
@@ -0,0 +1,309 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include <oulu/macros.hpp>
+
+#if defined(OULU_ENABLE_STATS) && defined(OULU_ARCH_X86)
+# ifdef _MSC_VER
+#  include <intrin.h>
+# else
+#  include <x86intrin.h>
+# endif
+#endif
+
+namespace Oulu::Stats
+{
+	class CallScope;
+	class FunctionStats;
+	class Snapshot;
+	class ThreadStats;
+
+	/** The public functions which record statistics. Overloads of a function share an identifier. */
+	enum class Function
+		: uint8_t
+	{
+		BASE64_DECODE,
+		BASE64_ENCODE,
+		CLASSIFY_BODY,
+		ESCAPE_TAG,
+		FOLD_CASE,
+		HEX_DECODE,
+		HEX_ENCODE,
+		IDENTIFY_COMMAND,
+		LINE_FRAMER_APPEND,
+		MESSAGE_BATCH_PARSE,
+		MESSAGE_BUILDER_BUILD,
+		MESSAGE_TOKENIZER_TOKENIZE_ALL,
+		MODE_TABLE_PARSE,
+		MODE_TABLE_SERIALIZE,
+		PARSE_CTCP,
+		PARSED_MESSAGE_PARSE,
+		PERCENT_DECODE,
+		PERCENT_ENCODE,
+		STRIP_FORMATTING,
+		TAG_VIEW_GET,
+		UNESCAPE_TAG,
+		UTF8_IS_VALID,
+		UTF8_TRUNCATE,
+	};
+
+	/** The number of function identifiers. */
+	inline constexpr size_t FUNCTION_COUNT = static_cast<size_t>(Function::UTF8_TRUNCATE) + 1;
+
+	/** The number of buckets in a cycle histogram. Bucket N counts the calls which took fewer than
+	 * 2^N cycles and at least 2^(N-1) cycles with the last bucket also counting all longer calls. On
+	 * architectures without a cycle counter the durations are measured in steady clock ticks instead.
+	 */
+	inline constexpr size_t HISTOGRAM_BUCKETS = 32;
+
+	/** Retrieves the name of a function.
+	 * \param function The function to retrieve the name of.
+	 * \return The name of the function, e.g. "ParsedMessage::Parse".
+	 */
+	std::string_view GetName(Function function);
+
+	/** Retrieves the statistics of every thread which has called into the library including threads
+	 * which have exited. The counters of other threads are read without stopping them so a snapshot
+	 * may not include calls which are in progress.
+	 */
+	Snapshot GetSnapshot();
+
+	/** Retrieves the statistics of the current thread. */
+	Snapshot GetThreadSnapshot();
+
+	/** Determines whether cycle histograms are being recorded. */
+	bool IsHistogramEnabled();
+
+	/** Determines whether the library was built with statistics. If not then all snapshots are empty. */
+	constexpr bool IsEnabled()
+	{
+#ifdef OULU_ENABLE_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** Enables or disables recording cycle histograms. Reading the cycle counter is not free so these
+	 * are disabled by default.
+	 * \param enabled Whether to record cycle histograms.
+	 */
+	void SetHistogramEnabled(bool enabled);
+}
+
+/** FunctionStats holds the statistics which have been recorded for a function. */
+class Oulu::Stats::FunctionStats final
+{
+public:
+	/** The total size of the input which was passed to the function. This is the number of bytes for
+	 * functions which take a string, the number of elements for functions which take an array, and
+	 * zero for functions which do not take any input.
+	 */
+	uint64_t bytes = 0;
+
+	/** The number of times the function was called. */
+	uint64_t calls = 0;
+
+	/** A histogram of the number of cycles taken by calls whilst histograms were enabled. */
+	std::array<uint64_t, HISTOGRAM_BUCKETS> cycles = { };
+
+	/** The number of calls which failed or rejected their input. */
+	uint64_t failures = 0;
+
+	/** The number of calls which could not use their fast path, e.g. because a tag value needed to
+	 * be unescaped.
+	 */
+	uint64_t slow_paths = 0;
+
+	/** Adds the statistics from another FunctionStats to this one.
+	 * \param other The statistics to add.
+	 * \return A reference to this object.
+	 */
+	FunctionStats& Merge(const FunctionStats& other);
+};
+
+/** Snapshot holds the statistics of every function at a point in time. */
+class Oulu::Stats::Snapshot final
+{
+public:
+	/** The statistics of every function indexed by its identifier. */
+	std::array<FunctionStats, FUNCTION_COUNT> functions;
+
+	/** Retrieves the statistics of a function.
+	 * \param function The function to retrieve the statistics of.
+	 */
+	const FunctionStats& Get(Function function) const { return functions[static_cast<size_t>(function)]; }
+
+	/** Adds the statistics from another Snapshot to this one. This can be used to combine the
+	 * snapshots of several processes.
+	 * \param other The statistics to add.
+	 * \return A reference to this object.
+	 */
+	Snapshot& Merge(const Snapshot& other);
+};
+
+#ifdef OULU_ENABLE_STATS
+
+/** ThreadStats holds the counters of a single thread. These are only written by the thread which
+ * owns them so they are updated without atomic read-modify-write instructions.
+ */
+class Oulu::Stats::ThreadStats final
+{
+public:
+	/** The size of a cache line which the counters of each function are aligned to. */
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	/** The counters of a single function. */
+	class alignas(CACHE_LINE_SIZE) Entry final
+	{
+	public:
+		/** The total size of the input which was passed to the function. */
+		std::atomic<uint64_t> bytes;
+
+		/** The number of times the function was called. */
+		std::atomic<uint64_t> calls;
+
+		/** A histogram of the number of cycles taken by calls whilst histograms were enabled. */
+		std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> cycles;
+
+		/** The number of calls which failed or rejected their input. */
+		std::atomic<uint64_t> failures;
+
+		/** The number of calls which could not use their fast path. */
+		std::atomic<uint64_t> slow_paths;
+	};
+
+	/** The counters of every function indexed by its identifier. */
+	std::array<Entry, FUNCTION_COUNT> entries;
+
+	/** Adds to a counter which is only written by the current thread.
+	 * \param counter The counter to add to.
+	 * \param amount The amount to add.
+	 */
+	static void Add(std::atomic<uint64_t>& counter, uint64_t amount)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	/** Retrieves the counters of the current thread for a function.
+	 * \param function The function to retrieve the counters of.
+	 */
+	static Entry& Get(Function function);
+
+	/** Creates the counters of the current thread and registers them so they are included in
+	 * snapshots.
+	 */
+	static ThreadStats& Register();
+};
+
+namespace Oulu::Stats
+{
+	/** The counters of the current thread or nullptr if it has not recorded anything yet. */
+	extern constinit thread_local ThreadStats* current_thread;
+
+	/** Whether cycle histograms are being recorded. */
+	inline std::atomic<bool> histogram_enabled = false;
+
+	/** Reads a cycle counter which is used for measuring the duration of calls. */
+	inline uint64_t ReadCycles()
+	{
+#ifdef OULU_ARCH_X86
+		return __rdtsc();
+#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	/** Records a call to a function without recording its duration.
+	 * \param function The function which was called.
+	 * \param bytes The number of bytes which were passed to the function.
+	 */
+	constexpr void RecordCall(Function function, size_t bytes)
+	{
+		if (std::is_constant_evaluated())
+			return;
+
+		auto& entry = ThreadStats::Get(function);
+		ThreadStats::Add(entry.calls, 1);
+		ThreadStats::Add(entry.bytes, bytes);
+	}
+
+	/** Records that a call to a function failed or rejected its input.
+	 * \param function The function which failed.
+	 */
+	constexpr void RecordFailure(Function function)
+	{
+		if (!std::is_constant_evaluated())
+			ThreadStats::Add(ThreadStats::Get(function).failures, 1);
+	}
+
+	/** Records that a call to a function could not use its fast path.
+	 * \param function The function which took its slow path.
+	 */
+	constexpr void RecordSlowPath(Function function)
+	{
+		if (!std::is_constant_evaluated())
+			ThreadStats::Add(ThreadStats::Get(function).slow_paths, 1);
+	}
+}
+
+inline Oulu::Stats::ThreadStats::Entry& Oulu::Stats::ThreadStats::Get(Function function)
+{
+	auto* stats = current_thread;
+	if (!stats) [[unlikely]]
+		stats = &Register();
+	return stats->entries[static_cast<size_t>(function)];
+}
+
+/** CallScope records a call to a function and, if histograms are enabled, how long it takes until
+ * the end of the scope.
+ */
+class Oulu::Stats::CallScope final
+{
+private:
+	/** The counters of the function which was called. */
+	ThreadStats::Entry& entry;
+
+	/** The cycle counter at the start of the call or zero if the duration is not being recorded. */
+	uint64_t start;
+
+public:
+	/** Records a call to a function.
+	 * \param function The function which was called.
+	 * \param bytes The number of bytes which were passed to the function.
+	 */
+	CallScope(Function function, size_t bytes)
+		: entry(ThreadStats::Get(function))
+		, start(histogram_enabled.load(std::memory_order_relaxed) ? ReadCycles() : 0)
+	{
+		ThreadStats::Add(entry.calls, 1);
+		ThreadStats::Add(entry.bytes, bytes);
+	}
+
+	CallScope(const CallScope&) = delete;
+	CallScope& operator=(const CallScope&) = delete;
+
+	/** Records the duration of the call if histograms are enabled. */
+	~CallScope()
+	{
+		if (!start)
+			return;
+
+		const auto bucket = std::min<size_t>(std::bit_width(ReadCycles() - start), HISTOGRAM_BUCKETS - 1);
+		ThreadStats::Add(entry.cycles[bucket], 1);
+	}
+};
+
+#endif
@@ -0,0 +1,423 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cstring>
+
+#include <oulu/simd.hpp>
+#include <oulu/stats.hpp>
+#include <oulu/utf8.hpp>
+
+namespace
+{
+	// The number of octets which are checked for ASCII at once by the SIMD kernels.
+	constexpr size_t ASCII_BLOCK_SIZE = 64;
+
+	// The errors which can be detected from the high and low nibbles of a pair of adjacent octets.
+	// This uses the lookup algorithm from "Validating UTF-8 In Less Than One Instruction Per Byte"
+	// by John Keiser and Daniel Lemire.
+	constexpr uint8_t TOO_SHORT = 1 << 0; // 11______ 0_______ or 11______ 11______
+	constexpr uint8_t TOO_LONG = 1 << 1; // 0_______ 10______
+	constexpr uint8_t OVERLONG_3 = 1 << 2; // 11100000 100_____
+	constexpr uint8_t TOO_LARGE = 1 << 3; // 11110100 1001____ or 11110100 101_____ or 11110101+ 10______
+	constexpr uint8_t SURROGATE = 1 << 4; // 11101101 101_____
+	constexpr uint8_t OVERLONG_2 = 1 << 5; // 1100000_ 10______
+	constexpr uint8_t TOO_LARGE_1000 = 1 << 6; // 11110101+ 1000____
+	constexpr uint8_t OVERLONG_4 = 1 << 6; // 11110000 1000____
+	constexpr uint8_t TWO_CONTS = 1 << 7; // 10______ 10______
+	constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+	// The errors which are possible given the high nibble of the first octet of a pair.
+	constexpr uint8_t BYTE_1_HIGH[16] = {
+		TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+		TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+		TOO_SHORT | OVERLONG_2,
+		TOO_SHORT,
+		TOO_SHORT | OVERLONG_3 | SURROGATE,
+		TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+	};
+
+	// The errors which are possible given the low nibble of the first octet of a pair.
+	constexpr uint8_t BYTE_1_LOW[16] = {
+		CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+		CARRY | OVERLONG_2,
+		CARRY,
+		CARRY,
+		CARRY | TOO_LARGE,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+	};
+
+	// The errors which are possible given the high nibble of the second octet of a pair.
+	constexpr uint8_t BYTE_2_HIGH[16] = {
+		TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+		TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+	};
+
+#ifdef OULU_ARCH_X86
+	// Checks a block of octets given the block before it and merges any errors into error.
+	OULU_ATTR_TARGET("sse4.1")
+	inline void ValidateBlockSSE41(__m128i input, __m128i& prev_input, __m128i& prev_incomplete, __m128i& error)
+	{
+		const auto byte_1_high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH));
+		const auto byte_1_low_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW));
+		const auto byte_2_high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH));
+		const auto low_nibble = _mm_set1_epi8(0x0F);
+
+		// Find the errors in each pair of adjacent octets.
+		const auto prev1 = _mm_alignr_epi8(input, prev_input, 15);
+		const auto byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+		const auto byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, low_nibble));
+		const auto byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+		const auto special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+		// Find the octets which must be the third or fourth octet of a sequence.
+		const auto prev2 = _mm_alignr_epi8(input, prev_input, 14);
+		const auto prev3 = _mm_alignr_epi8(input, prev_input, 13);
+		const auto is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+		const auto is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+		const auto must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+		error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special_cases));
+
+		// Find any sequences which are incomplete at the end of the block.
+		const auto max_value = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+		prev_incomplete = _mm_subs_epu8(input, max_value);
+		prev_input = input;
+	}
+
+	OULU_ATTR_TARGET("sse4.1")
+	bool IsValidSSE41(const char* data, size_t length)
+	{
+		auto error = _mm_setzero_si128();
+		auto prev_incomplete = _mm_setzero_si128();
+		auto prev_input = _mm_setzero_si128();
+
+		size_t idx = 0;
+		for ( ; idx + ASCII_BLOCK_SIZE <= length; idx += ASCII_BLOCK_SIZE)
+		{
+			const auto input1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx));
+			const auto input2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx + 16));
+			const auto input3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx + 32));
+			const auto input4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx + 48));
+			if (!_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(input1, input2), _mm_or_si128(input3, input4))))
+			{
+				// The block is ASCII so the only possible error is a sequence which was cut off.
+				error = _mm_or_si128(error, prev_incomplete);
+				prev_incomplete = _mm_setzero_si128();
+				prev_input = input4;
+				continue;
+			}
+
+			ValidateBlockSSE41(input1, prev_input, prev_incomplete, error);
+			ValidateBlockSSE41(input2, prev_input, prev_incomplete, error);
+			ValidateBlockSSE41(input3, prev_input, prev_incomplete, error);
+			ValidateBlockSSE41(input4, prev_input, prev_incomplete, error);
+		}
+
+		for ( ; idx + 16 <= length; idx += 16)
+			ValidateBlockSSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + idx)), prev_input, prev_incomplete, error);
+
+		// Pad the tail with NUL so that a sequence which is cut off at the end is always an error.
+		char tail[16] = { };
+		memcpy(tail, data + idx, length - idx);
+		ValidateBlockSSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail)), prev_input, prev_incomplete, error);
+		return _mm_testz_si128(error, error);
+	}
+
+	// Checks a block of octets given the block before it and merges any errors into error.
+	OULU_ATTR_TARGET("avx2")
+	inline void ValidateBlockAVX2(__m256i input, __m256i& prev_input, __m256i& prev_incomplete, __m256i& error)
+	{
+		const auto byte_1_high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)));
+		const auto byte_1_low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)));
+		const auto byte_2_high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)));
+		const auto low_nibble = _mm256_set1_epi8(0x0F);
+
+		// Find the errors in each pair of adjacent octets. The shuffles only work within each
+		// 128-bit lane so we need to bring in the end of the previous lane first.
+		const auto prev_lane = _mm256_permute2x128_si256(prev_input, input, 0x21);
+		const auto prev1 = _mm256_alignr_epi8(input, prev_lane, 15);
+		const auto byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+		const auto byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, low_nibble));
+		const auto byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+		const auto special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+		// Find the octets which must be the third or fourth octet of a sequence.
+		const auto prev2 = _mm256_alignr_epi8(input, prev_lane, 14);
+		const auto prev3 = _mm256_alignr_epi8(input, prev_lane, 13);
+		const auto is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+		const auto is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+		const auto must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+		error = _mm256_or_si256(error, _mm256_xor_si256(must_be_continuation, special_cases));
+
+		// Find any sequences which are incomplete at the end of the block.
+		const auto max_value = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+		prev_incomplete = _mm256_subs_epu8(input, max_value);
+		prev_input = input;
+	}
+
+	OULU_ATTR_TARGET("avx2")
+	bool IsValidAVX2(const char* data, size_t length)
+	{
+		auto error = _mm256_setzero_si256();
+		auto prev_incomplete = _mm256_setzero_si256();
+		auto prev_input = _mm256_setzero_si256();
+
+		size_t idx = 0;
+		for ( ; idx + ASCII_BLOCK_SIZE <= length; idx += ASCII_BLOCK_SIZE)
+		{
+			const auto input1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx));
+			const auto input2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx + 32));
+			if (!_mm256_movemask_epi8(_mm256_or_si256(input1, input2)))
+			{
+				// The block is ASCII so the only possible error is a sequence which was cut off.
+				error = _mm256_or_si256(error, prev_incomplete);
+				prev_incomplete = _mm256_setzero_si256();
+				prev_input = input2;
+				continue;
+			}
+
+			ValidateBlockAVX2(input1, prev_input, prev_incomplete, error);
+			ValidateBlockAVX2(input2, prev_input, prev_incomplete, error);
+		}
+
+		for ( ; idx + 32 <= length; idx += 32)
+			ValidateBlockAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + idx)), prev_input, prev_incomplete, error);
+
+		// Pad the tail with NUL so that a sequence which is cut off at the end is always an error.
+		char tail[32] = { };
+		memcpy(tail, data + idx, length - idx);
+		ValidateBlockAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)), prev_input, prev_incomplete, error);
+		return _mm256_testz_si256(error, error);
+	}
+#endif
+
+	// The codepoint which is returned when a sequence can not be decoded.
+	constexpr uint32_t INVALID_CODEPOINT = 0xFFFFFFFF;
+
+	// Determines whether an octet is a continuation of a multi-octet sequence.
+	constexpr bool IsContinuation(char chr)
+	{
+		return (static_cast<uint8_t>(chr) & 0xC0) == 0x80;
+	}
+
+	// Decodes the sequence at the start of a string and stores its length in length.
+	uint32_t Decode(const std::string_view& str, size_t& length)
+	{
+		const auto lead = static_cast<uint8_t>(str[0]);
+		length = 1;
+		if (lead < 0x80)
+			return lead;
+
+		uint32_t codepoint;
+		uint32_t min_codepoint;
+		if ((lead & 0xE0) == 0xC0)
+		{
+			length = 2;
+			codepoint = lead & 0x1F;
+			min_codepoint = 0x80;
+		}
+		else if ((lead & 0xF0) == 0xE0)
+		{
+			length = 3;
+			codepoint = lead & 0x0F;
+			min_codepoint = 0x800;
+		}
+		else if ((lead & 0xF8) == 0xF0)
+		{
+			length = 4;
+			codepoint = lead & 0x07;
+			min_codepoint = 0x10000;
+		}
+		else
+			return INVALID_CODEPOINT;
+
+		if (length > str.length())
+		{
+			length = 1;
+			return INVALID_CODEPOINT;
+		}
+
+		for (size_t idx = 1; idx < length; ++idx)
+		{
+			if (!IsContinuation(str[idx]))
+			{
+				length = 1;
+				return INVALID_CODEPOINT;
+			}
+			codepoint = (codepoint << 6) | (static_cast<uint8_t>(str[idx]) & 0x3F);
+		}
+
+		if (codepoint < min_codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		{
+			length = 1;
+			return INVALID_CODEPOINT;
+		}
+		return codepoint;
+	}
+
+	// Decodes the sequence which ends before the specified position and stores its start in start.
+	uint32_t DecodeBefore(const std::string_view& str, size_t position, size_t& start)
+	{
+		// Sequences are at most four octets long so we only need to look back that far.
+		start = position - 1;
+		while (start > 0 && position - start < 4 && IsContinuation(str[start]))
+			start--;
+
+		size_t length;
+		const auto codepoint = Decode(str.substr(start, position - start), length);
+		if (start + length != position)
+		{
+			// The octet before the position is not the end of a valid sequence.
+			start = position - 1;
+			return INVALID_CODEPOINT;
+		}
+		return codepoint;
+	}
+
+	// Determines whether a codepoint extends the grapheme before it.
+	constexpr bool IsGraphemeExtend(uint32_t codepoint)
+	{
+		return (codepoint >= 0x0300 && codepoint <= 0x036F) // Combining Diacritical Marks
+			|| (codepoint >= 0x1AB0 && codepoint <= 0x1AFF) // Combining Diacritical Marks Extended
+			|| (codepoint >= 0x1DC0 && codepoint <= 0x1DFF) // Combining Diacritical Marks Supplement
+			|| (codepoint >= 0x200C && codepoint <= 0x200D) // Zero Width Non-Joiner and Zero Width Joiner
+			|| (codepoint >= 0x20D0 && codepoint <= 0x20FF) // Combining Diacritical Marks for Symbols
+			|| (codepoint >= 0xFE00 && codepoint <= 0xFE0F) // Variation Selectors
+			|| (codepoint >= 0xFE20 && codepoint <= 0xFE2F) // Combining Half Marks
+			|| (codepoint >= 0x1F3FB && codepoint <= 0x1F3FF) // Emoji Modifiers
+			|| (codepoint >= 0xE0020 && codepoint <= 0xE007F) // Tags
+			|| (codepoint >= 0xE0100 && codepoint <= 0xE01EF); // Variation Selectors Supplement
+	}
+
+	// Determines whether a codepoint is a regional indicator which is used in pairs for flags.
+	constexpr bool IsRegionalIndicator(uint32_t codepoint)
+	{
+		return codepoint >= 0x1F1E6 && codepoint <= 0x1F1FF;
+	}
+
+	// Checks whether a string is valid UTF-8 one sequence at a time.
+	bool IsValidScalar(const std::string_view& str)
+	{
+		for (size_t idx = 0; idx < str.length(); )
+		{
+			// Skip over ASCII eight octets at a time.
+			if (idx + 8 <= str.length())
+			{
+				uint64_t word;
+				memcpy(&word, str.data() + idx, sizeof(word));
+				if (!(word & uint64_t(0x8080808080808080)))
+				{
+					idx += 8;
+					continue;
+				}
+			}
+
+			size_t length;
+			if (Decode(str.substr(idx), length) == INVALID_CODEPOINT)
+				return false;
+			idx += length;
+		}
+		return true;
+	}
+}
+
+bool Oulu::UTF8::IsValid(const std::string_view& str)
+{
+	OULU_STATS_CALL(UTF8_IS_VALID, str.length());
+
+	// Short strings are cheaper to check than to pad for the SIMD kernels.
+	bool valid;
+	if (str.length() < 16)
+		valid = IsValidScalar(str);
+	else
+	{
+		switch (Oulu::SIMD::GetLevel())
+		{
+#ifdef OULU_ARCH_X86
+			case Oulu::SIMD::Level::AVX2:
+				valid = IsValidAVX2(str.data(), str.length());
+				break;
+			case Oulu::SIMD::Level::SSE41:
+				valid = IsValidSSE41(str.data(), str.length());
+				break;
+#endif
+			default:
+				valid = IsValidScalar(str);
+				break;
+		}
+	}
+
+	if (!valid)
+		OULU_STATS_FAILURE(UTF8_IS_VALID);
+	return valid;
+}
+
+std::string_view Oulu::UTF8::Truncate(const std::string_view& str, size_t max_length, Boundary boundary)
+{
+	OULU_STATS_CALL(UTF8_TRUNCATE, str.length());
+	if (str.length() <= max_length)
+		return str;
+
+	// Move back to the lead octet of the sequence which the cut is within. Sequences are at most
+	// four octets long so there can be at most three continuation octets before the cut.
+	auto cut = max_length;
+	if (IsContinuation(str[cut]))
+	{
+		auto start = cut;
+		while (start > 0 && cut - start < 3 && IsContinuation(str[start]))
+			start--;
+
+		size_t length;
+		if (Decode(str.substr(start), length) != INVALID_CODEPOINT && start + length > cut)
+			cut = start;
+	}
+
+	if (boundary != Boundary::GRAPHEME)
+		return str.substr(0, cut);
+
+	// Move back until the codepoints either side of the cut are in different graphemes.
+	while (cut > 0)
+	{
+		size_t length;
+		size_t previous_start;
+		const auto next = Decode(str.substr(cut), length);
+		const auto previous = DecodeBefore(str, cut, previous_start);
+		if (IsGraphemeExtend(next) || previous == 0x200D)
+		{
+			cut = previous_start;
+			continue;
+		}
+
+		if (IsRegionalIndicator(next) && IsRegionalIndicator(previous))
+		{
+			// Regional indicators are paired from the start of a run of them.
+			size_t count = 0;
+			for (auto position = cut; position > 0 && IsRegionalIndicator(DecodeBefore(str, position, position)); )
+				count++;
+
+			if (count % 2)
+			{
+				cut = previous_start;
+				continue;
+			}
+		}
+		break;
+	}
+	return str.substr(0, cut);
+}
@@ -0,0 +1,43 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Oulu::UTF8
+{
+	/** The boundaries which a string can be truncated at. */
+	enum class Boundary
+		: uint8_t
+	{
+		/** Truncate between codepoints. */
+		CODEPOINT,
+
+		/** Truncate between codepoints without separating combining marks, joiners, variation
+		 * selectors, emoji modifiers, tags, or regional indicator pairs from the character before them.
+		 * This does not implement the full set of grapheme cluster rules from Unicode but keeps the
+		 * common multi-codepoint characters intact.
+		 */
+		GRAPHEME,
+	};
+
+	/** Determines whether a string is valid UTF-8. Overlong forms, surrogates, and codepoints above
+	 * U+10FFFF are not valid.
+	 * \param str The string to check.
+	 * \return True if the string is valid UTF-8; otherwise, false.
+	 */
+	bool IsValid(const std::string_view& str);
+
+	/** Truncates a UTF-8 string to at most the specified number of bytes without splitting a
+	 * character. If the string is not valid UTF-8 then it is truncated without splitting any of its
+	 * valid sequences.
+	 * \param str The string to truncate.
+	 * \param max_length The maximum length of the truncated string in bytes.
+	 * \param boundary The kind of boundary to truncate at.
+	 * \return The longest prefix of the string which ends at a boundary and is at most max_length bytes.
+	 */
+	std::string_view Truncate(const std::string_view& str, size_t max_length, Boundary boundary = Boundary::CODEPOINT);
+}
@@ -0,0 +1,133 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <string>
+#include <unordered_map>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <oulu/casemap.hpp>
+#include <oulu/simd.hpp>
+
+TEST_CASE("Test that CaseMapping functions as expected")
+{
+	SECTION("Test that the casemappings fold the expected characters")
+	{
+		REQUIRE(Oulu::ASCII_CASEMAPPING.Fold('A') == 'a');
+		REQUIRE(Oulu::ASCII_CASEMAPPING.Fold('Z') == 'z');
+		REQUIRE(Oulu::ASCII_CASEMAPPING.Fold('[') == '[');
+
+		REQUIRE(Oulu::STRICT_RFC1459_CASEMAPPING.Fold('[') == '{');
+		REQUIRE(Oulu::STRICT_RFC1459_CASEMAPPING.Fold('\\') == '|');
+		REQUIRE(Oulu::STRICT_RFC1459_CASEMAPPING.Fold(']') == '}');
+		REQUIRE(Oulu::STRICT_RFC1459_CASEMAPPING.Fold('^') == '^');
+
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Fold('^') == '~');
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Fold('_') == '_');
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Fold('@') == '@');
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Fold('\xC1') == '\xC1');
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Fold('a') == 'a');
+	}
+
+	SECTION("Test that folding words matches folding characters")
+	{
+		for (const auto* casemap : { &Oulu::ASCII_CASEMAPPING, &Oulu::RFC1459_CASEMAPPING, &Oulu::STRICT_RFC1459_CASEMAPPING })
+		{
+			for (size_t chr = 0; chr < 256; chr += 8)
+			{
+				char input[8];
+				char expected[8];
+				for (size_t idx = 0; idx < 8; ++idx)
+				{
+					input[idx] = static_cast<char>(chr + idx);
+					expected[idx] = casemap->Fold(input[idx]);
+				}
+
+				const auto folded = casemap->FoldWord(Oulu::CaseMapping::LoadWord(input, 8));
+				REQUIRE(folded == Oulu::CaseMapping::LoadWord(expected, 8));
+			}
+		}
+	}
+
+	SECTION("Test that Equals and Hash fold as they go")
+	{
+		const std::string_view lower = "nick[away]^_with~a{long}name|";
+		const std::string_view upper = "NICK{AWAY}~_WITH^A[LONG]NAME\\";
+		for (size_t length = 0; length <= lower.length(); ++length)
+		{
+			const auto lhs = lower.substr(0, length);
+			const auto rhs = upper.substr(0, length);
+			REQUIRE(Oulu::RFC1459_CASEMAPPING.Equals(lhs, rhs));
+			REQUIRE(Oulu::RFC1459_CASEMAPPING.Hash(lhs) == Oulu::RFC1459_CASEMAPPING.Hash(rhs));
+		}
+
+		REQUIRE(!Oulu::RFC1459_CASEMAPPING.Equals("nick", "nicks"));
+		REQUIRE(!Oulu::RFC1459_CASEMAPPING.Equals("nick_", "nick^"));
+		REQUIRE(!Oulu::RFC1459_CASEMAPPING.Equals("averylongnick", "averylongnicl"));
+		REQUIRE(!Oulu::STRICT_RFC1459_CASEMAPPING.Equals("nick^", "nick~"));
+		REQUIRE(!Oulu::ASCII_CASEMAPPING.Equals("nick[", "nick{"));
+		REQUIRE(Oulu::RFC1459_CASEMAPPING.Hash("nick") != Oulu::RFC1459_CASEMAPPING.Hash("nicks"));
+	}
+}
+
+TEST_CASE("Test that FoldCase functions as expected")
+{
+	const auto original_level = Oulu::SIMD::GetLevel();
+
+	std::string input;
+	for (size_t idx = 0; idx < 300; ++idx)
+		input.push_back(static_cast<char>(idx * 7));
+
+	for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+	{
+		if (!Oulu::SIMD::SetLevel(level))
+			continue;
+
+		for (const auto* casemap : { &Oulu::ASCII_CASEMAPPING, &Oulu::RFC1459_CASEMAPPING, &Oulu::STRICT_RFC1459_CASEMAPPING })
+		{
+			for (size_t length = 0; length <= input.length(); length += 13)
+			{
+				const auto str = std::string_view(input).substr(0, length);
+				std::string expected;
+				for (const auto chr : str)
+					expected.push_back(casemap->Fold(chr));
+
+				REQUIRE(Oulu::FoldCase(str, *casemap) == expected);
+
+				std::string buffer(str);
+				REQUIRE(Oulu::FoldCaseInPlace(buffer, *casemap) == expected);
+
+				std::string out(length, '\0');
+				REQUIRE(Oulu::FoldCaseTo(out, str, *casemap) == length);
+				REQUIRE(out == expected);
+				if (length)
+				{
+					std::string small(length - 1, '\0');
+					REQUIRE(!Oulu::FoldCaseTo(small, str, *casemap));
+				}
+			}
+		}
+	}
+
+	Oulu::SIMD::SetLevel(original_level);
+}
+
+TEST_CASE("Test that CaseHash and CaseEqual can be used with containers")
+{
+	std::unordered_map<std::string, int, Oulu::CaseHash, Oulu::CaseEqual> nicks;
+	nicks.emplace("Nick[away]", 1);
+	nicks.emplace("NICK{AWAY}", 2);
+	nicks.emplace("OtherNick", 3);
+	REQUIRE(nicks.size() == 2);
+
+	const std::string_view token = "nick{away}";
+	REQUIRE(nicks.find(token) != nicks.end());
+	REQUIRE(nicks.find(token)->second == 1);
+	REQUIRE(nicks.find(std::string_view("othernick"))->second == 3);
+	REQUIRE(nicks.find(std::string_view("othernick_")) == nicks.end());
+
+	std::unordered_map<std::string, int, Oulu::CaseHash, Oulu::CaseEqual> ascii_nicks(0, Oulu::CaseHash(Oulu::ASCII_CASEMAPPING), Oulu::CaseEqual(Oulu::ASCII_CASEMAPPING));
+	ascii_nicks.emplace("Nick[away]", 1);
+	ascii_nicks.emplace("NICK{AWAY}", 2);
+	REQUIRE(ascii_nicks.size() == 2);
+}
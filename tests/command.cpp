@@ -0,0 +1,89 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <oulu/command.hpp>
+
+TEST_CASE("Test that IdentifyCommand functions as expected")
+{
+	SECTION("Test that we can identify named commands")
+	{
+		auto command = Oulu::IdentifyCommand("PRIVMSG");
+		REQUIRE(command);
+		REQUIRE(command.id == Oulu::Command::PRIVMSG);
+		REQUIRE(command.name == "PRIVMSG");
+
+		REQUIRE(Oulu::IdentifyCommand("ACK").id == Oulu::Command::ACK);
+		REQUIRE(Oulu::IdentifyCommand("AUTHENTICATE").id == Oulu::Command::AUTHENTICATE);
+		REQUIRE(Oulu::IdentifyCommand("WHO").id == Oulu::Command::WHO);
+		REQUIRE(Oulu::IdentifyCommand("WHOIS").id == Oulu::Command::WHOIS);
+		REQUIRE(Oulu::IdentifyCommand("WHOWAS").id == Oulu::Command::WHOWAS);
+	}
+
+	SECTION("Test that every named command can be identified in any case")
+	{
+		std::set<Oulu::Command> seen;
+		for (const std::string name : { "ACCOUNT", "ACK", "ADMIN", "AUTHENTICATE", "AWAY", "BATCH", "CAP",
+			"CHGHOST", "CONNECT", "DIE", "ERROR", "FAIL", "HELP", "INFO", "INVITE", "ISON", "JOIN", "KICK",
+			"KILL", "KNOCK", "LINKS", "LIST", "LUSERS", "MODE", "MONITOR", "MOTD", "NAMES", "NICK", "NOTE",
+			"NOTICE", "OPER", "PART", "PASS", "PING", "PONG", "PRIVMSG", "QUIT", "REHASH", "RESTART",
+			"SERVICE", "SERVLIST", "SETNAME", "SQUERY", "SQUIT", "STATS", "SUMMON", "TAGMSG", "TIME", "TOPIC",
+			"TRACE", "USER", "USERHOST", "USERS", "VERSION", "WALLOPS", "WARN", "WEBIRC", "WHO", "WHOIS",
+			"WHOWAS" })
+		{
+			const auto command = Oulu::IdentifyCommand(name);
+			REQUIRE(command);
+			REQUIRE(!Oulu::IsNumeric(command.id));
+			REQUIRE(command.name == name);
+			seen.insert(command.id);
+
+			std::string lower(name);
+			std::transform(lower.begin(), lower.end(), lower.begin(), [](char chr) { return chr | 0x20; });
+			const auto lower_command = Oulu::IdentifyCommand(lower);
+			REQUIRE(lower_command.id == command.id);
+			REQUIRE(lower_command.name == name);
+
+			std::string mixed(name);
+			for (size_t idx = 0; idx < mixed.length(); idx += 2)
+				mixed[idx] |= 0x20;
+			REQUIRE(Oulu::IdentifyCommand(mixed).id == command.id);
+		}
+		REQUIRE(seen.size() == static_cast<size_t>(Oulu::Command::NUMERIC) - 1);
+	}
+
+	SECTION("Test that we can identify numerics")
+	{
+		const auto command = Oulu::IdentifyCommand("433");
+		REQUIRE(command);
+		REQUIRE(Oulu::IsNumeric(command.id));
+		REQUIRE(Oulu::GetNumeric(command.id) == 433);
+		REQUIRE(command.id == Oulu::MakeNumeric(433));
+		REQUIRE(command.name == "433");
+
+		REQUIRE(Oulu::IdentifyCommand("000").id == Oulu::MakeNumeric(0));
+		REQUIRE(Oulu::IdentifyCommand("999").id == Oulu::MakeNumeric(999));
+		REQUIRE(static_cast<size_t>(Oulu::MakeNumeric(999)) == Oulu::COMMAND_COUNT - 1);
+		REQUIRE(!Oulu::IsNumeric(Oulu::Command::WHOWAS));
+	}
+
+	SECTION("Test that unknown commands return the original name")
+	{
+		for (const auto* name : { "", "P", "PI", "PRIVMSGS", "PRIVMSF", "PRIVMSG\x01", "4A3", "1234", "AUTHENTICATED", "XYZZY", "PRIV MSG" })
+		{
+			const std::string_view view(name);
+			const auto command = Oulu::IdentifyCommand(view);
+			REQUIRE(!command);
+			REQUIRE(command.id == Oulu::Command::UNKNOWN);
+			REQUIRE(command.name.data() == view.data());
+		}
+
+		// Characters which differ from a letter only in bit 5 must not be folded.
+		REQUIRE(!Oulu::IdentifyCommand("\x10\x11\x12"));
+		REQUIRE(!Oulu::IdentifyCommand("pInG\x60"));
+	}
+}
@@ -1,9 +1,87 @@
 // Oulu <https://github.com/inspircd/liboulu/>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <array>
+#include <iterator>
+#include <memory_resource>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 #include <oulu/encoding.hpp>
+#include <oulu/simd.hpp>
+
+namespace
+{
+	// Generates a random string of the specified length using the characters from a table.
+	std::string RandomString(std::mt19937& rng, size_t length, std::string_view table)
+	{
+		std::uniform_int_distribution<size_t> dist(0, table.length() - 1);
+
+		std::string str;
+		str.reserve(length);
+		while (str.length() < length)
+			str.push_back(table[dist(rng)]);
+		return str;
+	}
+
+	// Runs a function at every supported SIMD level and checks the output matches the scalar level.
+	template <typename Function>
+	void RequireKernelsMatch(Function function)
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+
+		Oulu::SIMD::SetLevel(Oulu::SIMD::Level::SCALAR);
+		const auto expected = function();
+
+		for (const auto level : { Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			const auto actual = function();
+			Oulu::SIMD::SetLevel(original_level);
+			REQUIRE(actual == expected);
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+}
+
+TEST_CASE("Test that EncodingTable functions as expected")
+{
+	SECTION("Test that tables can be built at compile time")
+	{
+		static_assert(Oulu::BASE64_TABLE.Decode('A') == 0);
+		static_assert(Oulu::BASE64_TABLE.Decode('/') == 63);
+		static_assert(Oulu::BASE64_TABLE.Decode('=') == Oulu::Base64Table::INVALID);
+		static_assert(Oulu::BASE64_URL_TABLE.Encode(62) == '-');
+		static_assert(Oulu::HEX_TABLE_UPPER.Contains('F'));
+		static_assert(Oulu::HEX_TABLE_UPPER.Decode('f') == 15);
+		static_assert(!Oulu::HEX_TABLE_UPPER.Contains('g'));
+		static_assert(Oulu::PERCENT_TABLE.Contains('~'));
+		static_assert(!Oulu::PERCENT_TABLE.Contains('\0'));
+	}
+
+	SECTION("Test that tables can be built at runtime")
+	{
+		const std::string characters = "0123456789abcdef";
+		const Oulu::HexTable table(characters.c_str());
+		REQUIRE(table.Decode('a') == 10);
+		REQUIRE(table.Decode('A') == Oulu::HexTable::INVALID);
+		REQUIRE(table.Encode(15) == 'f');
+		REQUIRE(table.Contains('0'));
+		REQUIRE(!table.Contains('g'));
+	}
+
+	SECTION("Test that the first occurrence of a duplicate character is used")
+	{
+		const Oulu::HexTable table("0123456789abcdea");
+		REQUIRE(table.Decode('a') == 10);
+	}
+}
 
 TEST_CASE("Test that Base64Decode functions as expected")
 {
@@ -30,6 +108,31 @@ TEST_CASE("Test that Base64Decode functions as expected")
 	{
 		REQUIRE(Oulu::Base64Decode("fn5-", Oulu::BASE64_URL_TABLE) == "~~~");
 	}
+
+	SECTION("Test that we can handle runtime-supplied Base64 tables")
+	{
+		static constexpr const auto* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789.,";
+		REQUIRE(Oulu::Base64Decode("fn5.", table) == "~~~");
+		REQUIRE(Oulu::Base64Decode("fn5.", static_cast<const char*>(Oulu::BASE64_URL_TABLE)) == "~~");
+	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		std::mt19937 rng(0x0B64);
+		for (const auto& table : { Oulu::BASE64_TABLE, Oulu::BASE64_URL_TABLE })
+		{
+			const std::string characters = table.GetCharacters();
+			for (size_t length = 0; length < 300; length += 7)
+			{
+				// Mostly valid input with the occasional padding and invalid octet.
+				const auto valid = RandomString(rng, length, characters);
+				const auto noisy = RandomString(rng, length, characters + characters + "= \n");
+
+				RequireKernelsMatch([&] { return Oulu::Base64Decode(valid, table); });
+				RequireKernelsMatch([&] { return Oulu::Base64Decode(noisy, table); });
+			}
+		}
+	}
 }
 
 TEST_CASE("Test that Base64Encode functions as expected")
@@ -57,6 +160,37 @@ TEST_CASE("Test that Base64Encode functions as expected")
 	{
 		REQUIRE(Oulu::Base64Encode("~~~", Oulu::BASE64_URL_TABLE) == "fn5-");
 	}
+
+	SECTION("Test that we can handle runtime-supplied Base64 tables")
+	{
+		static constexpr const auto* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789.,";
+		REQUIRE(Oulu::Base64Encode("~~~", table) == "fn5.");
+	}
+
+	SECTION("Test that we can handle alternate padding characters")
+	{
+		REQUIRE(Oulu::Base64Encode("f", nullptr, '.') == "Zg..");
+		REQUIRE(Oulu::Base64Encode("fo", nullptr, '.') == "Zm8.");
+	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		std::mt19937 rng(0x0B64);
+		std::uniform_int_distribution<int> octet(0, 255);
+		for (const auto& table : { Oulu::BASE64_TABLE, Oulu::BASE64_URL_TABLE })
+		{
+			for (size_t length = 0; length < 300; length += 5)
+			{
+				std::string data;
+				while (data.length() < length)
+					data.push_back(static_cast<char>(octet(rng)));
+
+				RequireKernelsMatch([&] { return Oulu::Base64Encode(data, table); });
+				RequireKernelsMatch([&] { return Oulu::Base64Encode(data, table, 0); });
+				REQUIRE(Oulu::Base64Decode(Oulu::Base64Encode(data, table), table) == data);
+			}
+		}
+	}
 }
 
 TEST_CASE("Test that HexDecode functions as expected")
@@ -87,6 +221,52 @@ TEST_CASE("Test that HexDecode functions as expected")
 		REQUIRE(Oulu::HexDecode("66:6f", nullptr, ':') == "fo");
 		REQUIRE(Oulu::HexDecode("66:6f:6f", nullptr, ':') == "foo");
 	}
+
+	SECTION("Test that the standard tables decode either case")
+	{
+		REQUIRE(Oulu::HexDecode("666F6f", Oulu::HEX_TABLE_LOWER) == "foo");
+		REQUIRE(Oulu::HexDecode("666F6f", Oulu::HEX_TABLE_UPPER) == "foo");
+		REQUIRE(Oulu::HexDecode("666F6f", "0123456789abcdef") == std::string("f\x60o", 3));
+	}
+
+	SECTION("Test that we can detect malformed data")
+	{
+		std::string buffer;
+		REQUIRE(Oulu::HexDecodeTo(buffer, "666f6f"));
+		REQUIRE(Oulu::HexDecodeTo(buffer, "66:6f:6f", Oulu::HEX_TABLE_LOWER, ':'));
+		REQUIRE(Oulu::HexDecodeTo(buffer, ""));
+		REQUIRE(!Oulu::HexDecodeTo(buffer, "666g6f"));
+		REQUIRE(!Oulu::HexDecodeTo(buffer, "666f6"));
+		REQUIRE(!Oulu::HexDecodeTo(buffer, "66:6f:", Oulu::HEX_TABLE_LOWER, ':'));
+		REQUIRE(!Oulu::HexDecodeTo(buffer, "66-6f", Oulu::HEX_TABLE_LOWER, ':'));
+
+		std::array<char, 3> octets;
+		REQUIRE(Oulu::HexDecodeTo(octets, "666f6f") == 3);
+		REQUIRE(!Oulu::HexDecodeTo(octets, "666g6f"));
+	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		std::mt19937 rng(0x0416);
+		for (const char separator : { '\0', ':' })
+		{
+			for (size_t length = 0; length < 200; length += 3)
+			{
+				const auto valid = Oulu::HexEncode(RandomString(rng, length, "abcdefghijklmnopqrstuvwxyz"), Oulu::HEX_TABLE_UPPER, separator);
+				const auto mixed = RandomString(rng, valid.length(), "0123456789abcdefABCDEF");
+				const auto noisy = RandomString(rng, valid.length(), "0123456789abcdefABCDEFXYZ:");
+				for (const auto& data : { valid, mixed, noisy })
+				{
+					RequireKernelsMatch([&] {
+						std::string buffer;
+						const auto well_formed = Oulu::HexDecodeTo(buffer, data, Oulu::HEX_TABLE_LOWER, separator);
+						return std::make_pair(buffer, well_formed);
+					});
+				}
+				REQUIRE(Oulu::HexEncode(Oulu::HexDecode(valid, Oulu::HEX_TABLE_LOWER, separator), Oulu::HEX_TABLE_UPPER, separator) == valid);
+			}
+		}
+	}
 }
 
 TEST_CASE("Test that HexEncode functions as expected")
@@ -117,6 +297,24 @@ TEST_CASE("Test that HexEncode functions as expected")
 		REQUIRE(Oulu::HexEncode("fo", nullptr, ':') == "66:6f");
 		REQUIRE(Oulu::HexEncode("foo", nullptr, ':') == "66:6f:6f");
 	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		std::mt19937 rng(0x0416);
+		std::uniform_int_distribution<int> octet(0, 255);
+		for (size_t length = 0; length < 200; length += 3)
+		{
+			std::string data;
+			while (data.length() < length)
+				data.push_back(static_cast<char>(octet(rng)));
+
+			for (const auto& table : { Oulu::HEX_TABLE_LOWER, Oulu::HEX_TABLE_UPPER })
+			{
+				RequireKernelsMatch([&] { return Oulu::HexEncode(data, table); });
+				RequireKernelsMatch([&] { return Oulu::HexEncode(data, table, ':'); });
+			}
+		}
+	}
 }
 
 TEST_CASE("Test that PercentDecode functions as expected")
@@ -133,6 +331,18 @@ TEST_CASE("Test that PercentDecode functions as expected")
 	{
 		REQUIRE(Oulu::PercentDecode("foo%20bar", 6) == "foo ");
 	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		std::mt19937 rng(0x0025);
+		for (size_t length = 0; length < 300; length += 7)
+		{
+			const auto sparse = RandomString(rng, length, "abcdefghijklmnopqrstuvwxyz0123456789%");
+			const auto dense = RandomString(rng, length, "%%%2aF");
+			for (const auto& data : { sparse, dense })
+				RequireKernelsMatch([&] { return Oulu::PercentDecode(data); });
+		}
+	}
 }
 
 TEST_CASE("Test that PercentEncode functions as expected")
@@ -161,4 +371,486 @@ TEST_CASE("Test that PercentEncode functions as expected")
 	{
 		REQUIRE(Oulu::PercentEncode("foo?", nullptr, false) == "foo%3f");
 	}
+
+	SECTION("Test that the SIMD kernels match the scalar implementation")
+	{
+		static constexpr Oulu::CharacterSet ascii_table("abc ~\x7f");
+		static constexpr Oulu::CharacterSet binary_table("abc\x80\xff");
+
+		std::mt19937 rng(0x0025);
+		std::uniform_int_distribution<int> octet(0, 255);
+		for (size_t length = 0; length < 300; length += 7)
+		{
+			std::string binary;
+			while (binary.length() < length)
+				binary.push_back(static_cast<char>(octet(rng)));
+
+			const auto sparse = RandomString(rng, length, "abcdefghijklmnopqrstuvwxyz0123456789 ");
+			const auto dense = RandomString(rng, length, "abc?& \x80\xff");
+			for (const auto& data : { binary, sparse, dense })
+			{
+				RequireKernelsMatch([&] { return Oulu::PercentEncode(data); });
+				RequireKernelsMatch([&] { return Oulu::PercentEncode(data, Oulu::PERCENT_TABLE, false); });
+				RequireKernelsMatch([&] { return Oulu::PercentEncode(data, ascii_table); });
+				RequireKernelsMatch([&] { return Oulu::PercentEncode(data, binary_table); });
+				REQUIRE(Oulu::PercentDecode(Oulu::PercentEncode(data)) == data);
+			}
+		}
+	}
+}
+
+TEST_CASE("Test that the length helpers function as expected")
+{
+	SECTION("Test that the Base64 lengths match the actual output")
+	{
+		for (size_t length = 0; length < 16; ++length)
+		{
+			const std::string data(length, 'x');
+			REQUIRE(Oulu::Base64EncodedLength(length) == Oulu::Base64Encode(data).length());
+			REQUIRE(Oulu::Base64EncodedLength(length, 0) == Oulu::Base64Encode(data, nullptr, 0).length());
+			REQUIRE(Oulu::Base64DecodedLength(Oulu::Base64EncodedLength(length, 0)) == length);
+		}
+	}
+
+	SECTION("Test that the hex lengths match the actual output")
+	{
+		for (size_t length = 0; length < 16; ++length)
+		{
+			const std::string data(length, 'x');
+			REQUIRE(Oulu::HexEncodedLength(length) == Oulu::HexEncode(data).length());
+			REQUIRE(Oulu::HexEncodedLength(length, ':') == Oulu::HexEncode(data, nullptr, ':').length());
+			REQUIRE(Oulu::HexDecodedLength(Oulu::HexEncodedLength(length)) == length);
+			REQUIRE(Oulu::HexDecodedLength(Oulu::HexEncodedLength(length, ':'), ':') == length);
+		}
+	}
+
+	SECTION("Test that the lengths can be used for sizing buffers at compile time")
+	{
+		static_assert(Oulu::Base64EncodedLength(32) == 44);
+		static_assert(Oulu::Base64EncodedLength(32, 0) == 43);
+		static_assert(Oulu::Base64DecodedLength(44) == 33);
+		static_assert(Oulu::HexEncodedLength(32) == 64);
+		static_assert(Oulu::HexEncodedLength(32, ':') == 95);
+		static_assert(Oulu::PercentEncodedLength(10) == 30);
+	}
+}
+
+TEST_CASE("Test that the To variants function as expected")
+{
+	SECTION("Test that we can append to an existing string")
+	{
+		std::string buffer = "prefix:";
+		Oulu::Base64EncodeTo(buffer, "foo");
+		REQUIRE(buffer == "prefix:Zm9v");
+
+		Oulu::Base64DecodeTo(buffer, "Zm9v");
+		REQUIRE(buffer == "prefix:Zm9vfoo");
+
+		Oulu::HexEncodeTo(buffer, "f", Oulu::HEX_TABLE_UPPER);
+		REQUIRE(buffer == "prefix:Zm9vfoo66");
+
+		Oulu::HexDecodeTo(buffer, "66:6f", Oulu::HEX_TABLE_LOWER, ':');
+		REQUIRE(buffer == "prefix:Zm9vfoo66fo");
+
+		Oulu::PercentEncodeTo(buffer, " ");
+		REQUIRE(buffer == "prefix:Zm9vfoo66fo%20");
+
+		Oulu::PercentDecodeTo(buffer, "%3f");
+		REQUIRE(buffer == "prefix:Zm9vfoo66fo%20?");
+	}
+
+	SECTION("Test that we can write to a caller-provided buffer")
+	{
+		std::array<char, Oulu::Base64EncodedLength(6)> encoded;
+		REQUIRE(Oulu::Base64EncodeTo(encoded, "foobar") == encoded.size());
+		REQUIRE(std::string_view(encoded.data(), encoded.size()) == "Zm9vYmFy");
+
+		std::array<char, Oulu::Base64DecodedLength(8)> decoded;
+		REQUIRE(Oulu::Base64DecodeTo(decoded, "Zm9vYmFy") == 6);
+		REQUIRE(std::string_view(decoded.data(), 6) == "foobar");
+
+		std::array<char, Oulu::HexEncodedLength(3, ':')> hex;
+		REQUIRE(Oulu::HexEncodeTo(hex, "foo", Oulu::HEX_TABLE_LOWER, ':') == hex.size());
+		REQUIRE(std::string_view(hex.data(), hex.size()) == "66:6f:6f");
+
+		std::array<char, Oulu::PercentEncodedLength(4)> percent;
+		REQUIRE(Oulu::PercentEncodeTo(percent, "foo?") == 6);
+		REQUIRE(std::string_view(percent.data(), 6) == "foo%3F");
+	}
+
+	SECTION("Test that we reject caller-provided buffers which are too small")
+	{
+		std::array<char, 4> buffer;
+		REQUIRE(!Oulu::Base64EncodeTo(buffer, "foobar"));
+		REQUIRE(!Oulu::HexEncodeTo(buffer, "foobar"));
+		REQUIRE(!Oulu::PercentEncodeTo(buffer, "foobar"));
+		REQUIRE(!Oulu::PercentDecodeTo(buffer, "foobar"));
+	}
+
+	SECTION("Test that we can write through an output iterator")
+	{
+		std::string buffer;
+		Oulu::Base64EncodeTo(std::back_inserter(buffer), "fo", Oulu::BASE64_TABLE, 0);
+		REQUIRE(buffer == "Zm8");
+
+		buffer.clear();
+		Oulu::Base64DecodeTo(std::back_inserter(buffer), "fn5-", Oulu::BASE64_URL_TABLE);
+		REQUIRE(buffer == "~~~");
+
+		buffer.clear();
+		Oulu::HexDecodeTo(std::back_inserter(buffer), "666F6F", Oulu::HEX_TABLE_UPPER);
+		REQUIRE(buffer == "foo");
+
+		buffer.clear();
+		Oulu::PercentEncodeTo(std::back_inserter(buffer), "foo bar?", Oulu::PERCENT_TABLE, false);
+		REQUIRE(buffer == "foo%20bar%3f");
+	}
+}
+
+TEST_CASE("Test that the polymorphic allocator variants function as expected")
+{
+	// Fail any allocation which does not come from the stack buffer.
+	std::array<std::byte, 1024> storage;
+	std::pmr::monotonic_buffer_resource resource(storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+	SECTION("Test that we can encode and decode into a polymorphic allocator")
+	{
+		const auto base64 = Oulu::Base64Encode("foobar", &resource);
+		REQUIRE(base64 == "Zm9vYmFy");
+		REQUIRE(base64.get_allocator().resource() == &resource);
+		REQUIRE(Oulu::Base64Decode(base64, &resource) == "foobar");
+		REQUIRE(Oulu::Base64Encode("fo", &resource, Oulu::BASE64_URL_TABLE, 0) == "Zm8");
+
+		const auto hex = Oulu::HexEncode("foo", &resource, Oulu::HEX_TABLE_UPPER, ':');
+		REQUIRE(hex == "66:6F:6F");
+		REQUIRE(hex.get_allocator().resource() == &resource);
+		REQUIRE(Oulu::HexDecode(hex, &resource, Oulu::HEX_TABLE_UPPER, ':') == "foo");
+
+		const auto percent = Oulu::PercentEncode("foo bar?", &resource);
+		REQUIRE(percent == "foo%20bar%3F");
+		REQUIRE(percent.get_allocator().resource() == &resource);
+		REQUIRE(Oulu::PercentDecode(percent, &resource) == "foo bar?");
+	}
+
+	SECTION("Test that we can append to an existing string")
+	{
+		std::pmr::string buffer("prefix:", &resource);
+		Oulu::Base64EncodeTo(buffer, "foo");
+		Oulu::Base64DecodeTo(buffer, "Zm9v");
+		Oulu::HexEncodeTo(buffer, "f", Oulu::HEX_TABLE_UPPER);
+		REQUIRE(Oulu::HexDecodeTo(buffer, "66:6f", Oulu::HEX_TABLE_LOWER, ':'));
+		Oulu::PercentEncodeTo(buffer, " ");
+		Oulu::PercentDecodeTo(buffer, "%3f");
+		REQUIRE(buffer == "prefix:Zm9vfoo66fo%20?");
+	}
+
+	SECTION("Test that a null table still selects the default table")
+	{
+		REQUIRE(Oulu::Base64Decode("Zm9v", nullptr) == "foo");
+		REQUIRE(Oulu::HexEncode("f", nullptr) == "66");
+		REQUIRE(Oulu::PercentEncode("?", nullptr) == "%3F");
+	}
+}
+
+TEST_CASE("Test that the codecs can be evaluated at compile time")
+{
+	SECTION("Test that strings can be encoded and decoded in constant expressions")
+	{
+		static_assert(Oulu::Base64Encode("foobar") == "Zm9vYmFy");
+		static_assert(Oulu::Base64Encode("fo", Oulu::BASE64_URL_TABLE, 0) == "Zm8");
+		static_assert(Oulu::Base64Decode("Zm9vYmFy") == "foobar");
+		static_assert(Oulu::Base64Decode("fn5-", "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_") == "~~~");
+
+		static_assert(Oulu::HexEncode("foo") == "666f6f");
+		static_assert(Oulu::HexEncode("foo", Oulu::HEX_TABLE_UPPER, ':') == "66:6F:6F");
+		static_assert(Oulu::HexDecode("66:6f:6F", Oulu::HEX_TABLE_LOWER, ':') == "foo");
+
+		static_assert(Oulu::PercentEncode("foo bar?") == "foo%20bar%3F");
+		static_assert(Oulu::PercentEncode("foo bar?", Oulu::PERCENT_TABLE, false) == "foo%20bar%3f");
+		static_assert(Oulu::PercentDecode("foo%20bar%3f") == "foo bar?");
+	}
+
+	SECTION("Test that constants can be encoded into fixed buffers at compile time")
+	{
+		static constexpr auto encoded = [] {
+			std::array<char, Oulu::Base64EncodedLength(6)> out = { };
+			Oulu::Base64EncodeTo(out.begin(), "foobar");
+			return out;
+		}();
+		static_assert(std::string_view(encoded.data(), encoded.size()) == "Zm9vYmFy");
+		REQUIRE(Oulu::Base64Decode(std::string_view(encoded.data(), encoded.size())) == "foobar");
+	}
+
+	SECTION("Test that the runtime and compile time results match")
+	{
+		const std::string_view data = "The quick brown fox jumps over the lazy dog?!";
+		REQUIRE(Oulu::Base64Encode(data) == Oulu::Base64Encode(data.data(), data.length()));
+		REQUIRE(Oulu::HexEncode(data) == Oulu::HexEncode(data.data(), data.length()));
+		REQUIRE(Oulu::PercentEncode(data) == Oulu::PercentEncode(data.data(), data.length()));
+
+		constexpr auto base64 = [] {
+			std::array<char, Oulu::Base64EncodedLength(45)> out = { };
+			Oulu::Base64EncodeTo(out.begin(), "The quick brown fox jumps over the lazy dog?!");
+			return out;
+		}();
+		REQUIRE(Oulu::Base64Encode(data) == std::string_view(base64.data(), base64.size()));
+	}
+}
+
+TEST_CASE("Test that the InPlace variants function as expected")
+{
+	std::mt19937 rng(8);
+	for (size_t length = 0; length < 200; length += 13)
+	{
+		const auto input = RandomString(rng, length, "abc/%\x01\xFF");
+
+		RequireKernelsMatch([&] {
+			auto buffer = Oulu::Base64Encode(input);
+			const auto decoded = Oulu::Base64DecodeInPlace(buffer);
+			REQUIRE(decoded.data() == buffer.data());
+			REQUIRE(decoded == input);
+			return std::string(decoded);
+		});
+
+		RequireKernelsMatch([&] {
+			auto buffer = Oulu::HexEncode(input, Oulu::HEX_TABLE_UPPER, ':');
+			const auto decoded = Oulu::HexDecodeInPlace(buffer, Oulu::HEX_TABLE_UPPER, ':');
+			REQUIRE(decoded);
+			REQUIRE(decoded->data() == buffer.data());
+			REQUIRE(*decoded == input);
+			return std::string(*decoded);
+		});
+
+		RequireKernelsMatch([&] {
+			auto buffer = Oulu::PercentEncode(input);
+			const auto decoded = Oulu::PercentDecodeInPlace(buffer);
+			REQUIRE(decoded.data() == buffer.data());
+			REQUIRE(decoded == input);
+			return std::string(decoded);
+		});
+	}
+
+	std::string malformed("666g6f");
+	REQUIRE(!Oulu::HexDecodeInPlace(malformed));
+}
+
+TEST_CASE("Test that the strict decoders function as expected")
+{
+	// Checks that decoding failed with the specified error at the specified position.
+	const auto require_error = [](const Oulu::DecodeResult& result, Oulu::DecodeError error, size_t position) {
+		REQUIRE(!result);
+		REQUIRE(result.error == error);
+		REQUIRE(result.position == position);
+		REQUIRE(result.data.empty());
+	};
+
+	SECTION("Test that Base64DecodeStrict accepts well formed data")
+	{
+		REQUIRE(Oulu::Base64DecodeStrict("").data == "");
+		REQUIRE(Oulu::Base64DecodeStrict("Zm9v").data == "foo");
+		REQUIRE(Oulu::Base64DecodeStrict("Zm9vYg==").data == "foob");
+		REQUIRE(Oulu::Base64DecodeStrict("Zm9vYmE=").data == "fooba");
+		REQUIRE(Oulu::Base64DecodeStrict("Zm9vYmE", Oulu::BASE64_TABLE, 0).data == "fooba");
+		REQUIRE(Oulu::Base64DecodeStrict("_-8", Oulu::BASE64_URL_TABLE, 0).data == "\xFF\xEF");
+	}
+
+	SECTION("Test that Base64DecodeStrict rejects malformed data")
+	{
+		require_error(Oulu::Base64DecodeStrict("Zm9v YmE="), Oulu::DecodeError::BAD_CHARACTER, 4);
+		require_error(Oulu::Base64DecodeStrict("Zm9vYmE=", Oulu::BASE64_TABLE, 0), Oulu::DecodeError::BAD_CHARACTER, 7);
+		require_error(Oulu::Base64DecodeStrict("Zm9vY==="), Oulu::DecodeError::BAD_PADDING, 5);
+		require_error(Oulu::Base64DecodeStrict("Zm9vYg==Zm9v"), Oulu::DecodeError::BAD_PADDING, 8);
+		require_error(Oulu::Base64DecodeStrict("Zm9vYg=A"), Oulu::DecodeError::BAD_PADDING, 7);
+		require_error(Oulu::Base64DecodeStrict("Zm9vYg="), Oulu::DecodeError::TRUNCATED, 7);
+		require_error(Oulu::Base64DecodeStrict("Zm9vYg"), Oulu::DecodeError::TRUNCATED, 6);
+		require_error(Oulu::Base64DecodeStrict("Zm9vY", Oulu::BASE64_TABLE, 0), Oulu::DecodeError::TRUNCATED, 5);
+	}
+
+	SECTION("Test that HexDecodeStrict accepts well formed data")
+	{
+		REQUIRE(Oulu::HexDecodeStrict("").data == "");
+		REQUIRE(Oulu::HexDecodeStrict("666F6f").data == "foo");
+		REQUIRE(Oulu::HexDecodeStrict("66:6f:6f", Oulu::HEX_TABLE_LOWER, ':').data == "foo");
+	}
+
+	SECTION("Test that HexDecodeStrict rejects malformed data")
+	{
+		require_error(Oulu::HexDecodeStrict("666g6f"), Oulu::DecodeError::BAD_CHARACTER, 3);
+		require_error(Oulu::HexDecodeStrict("666f6"), Oulu::DecodeError::TRUNCATED, 5);
+		require_error(Oulu::HexDecodeStrict("66:6f-6f", Oulu::HEX_TABLE_LOWER, ':'), Oulu::DecodeError::BAD_CHARACTER, 5);
+		require_error(Oulu::HexDecodeStrict("66:6f:", Oulu::HEX_TABLE_LOWER, ':'), Oulu::DecodeError::TRUNCATED, 6);
+		require_error(Oulu::HexDecodeStrict("66::6f", Oulu::HEX_TABLE_LOWER, ':'), Oulu::DecodeError::BAD_CHARACTER, 3);
+	}
+
+	SECTION("Test that PercentDecodeStrict accepts well formed data")
+	{
+		REQUIRE(Oulu::PercentDecodeStrict("").data == "");
+		REQUIRE(Oulu::PercentDecodeStrict("foo%20bar%2f").data == "foo bar/");
+	}
+
+	SECTION("Test that PercentDecodeStrict rejects malformed data")
+	{
+		require_error(Oulu::PercentDecodeStrict("foo%2gbar"), Oulu::DecodeError::BAD_CHARACTER, 5);
+		require_error(Oulu::PercentDecodeStrict("foo%g0bar"), Oulu::DecodeError::BAD_CHARACTER, 4);
+		require_error(Oulu::PercentDecodeStrict("foo%2"), Oulu::DecodeError::TRUNCATED, 5);
+		require_error(Oulu::PercentDecodeStrict("foo%"), Oulu::DecodeError::TRUNCATED, 4);
+	}
+
+	SECTION("Test that the strict decoders report truncation at the end of the data")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		const std::string data(100, 'x');
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			const auto base64 = Oulu::Base64Encode(data).substr(0, 133);
+			require_error(Oulu::Base64DecodeStrict(base64, Oulu::BASE64_TABLE, 0), Oulu::DecodeError::TRUNCATED, base64.length());
+
+			const auto hex = Oulu::HexEncode(data).substr(0, 199);
+			require_error(Oulu::HexDecodeStrict(hex), Oulu::DecodeError::TRUNCATED, hex.length());
+
+			for (const auto* suffix : { "%", "%2" })
+			{
+				const auto percent = data + suffix;
+				require_error(Oulu::PercentDecodeStrict(percent), Oulu::DecodeError::TRUNCATED, percent.length());
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+
+	SECTION("Test that the strict decoders report the same errors with and without SIMD")
+	{
+		std::mt19937 rng(7);
+		for (size_t length = 0; length < 300; length += 7)
+		{
+			const auto valid = RandomString(rng, length, "0123456789abcdefABCDEF");
+			for (const auto bad : { size_t(0), length / 2, length ? length - 1 : 0 })
+			{
+				auto data = Oulu::PercentEncode(valid);
+				if (bad < data.length())
+					data[bad] = '!';
+
+				RequireKernelsMatch([&] {
+					const auto base64 = Oulu::Base64DecodeStrict(data, Oulu::BASE64_TABLE, 0);
+					const auto hex = Oulu::HexDecodeStrict(data);
+					const auto percent = Oulu::PercentDecodeStrict(data);
+					return std::make_tuple(base64.data, base64.error, base64.position, hex.data, hex.error,
+						hex.position, percent.data, percent.error, percent.position);
+				});
+
+				auto corrupt = Oulu::Base64Encode(valid);
+				if (bad < corrupt.length())
+					corrupt[bad] = '*';
+
+				RequireKernelsMatch([&] {
+					const auto result = Oulu::Base64DecodeStrict(corrupt);
+					return std::make_tuple(result.data, result.error, result.position);
+				});
+
+				auto hex = Oulu::HexEncode(valid, Oulu::HEX_TABLE_LOWER, ':');
+				if (bad < hex.length())
+					hex[bad] = 'x';
+
+				RequireKernelsMatch([&] {
+					const auto result = Oulu::HexDecodeStrict(hex, Oulu::HEX_TABLE_LOWER, ':');
+					return std::make_tuple(result.data, result.error, result.position);
+				});
+			}
+		}
+	}
+}
+
+TEST_CASE("Test that Base64Decoder functions as expected")
+{
+	SECTION("Test that decoding in chunks matches decoding all at once")
+	{
+		std::mt19937 rng(0x0B64);
+		const auto data = RandomString(rng, 1000, std::string(Oulu::BASE64_TABLE.GetCharacters()) + "=");
+		const auto expected = Oulu::Base64Decode(data);
+
+		for (const size_t chunk_size : { 1, 2, 3, 5, 7, 64, 400 })
+		{
+			Oulu::Base64Decoder decoder;
+			std::string actual;
+			for (size_t idx = 0; idx < data.length(); idx += chunk_size)
+				decoder.Update(actual, std::string_view(data).substr(idx, chunk_size));
+			decoder.Final();
+			REQUIRE(actual == expected);
+		}
+	}
+
+	SECTION("Test that we can decode into a caller-provided buffer")
+	{
+		Oulu::Base64Decoder decoder(Oulu::BASE64_URL_TABLE);
+		std::array<char, Oulu::Base64Decoder::MaxUpdateLength(2)> buffer;
+		REQUIRE(decoder.Update(buffer, "fn") == 1);
+		REQUIRE(buffer[0] == '~');
+		REQUIRE(decoder.Update(buffer, "5-") == 2);
+		REQUIRE(std::string_view(buffer.data(), 2) == "~~");
+		REQUIRE(decoder.Final());
+	}
+
+	SECTION("Test that we detect data which ends on an invalid boundary")
+	{
+		Oulu::Base64Decoder decoder;
+		std::string buffer;
+		decoder.Update(buffer, "Zm9vY");
+		REQUIRE(!decoder.Final());
+
+		decoder.Update(buffer, "Zm8=");
+		REQUIRE(decoder.Final());
+		REQUIRE(buffer == "foofo");
+	}
+}
+
+TEST_CASE("Test that Base64Encoder functions as expected")
+{
+	SECTION("Test that encoding in chunks matches encoding all at once")
+	{
+		std::mt19937 rng(0x0B64);
+		std::uniform_int_distribution<int> octet(0, 255);
+		std::string data;
+		while (data.length() < 1000)
+			data.push_back(static_cast<char>(octet(rng)));
+
+		for (const size_t chunk_size : { 1, 2, 3, 5, 7, 64, 400 })
+		{
+			for (const char padding : { '=', '\0' })
+			{
+				Oulu::Base64Encoder encoder(Oulu::BASE64_TABLE, padding);
+				std::string actual;
+				for (size_t idx = 0; idx < data.length(); idx += chunk_size)
+					encoder.Update(actual, std::string_view(data).substr(idx, chunk_size));
+				encoder.Final(actual);
+				REQUIRE(actual == Oulu::Base64Encode(data, Oulu::BASE64_TABLE, padding));
+			}
+		}
+	}
+
+	SECTION("Test that we can split the encoded form into lines")
+	{
+		Oulu::Base64Encoder encoder(Oulu::BASE64_TABLE, '=', 4);
+		std::vector<std::string> lines;
+		const auto callback = [&lines](std::string_view line) { lines.emplace_back(line); };
+
+		encoder.Update("foob", callback);
+		REQUIRE(lines == std::vector<std::string>{ "Zm9v" });
+
+		encoder.Update("ar!", callback);
+		encoder.Final(callback);
+		REQUIRE(lines == std::vector<std::string>{ "Zm9v", "YmFy", "IQ==" });
+	}
+
+	SECTION("Test that no final line is emitted when the last line was full")
+	{
+		Oulu::Base64Encoder encoder(Oulu::BASE64_TABLE, '=', 4);
+		size_t count = 0;
+		const auto callback = [&count](std::string_view line) { REQUIRE(line.length() == 4); count++; };
+
+		encoder.Update("foobar", callback);
+		encoder.Final(callback);
+		REQUIRE(count == 2);
+	}
 }
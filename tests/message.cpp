@@ -1,9 +1,149 @@
 // Oulu <https://github.com/inspircd/liboulu/>
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include <oulu/encoding.hpp>
 #include <oulu/message.hpp>
+#include <oulu/simd.hpp>
+
+namespace
+{
+	// Unescapes a string from the IRCv3 tag format one character at a time.
+	std::string ReferenceUnescapeTag(std::string_view str)
+	{
+		std::string ret;
+		for (size_t idx = 0; idx < str.length(); ++idx)
+		{
+			if (str[idx] != '\\')
+			{
+				ret.push_back(str[idx]);
+				continue;
+			}
+
+			if (++idx == str.length())
+				break;
+
+			switch (str[idx])
+			{
+				case 's':
+					ret.push_back(' ');
+					break;
+				case ':':
+					ret.push_back(';');
+					break;
+				case 'n':
+					ret.push_back('\n');
+					break;
+				case 'r':
+					ret.push_back('\r');
+					break;
+				default:
+					ret.push_back(str[idx]);
+					break;
+			}
+		}
+		return ret;
+	}
+
+	// Splits a message into tokens using the same rules as MessageTokenizer::GetTrailing.
+	std::vector<std::string_view> ReferenceTokenize(std::string_view message)
+	{
+		std::vector<std::string_view> tokens;
+		while (!message.empty())
+		{
+			if (message.front() == ':')
+			{
+				tokens.push_back(message.substr(1));
+				break;
+			}
+
+			const auto separator = message.find(' ');
+			tokens.push_back(message.substr(0, separator));
+
+			const auto next = message.find_first_not_of(' ', separator);
+			message = next == std::string_view::npos ? std::string_view() : message.substr(next);
+		}
+		return tokens;
+	}
+}
+
+TEST_CASE("Test that ClassifyBody functions as expected")
+{
+	SECTION("Test that we can classify CTCPs")
+	{
+		auto classification = Oulu::ClassifyBody("\1ACTION waves\1");
+		REQUIRE(classification.ctcp);
+		REQUIRE(classification.action);
+		REQUIRE(classification.ctcp_name == "ACTION");
+		REQUIRE(classification.ctcp_body == "waves");
+		REQUIRE(!classification.control);
+		REQUIRE(!classification.formatting);
+
+		classification = Oulu::ClassifyBody("\1VERSION");
+		REQUIRE(classification.ctcp);
+		REQUIRE(!classification.action);
+		REQUIRE(classification.ctcp_name == "VERSION");
+		REQUIRE(!classification.control);
+
+		classification = Oulu::ClassifyBody("hello \1world\1");
+		REQUIRE(!classification.ctcp);
+		REQUIRE(classification.ctcp_name.empty());
+		REQUIRE(classification.control);
+	}
+
+	SECTION("Test that we can find formatting codes and control characters")
+	{
+		auto classification = Oulu::ClassifyBody("hello world");
+		REQUIRE(!classification.ctcp);
+		REQUIRE(!classification.control);
+		REQUIRE(!classification.formatting);
+
+		classification = Oulu::ClassifyBody("\1ACTION \x02waves\x02\1");
+		REQUIRE(classification.action);
+		REQUIRE(classification.formatting);
+		REQUIRE(!classification.control);
+
+		classification = Oulu::ClassifyBody("hello \x07world\x7F");
+		REQUIRE(classification.control);
+		REQUIRE(!classification.formatting);
+	}
+
+	SECTION("Test that we find characters in every position")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			for (size_t length = 1; length < 200; length += 7)
+			{
+				for (size_t position = 0; position < length; ++position)
+				{
+					for (const auto chr : { '\x03', '\x0F', '\x1F', '\x00', '\x07', '\x7F' })
+					{
+						std::string body(length, '\xC1');
+						body[position] = chr;
+
+						const auto classification = Oulu::ClassifyBody(body);
+						const auto formatting = chr == '\x03' || chr == '\x0F' || chr == '\x1F';
+						REQUIRE(classification.formatting == formatting);
+						REQUIRE(classification.control == !formatting);
+					}
+				}
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+}
 
 TEST_CASE("Test that EscapeTag functions as expected")
 {
@@ -14,6 +154,48 @@ TEST_CASE("Test that EscapeTag functions as expected")
 	REQUIRE(Oulu::EscapeTag("foo\nbar") == "foo\\nbar");
 }
 
+TEST_CASE("Test that EscapeTag(str, buffer) functions as expected")
+{
+	std::string buffer;
+
+	SECTION("Test that the input is returned when nothing needs escaping")
+	{
+		const std::string_view clean = "2024-01-01T00:00:00.000Z";
+		const auto escaped = Oulu::EscapeTag(clean, buffer);
+		REQUIRE(escaped.data() == clean.data());
+		REQUIRE(buffer.empty());
+	}
+
+	SECTION("Test that we match EscapeTag with every special character at every position")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			for (size_t length = 1; length < 150; length += 11)
+			{
+				for (size_t position = 0; position < length; ++position)
+				{
+					for (const auto chr : { ' ', ';', '\\', '\n', '\r' })
+					{
+						std::string str(length, 'a');
+						str[position] = chr;
+
+						const auto escaped = Oulu::EscapeTag(str, buffer);
+						REQUIRE(escaped.data() == buffer.data());
+						REQUIRE(escaped == Oulu::EscapeTag(str));
+						REQUIRE(escaped.length() == length + 1);
+						REQUIRE(Oulu::UnescapeTag(escaped) == str);
+					}
+				}
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+}
+
 TEST_CASE("Test that IsCTCP functions as expected")
 {
 	SECTION("Test that we can handle valid CTCPs")
@@ -138,6 +320,44 @@ TEST_CASE("Test that ParseCTCP(name, body) functions as expected")
 	}
 }
 
+TEST_CASE("Test that StripFormatting functions as expected")
+{
+	SECTION("Test that we can strip formatting codes")
+	{
+		REQUIRE(Oulu::StripFormatting("\x02\x1D\x1F\x1E\x11\x16hello\x0F world") == "hello world");
+		REQUIRE(Oulu::StripFormatting("\x03" "4red\x03" "04,12red on blue\x03 plain") == "redred on blue plain");
+		REQUIRE(Oulu::StripFormatting("\x03" "123") == "3");
+		REQUIRE(Oulu::StripFormatting("\x03" ",5") == ",5");
+		REQUIRE(Oulu::StripFormatting("\x03" "5,") == ",");
+		REQUIRE(Oulu::StripFormatting("\x03" "5,123") == "3");
+		REQUIRE(Oulu::StripFormatting("\x04" "FF00aa,00ff00hex") == "hex");
+		REQUIRE(Oulu::StripFormatting("\x04" "FF00aa,00ffhex") == ",00ffhex");
+		REQUIRE(Oulu::StripFormatting("\x04" "FF00hex") == "FF00hex");
+	}
+
+	SECTION("Test that we leave other characters alone")
+	{
+		REQUIRE(Oulu::StripFormatting("") == "");
+		REQUIRE(Oulu::StripFormatting("hello world") == "hello world");
+		REQUIRE(Oulu::StripFormatting("\1ACTION \x07waves\1") == "\1ACTION \x07waves\1");
+	}
+
+	SECTION("Test that we can strip formatting codes in place")
+	{
+		std::string body;
+		std::string expected;
+		for (size_t idx = 0; idx < 300; ++idx)
+		{
+			body.append("\x03" "12,3text").append(idx % 2 ? "\x02" : "\x07");
+			expected.append("text").append(idx % 2 ? "" : "\x07");
+		}
+
+		const auto stripped = Oulu::StripFormattingInPlace(body);
+		REQUIRE(stripped.data() == body.data());
+		REQUIRE(stripped == expected);
+	}
+}
+
 TEST_CASE("Test that UnescapeTag functions as expected")
 {
 	REQUIRE(Oulu::UnescapeTag("foo\\:bar") == "foo;bar");
@@ -148,6 +368,108 @@ TEST_CASE("Test that UnescapeTag functions as expected")
 	REQUIRE(Oulu::UnescapeTag("foobar\\") == "foobar");
 }
 
+TEST_CASE("Test that UnescapeTag(str, buffer) functions as expected")
+{
+	std::string buffer;
+
+	SECTION("Test that the input is returned when nothing needs unescaping")
+	{
+		const std::string_view clean = "2024-01-01T00:00:00.000Z";
+		const auto unescaped = Oulu::UnescapeTag(clean, buffer);
+		REQUIRE(unescaped.data() == clean.data());
+		REQUIRE(buffer.empty());
+	}
+
+	SECTION("Test that we match UnescapeTag with escapes at every position")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			for (size_t length = 1; length < 150; length += 11)
+			{
+				for (size_t position = 0; position < length; ++position)
+				{
+					for (const auto* escape : { "\\s", "\\:", "\\\\", "\\\\\\\\", "\\x", "\\" })
+					{
+						auto str = std::string(length, 'a').insert(position, escape);
+						const auto expected = ReferenceUnescapeTag(str);
+						REQUIRE(Oulu::UnescapeTag(std::string_view(str)) == expected);
+
+						const auto unescaped = Oulu::UnescapeTag(str, buffer);
+						REQUIRE(unescaped.data() == buffer.data());
+						REQUIRE(unescaped == expected);
+
+						auto in_place = str;
+						REQUIRE(Oulu::UnescapeTagInPlace(in_place) == expected);
+					}
+				}
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+}
+
+TEST_CASE("Test that UnescapeTagInPlace functions as expected")
+{
+	for (const auto* escaped : { "foo\\:bar", "foo\\sbar", "foo\\\\bar", "foo\\rbar", "foo\\nbar", "foobar\\", "foobar", "" })
+	{
+		std::string buffer(escaped);
+		const auto unescaped = Oulu::UnescapeTagInPlace(buffer);
+		REQUIRE(unescaped.data() == buffer.data());
+		REQUIRE(unescaped == Oulu::UnescapeTag(escaped));
+	}
+}
+
+TEST_CASE("Test that the header-inline functions can be evaluated at compile time")
+{
+	SECTION("Test that MessageTokenizer can be used in constant expressions")
+	{
+		static_assert([] {
+			Oulu::MessageTokenizer tokenizer("PRIVMSG  #chan :hello world");
+			std::string_view token;
+			return tokenizer.GetMiddle(token) && token == "PRIVMSG"
+				&& tokenizer.GetMiddle(token) && token == "#chan"
+				&& tokenizer.GetTrailing(token) && token == "hello world"
+				&& !tokenizer.GetTrailing(token) && token.empty();
+		}());
+
+		static_assert([] {
+			std::array<std::string_view, 4> tokens;
+			Oulu::MessageTokenizer tokenizer("JOIN #a,#b key :trailing token");
+			return tokenizer.TokenizeAll(tokens) == 4 && tokens[0] == "JOIN" && tokens[3] == "trailing token";
+		}());
+	}
+
+	SECTION("Test that the CTCP helpers can be used in constant expressions")
+	{
+		static_assert(Oulu::IsCTCP("\x01" "ACTION waves\x01"));
+		static_assert(!Oulu::IsCTCP("\x01 ACTION"));
+
+		static_assert([] {
+			std::string_view name;
+			std::string_view body;
+			return Oulu::ParseCTCP("\x01" "ACTION  waves\x01", name, body) && name == "ACTION" && body == "waves";
+		}());
+	}
+
+	SECTION("Test that tags can be escaped and unescaped in constant expressions")
+	{
+		static_assert(Oulu::EscapeTag("foo bar;baz\\") == "foo\\sbar\\:baz\\\\");
+		static_assert(Oulu::UnescapeTag("foo\\sbar\\:baz\\\\\\") == "foo bar;baz\\");
+
+		static constexpr auto escaped = [] {
+			std::array<char, 8> out = { };
+			Oulu::EscapeTagTo(out.begin(), "a b\r\n");
+			return out;
+		}();
+		static_assert(std::string_view(escaped.data(), escaped.size()) == "a\\sb\\r\\n");
+		REQUIRE(Oulu::UnescapeTag(std::string_view(escaped.data(), escaped.size())) == "a b\r\n");
+	}
+}
+
 TEST_CASE("Test that MessageTokenizer functions as expected")
 {
 	const auto* message = "this is :a test";
@@ -190,4 +512,748 @@ TEST_CASE("Test that MessageTokenizer functions as expected")
 		REQUIRE(!tokenizer.GetTrailing(sv));
 		REQUIRE(sv.empty());
 	}
+
+	SECTION("Test that trailing spaces are ignored")
+	{
+		Oulu::MessageTokenizer tokenizer("this is  ");
+		std::string_view sv;
+
+		REQUIRE(tokenizer.GetMiddle(sv));
+		REQUIRE(sv == "this");
+
+		REQUIRE(tokenizer.GetMiddle(sv));
+		REQUIRE(sv == "is");
+
+		REQUIRE(!tokenizer.GetMiddle(sv));
+		REQUIRE(sv.empty());
+	}
+}
+
+TEST_CASE("Test that MessageTokenizer::TokenizeAll functions as expected")
+{
+	SECTION("Test that TokenizeAll and GetTrailing match the reference tokenizer")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+
+		std::mt19937 rng(11);
+		std::uniform_int_distribution<size_t> dist(0, 7);
+		for (size_t length = 0; length < 300; ++length)
+		{
+			std::string message;
+			while (message.length() < length)
+				message.push_back(" :ab   c"[dist(rng)]);
+
+			for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+			{
+				if (!Oulu::SIMD::SetLevel(level))
+					continue;
+
+				const auto expected = ReferenceTokenize(message);
+
+				std::vector<std::string_view> trailing;
+				Oulu::MessageTokenizer trailing_tokenizer(message);
+				for (std::string_view token; trailing_tokenizer.GetTrailing(token); )
+					trailing.push_back(token);
+				REQUIRE(trailing == expected);
+
+				std::array<std::string_view, 512> tokens;
+				Oulu::MessageTokenizer bulk_tokenizer(message);
+				const auto count = bulk_tokenizer.TokenizeAll(tokens);
+				REQUIRE(std::vector<std::string_view>(tokens.begin(), tokens.begin() + count) == expected);
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+
+	SECTION("Test that TokenizeAll matches the reference tokenizer when tokens cross blocks")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+
+		// Use long runs of separators and few colons so tokens start and end in different blocks.
+		std::mt19937 rng(1459);
+		for (size_t iteration = 0; iteration < 2000; ++iteration)
+		{
+			std::string message;
+			const auto length = rng() % 400;
+			while (message.length() < length)
+			{
+				if (rng() % 200 == 0)
+					message.push_back(':');
+				message.append(rng() % 80, rng() % 2 ? ' ' : 'a');
+				message.push_back(rng() % 2 ? ' ' : 'b');
+			}
+
+			for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+			{
+				if (!Oulu::SIMD::SetLevel(level))
+					continue;
+
+				const auto expected = ReferenceTokenize(message);
+
+				std::array<std::string_view, 512> tokens;
+				Oulu::MessageTokenizer bulk_tokenizer(message);
+				const auto count = bulk_tokenizer.TokenizeAll(tokens);
+				REQUIRE(std::vector<std::string_view>(tokens.begin(), tokens.begin() + count) == expected);
+
+				// Reading a few tokens at a time must give the same tokens.
+				for (const size_t capacity : { 1, 2, 3 })
+				{
+					std::vector<std::string_view> chunked;
+					Oulu::MessageTokenizer chunked_tokenizer(message);
+					while (const auto chunk = chunked_tokenizer.TokenizeAll(std::span(tokens.data(), capacity)))
+						chunked.insert(chunked.end(), tokens.begin(), tokens.begin() + chunk);
+					REQUIRE(chunked == expected);
+				}
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+
+	SECTION("Test that TokenizeAll handles a token which ends in an earlier block than the next starts")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		const auto message = std::string(10, 'a') + std::string(60, ' ') + "b c";
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			std::array<std::string_view, 8> tokens;
+			Oulu::MessageTokenizer tokenizer(message);
+			REQUIRE(tokenizer.TokenizeAll(tokens) == 3);
+			REQUIRE(tokens[0] == "aaaaaaaaaa");
+			REQUIRE(tokens[1] == "b");
+			REQUIRE(tokens[2] == "c");
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
+
+	SECTION("Test that TokenizeAll does not write past the array after a leading separator")
+	{
+		Oulu::MessageTokenizer tokenizer(" a b");
+		std::array<std::string_view, 1> tokens;
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 1);
+		REQUIRE(tokens[0].empty());
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 1);
+		REQUIRE(tokens[0] == "a");
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 1);
+		REQUIRE(tokens[0] == "b");
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 0);
+	}
+
+	SECTION("Test that TokenizeAll stops when the array is full")
+	{
+		Oulu::MessageTokenizer tokenizer("this  is :a test");
+		std::array<std::string_view, 2> tokens;
+		std::string_view sv;
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 2);
+		REQUIRE(tokens[0] == "this");
+		REQUIRE(tokens[1] == "is");
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 1);
+		REQUIRE(tokens[0] == "a test");
+
+		REQUIRE(tokenizer.TokenizeAll(tokens) == 0);
+		REQUIRE(!tokenizer.GetTrailing(sv));
+	}
+}
+
+TEST_CASE("Test that ParsedMessage functions as expected")
+{
+	Oulu::ParsedMessage message;
+
+	SECTION("Test that we can parse parameters which cross blocks")
+	{
+		for (const size_t length : { 45, 50 })
+		{
+			const auto nick = std::string(length, 'n');
+			const auto line = "MODE #channel +oo " + nick + " nick2";
+			REQUIRE(message.Parse(line));
+			REQUIRE(message.GetParams().size() == 4);
+			REQUIRE(message.GetParams()[2] == nick);
+			REQUIRE(message.GetParams()[3] == "nick2");
+		}
+	}
+
+	SECTION("Test that we can parse a message with all components")
+	{
+		REQUIRE(message.Parse("@msgid=foo;+bar :nick!user@host PRIVMSG #chan :hello world"));
+		REQUIRE(message.GetTags() == "msgid=foo;+bar");
+		REQUIRE(message.GetSource() == "nick!user@host");
+		REQUIRE(message.GetNick() == "nick");
+		REQUIRE(message.GetUser() == "user");
+		REQUIRE(message.GetHost() == "host");
+		REQUIRE(message.GetCommand() == "PRIVMSG");
+		REQUIRE(message.GetParams().size() == 2);
+		REQUIRE(message.GetParams()[0] == "#chan");
+		REQUIRE(message.GetParams()[1] == "hello world");
+	}
+
+	SECTION("Test that we can parse a message with no tags or source")
+	{
+		REQUIRE(message.Parse("PING  irc.example.com"));
+		REQUIRE(message.GetTags().empty());
+		REQUIRE(message.GetSource().empty());
+		REQUIRE(message.GetCommand() == "PING");
+		REQUIRE(message.GetParams().size() == 1);
+		REQUIRE(message.GetParams()[0] == "irc.example.com");
+
+		REQUIRE(message.Parse("QUIT"));
+		REQUIRE(message.GetCommand() == "QUIT");
+		REQUIRE(message.GetParams().empty());
+	}
+
+	SECTION("Test that we can split partial sources")
+	{
+		REQUIRE(message.Parse(":irc.example.com NOTICE * :hi"));
+		REQUIRE(message.GetNick() == "irc.example.com");
+		REQUIRE(message.GetUser().empty());
+		REQUIRE(message.GetHost().empty());
+
+		REQUIRE(message.Parse(":nick@host JOIN #chan"));
+		REQUIRE(message.GetNick() == "nick");
+		REQUIRE(message.GetUser().empty());
+		REQUIRE(message.GetHost() == "host");
+
+		REQUIRE(message.Parse(":nick!user JOIN #chan"));
+		REQUIRE(message.GetNick() == "nick");
+		REQUIRE(message.GetUser() == "user");
+		REQUIRE(message.GetHost().empty());
+	}
+
+	SECTION("Test that extra parameters are merged into the last one")
+	{
+		REQUIRE(message.Parse("CMD 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 :17 18"));
+		REQUIRE(message.GetParams().size() == Oulu::ParsedMessage::MAX_PARAMS);
+		REQUIRE(message.GetParams()[13] == "14");
+		REQUIRE(message.GetParams()[14] == "15 16 :17 18");
+	}
+
+	SECTION("Test that we reject messages without a command")
+	{
+		REQUIRE(!message.Parse(""));
+		REQUIRE(!message.Parse("@tags"));
+		REQUIRE(!message.Parse("@tags :source"));
+		REQUIRE(!message.Parse(" PRIVMSG"));
+		REQUIRE(message.GetCommand().empty());
+		REQUIRE(message.GetParams().empty());
+	}
+}
+
+TEST_CASE("Test that TagView functions as expected")
+{
+	SECTION("Test that we can look up tags")
+	{
+		Oulu::TagView tags("msgid=abc;time=2024-01-01T00:00:00.000Z;+draft/reply=def;solanum.chat/oper;label=");
+
+		REQUIRE(tags.Get("msgid") == "abc");
+		REQUIRE(tags.Get("time") == "2024-01-01T00:00:00.000Z");
+		REQUIRE(tags.Get("+draft/reply") == "def");
+		REQUIRE(tags.Get("solanum.chat/oper") == "");
+		REQUIRE(tags.Get("label") == "");
+		REQUIRE(!tags.Get("batch"));
+		REQUIRE(!tags.Get("draft/reply"));
+		REQUIRE(!tags.Find("msg"));
+	}
+
+	SECTION("Test that values without escapes are not copied")
+	{
+		const std::string_view block = "msgid=abc;+example=foo\\sbar";
+		Oulu::TagView tags(block);
+
+		const auto msgid = tags.Get("msgid");
+		REQUIRE(msgid);
+		REQUIRE(msgid->data() == block.data() + 6);
+
+		REQUIRE(tags.GetRaw("+example") == "foo\\sbar");
+		REQUIRE(tags.Get("+example") == "foo bar");
+	}
+
+	SECTION("Test that values can be unescaped into a caller buffer")
+	{
+		Oulu::TagView tags("a=foo\\:bar\\\\;b=baz");
+		std::array<char, 16> buffer;
+
+		const auto value = tags.Get("a", buffer);
+		REQUIRE(value == "foo;bar\\");
+		REQUIRE(value->data() == buffer.data());
+
+		std::array<char, 4> small;
+		REQUIRE(!tags.Get("a", small));
+		REQUIRE(tags.Get("b", small) == "baz");
+	}
+
+	SECTION("Test that long values are unescaped correctly")
+	{
+		const auto raw = std::string(Oulu::TagView::INLINE_BUFFER_SIZE * 2, 'x') + "\\s";
+		const auto block = "long=" + raw;
+		Oulu::TagView tags(block);
+		REQUIRE(tags.Get("long") == Oulu::UnescapeTag(raw));
+	}
+
+	SECTION("Test that tags past the index can be found")
+	{
+		std::string block;
+		for (size_t idx = 0; idx < Oulu::TagView::MAX_INDEXED_TAGS * 2; ++idx)
+			block.append("key").append(std::to_string(idx)).append("=value").append(std::to_string(idx)).append(";");
+
+		Oulu::TagView tags(block);
+		for (size_t idx = 0; idx < Oulu::TagView::MAX_INDEXED_TAGS * 2; ++idx)
+			REQUIRE(tags.Get("key" + std::to_string(idx)) == "value" + std::to_string(idx));
+		REQUIRE(!tags.Get("key"));
+	}
+
+	SECTION("Test that we can iterate over tags")
+	{
+		Oulu::TagView tags("msgid=abc;;+typing=active;+example.com/foo=bar;example.com/baz");
+
+		std::vector<std::string_view> client_only;
+		std::vector<std::string_view> vendors;
+		std::vector<std::string_view> names;
+		for (const auto& tag : tags)
+		{
+			names.push_back(tag.GetName());
+			if (tag.IsClientOnly())
+				client_only.push_back(tag.key);
+			if (!tag.GetVendor().empty())
+				vendors.push_back(tag.GetVendor());
+		}
+
+		REQUIRE(names == std::vector<std::string_view>{ "msgid", "typing", "foo", "baz" });
+		REQUIRE(client_only == std::vector<std::string_view>{ "+typing", "+example.com/foo" });
+		REQUIRE(vendors == std::vector<std::string_view>{ "example.com", "example.com" });
+	}
+
+	SECTION("Test that an empty tag block has no tags")
+	{
+		Oulu::TagView tags;
+		REQUIRE(tags.begin() == tags.end());
+		REQUIRE(!tags.Get("msgid"));
+	}
+}
+
+TEST_CASE("Test that MessageBuilder functions as expected")
+{
+	Oulu::MessageBuilder builder;
+	builder.SetSource("nick!user@host")
+		.SetCommand("PRIVMSG")
+		.PushParam("#chan")
+		.PushParam("hello world")
+		.AddTag("msgid", "abc")
+		.AddTag("time", "2024-01-01T00:00:00.000Z")
+		.AddTag("+example", "foo bar;baz")
+		.AddTag("+typing");
+
+	SECTION("Test that we can build a message with all tags")
+	{
+		const auto line = builder.Build();
+		REQUIRE(*line == "@msgid=abc;time=2024-01-01T00:00:00.000Z;+example=foo\\sbar\\:baz;+typing :nick!user@host PRIVMSG #chan :hello world\r\n");
+		REQUIRE(builder.Build() == line);
+	}
+
+	SECTION("Test that we can build a message with some tags")
+	{
+		const auto line = builder.Build([](const std::string_view& key) { return !key.starts_with('+'); });
+		REQUIRE(*line == "@msgid=abc;time=2024-01-01T00:00:00.000Z :nick!user@host PRIVMSG #chan :hello world\r\n");
+
+		const auto none = builder.Build([](const std::string_view& key) { return key == "account"; });
+		REQUIRE(*none == ":nick!user@host PRIVMSG #chan :hello world\r\n");
+		REQUIRE(none == builder.BuildWithoutTags());
+	}
+
+	SECTION("Test that we can build a message without tags")
+	{
+		const auto line = builder.BuildWithoutTags();
+		REQUIRE(*line == ":nick!user@host PRIVMSG #chan :hello world\r\n");
+		REQUIRE(builder.BuildWithoutTags() == line);
+	}
+
+	SECTION("Test that modifying the message invalidates the cached forms")
+	{
+		const auto line = builder.Build();
+		const auto tagless = builder.BuildWithoutTags();
+
+		builder.AddTag("label", "1");
+		REQUIRE(builder.Build() != line);
+		REQUIRE(builder.BuildWithoutTags() == tagless);
+
+		builder.SetSource({});
+		REQUIRE(*builder.BuildWithoutTags() == "PRIVMSG #chan :hello world\r\n");
+	}
+
+	SECTION("Test that parameters are only sent as trailing when needed")
+	{
+		builder.Clear();
+		builder.SetCommand("MODE").PushParam("#chan").PushParam("+o").PushParam("nick");
+		REQUIRE(*builder.Build() == "MODE #chan +o nick\r\n");
+		REQUIRE(builder.Build() == builder.BuildWithoutTags());
+
+		builder.Clear();
+		builder.SetCommand("TOPIC").PushParam("#chan").PushParam("").PushParam("ignored");
+		REQUIRE(*builder.Build() == "TOPIC #chan :\r\n");
+
+		builder.Clear();
+		builder.SetCommand("PRIVMSG").PushParam("#chan").PushParam(":)");
+		REQUIRE(*builder.Build() == "PRIVMSG #chan ::)\r\n");
+	}
+
+	SECTION("Test that built messages can be parsed")
+	{
+		const auto line = builder.Build();
+		Oulu::ParsedMessage message;
+		REQUIRE(message.Parse(std::string_view(*line).substr(0, line->length() - 2)));
+
+		Oulu::TagView tags(message.GetTags());
+		REQUIRE(tags.Get("+example") == "foo bar;baz");
+		REQUIRE(message.GetParams()[1] == "hello world");
+	}
+}
+
+TEST_CASE("Test that LineFramer functions as expected")
+{
+	Oulu::LineFramer framer;
+	std::string_view line;
+
+	SECTION("Test that lines are split on either line terminator")
+	{
+		REQUIRE(framer.Append("PING :a\r\nPING :b\n\r\n\nPING :c\r\nPING"));
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == "PING :a");
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == "PING :b");
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == "PING :c");
+		REQUIRE(!framer.GetLine(line));
+		REQUIRE(line.empty());
+		REQUIRE(framer.GetPending() == 4);
+
+		REQUIRE(framer.Append(" :d\r"));
+		REQUIRE(!framer.GetLine(line));
+		REQUIRE(framer.Append("\n"));
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == "PING :d");
+		REQUIRE(framer.GetPending() == 0);
+	}
+
+	SECTION("Test that lines are the same however the data is split")
+	{
+		std::string stream;
+		std::vector<std::string> expected;
+		for (size_t idx = 0; idx < 200; ++idx)
+		{
+			expected.push_back("PRIVMSG #chan :" + std::string(idx * 7 % 400, 'a' + idx % 26));
+			stream.append(expected.back()).append(idx % 3 ? "\r\n" : "\n");
+		}
+
+		for (const size_t chunk_size : { 1, 2, 63, 64, 65, 1000, 4096 })
+		{
+			Oulu::LineFramer chunk_framer;
+			std::vector<std::string> actual;
+			for (size_t offset = 0; offset < stream.length(); offset += chunk_size)
+			{
+				REQUIRE(chunk_framer.Append(std::string_view(stream).substr(offset, chunk_size)));
+				while (chunk_framer.GetLine(line))
+					actual.emplace_back(line);
+			}
+			REQUIRE(actual == expected);
+			REQUIRE(chunk_framer.GetPending() == 0);
+		}
+	}
+
+	SECTION("Test that the length limits are enforced")
+	{
+		const std::string max_line(Oulu::LineFramer::MAX_LINE_LENGTH - 2, 'a');
+		REQUIRE(framer.Append(max_line + "\r\n"));
+		REQUIRE(!framer.Append(max_line + "a\r\n"));
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == max_line);
+		REQUIRE(!framer.GetLine(line));
+
+		const auto max_tags = "@" + std::string(Oulu::LineFramer::MAX_TAGS_LENGTH - 2, 'a') + " ";
+		REQUIRE(framer.Append(max_tags + max_line + "\r\n"));
+		REQUIRE(!framer.Append("@a" + max_tags + "PING\r\n"));
+		REQUIRE(!framer.Append(max_tags + max_line + "a\r\n"));
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == max_tags + max_line);
+		REQUIRE(!framer.GetLine(line));
+	}
+
+	SECTION("Test that the length limits are enforced before data is buffered")
+	{
+		REQUIRE(framer.Append("PING :a\r\n" + std::string(Oulu::LineFramer::MAX_LINE_LENGTH - 3, 'a')));
+		REQUIRE(framer.Append("a"));
+		REQUIRE(!framer.Append("a"));
+		REQUIRE(!framer.Append("PING :b\r\n\r\n"));
+		REQUIRE(framer.GetPending() == Oulu::LineFramer::MAX_LINE_LENGTH + 7);
+
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line == "PING :a");
+		REQUIRE(!framer.GetLine(line));
+
+		REQUIRE(framer.Append("\r"));
+		REQUIRE(framer.Append("\n"));
+		REQUIRE(framer.GetLine(line));
+		REQUIRE(line.length() == Oulu::LineFramer::MAX_LINE_LENGTH - 2);
+	}
+}
+
+TEST_CASE("Test that MessageBatch functions as expected")
+{
+	const std::array<std::string_view, 4> lines = {
+		"@msgid=abc :nick!user@host PRIVMSG #chan :hello world",
+		"",
+		"PING :server.example",
+		"MODE #chan +o nick",
+	};
+
+	Oulu::MessageBatch batch;
+	REQUIRE(batch.Parse(lines) == 3);
+	REQUIRE(batch.GetSize() == 3);
+
+	SECTION("Test that the components of each message are stored")
+	{
+		const std::array<Oulu::Command, 3> commands = { Oulu::Command::PRIVMSG, Oulu::Command::PING, Oulu::Command::MODE };
+		REQUIRE(std::ranges::equal(batch.GetCommands(), commands));
+
+		const std::array<std::string_view, 3> names = { "PRIVMSG", "PING", "MODE" };
+		REQUIRE(std::ranges::equal(batch.GetCommandNames(), names));
+
+		const std::array<std::string_view, 3> sources = { "nick!user@host", "", "" };
+		REQUIRE(std::ranges::equal(batch.GetSources(), sources));
+
+		const std::array<std::string_view, 3> tags = { "msgid=abc", "", "" };
+		REQUIRE(std::ranges::equal(batch.GetTags(), tags));
+
+		REQUIRE(batch.GetLines()[1] == lines[2]);
+	}
+
+	SECTION("Test that the parameters of each message are stored")
+	{
+		REQUIRE(batch.GetParams(0).size() == 2);
+		REQUIRE(batch.GetParam(0, 0) == "#chan");
+		REQUIRE(batch.GetParam(0, 1) == "hello world");
+		REQUIRE(batch.GetParams(1).size() == 1);
+		REQUIRE(batch.GetParam(1, 0) == "server.example");
+		REQUIRE(batch.GetParams(2).size() == 3);
+		REQUIRE(batch.GetParams(2)[1].offset == 11);
+		REQUIRE(batch.GetParams(2)[1].length == 2);
+	}
+
+	SECTION("Test that the batch matches ParsedMessage")
+	{
+		batch.Clear();
+		REQUIRE(batch.GetSize() == 0);
+
+		std::vector<std::string> owned;
+		for (size_t idx = 0; idx < 100; ++idx)
+		{
+			std::string line = "CMD";
+			for (size_t param = 0; param < idx % 20; ++param)
+				line.append(" p").append(std::to_string(param));
+			owned.push_back(line);
+		}
+
+		const std::vector<std::string_view> views(owned.begin(), owned.end());
+		REQUIRE(batch.Parse(views) == views.size());
+		REQUIRE(batch.Parse(views) == views.size());
+		REQUIRE(batch.GetSize() == views.size() * 2);
+
+		for (size_t idx = 0; idx < batch.GetSize(); ++idx)
+		{
+			Oulu::ParsedMessage message;
+			REQUIRE(message.Parse(batch.GetLines()[idx]));
+			REQUIRE(batch.GetCommands()[idx] == Oulu::Command::UNKNOWN);
+			REQUIRE(batch.GetCommandNames()[idx] == message.GetCommand());
+			REQUIRE(batch.GetParams(idx).size() == message.GetParams().size());
+			for (size_t param = 0; param < message.GetParams().size(); ++param)
+				REQUIRE(batch.GetParam(idx, param) == message.GetParams()[param]);
+		}
+	}
+}
+
+TEST_CASE("Test that MessageArena functions as expected")
+{
+	SECTION("Test that strings can be allocated from the arena")
+	{
+		Oulu::MessageArena arena;
+
+		const auto escaped = Oulu::EscapeTag("foo bar", arena.GetAllocator());
+		REQUIRE(escaped == "foo\\sbar");
+		REQUIRE(escaped.get_allocator().resource() == arena.GetResource());
+
+		const auto unescaped = Oulu::UnescapeTag(escaped, arena.GetAllocator());
+		REQUIRE(unescaped == "foo bar");
+		REQUIRE(unescaped.get_allocator().resource() == arena.GetResource());
+
+		const auto stripped = Oulu::StripFormatting("\x02" "foo\x03" "4,5bar", arena.GetAllocator());
+		REQUIRE(stripped == "foobar");
+		REQUIRE(stripped.get_allocator().resource() == arena.GetResource());
+
+		std::pmr::string buffer(arena.GetAllocator());
+		REQUIRE(Oulu::EscapeTag("foo;bar", buffer) == "foo\\:bar");
+		REQUIRE(Oulu::UnescapeTag("foo\\:bar", buffer) == "foo;bar");
+		REQUIRE(buffer.get_allocator().resource() == arena.GetResource());
+
+		const std::string_view clean = "foobar";
+		REQUIRE(Oulu::UnescapeTag(clean, buffer).data() == clean.data());
+	}
+
+	SECTION("Test that the strict decoders can decode into the arena")
+	{
+		// The upstream resource fails every allocation so the decoded data must be in the arena.
+		Oulu::MessageArena arena(512, std::pmr::null_memory_resource());
+
+		// These are long enough that they do not fit in the small string buffer.
+		const auto base64 = Oulu::Base64DecodeStrict("dGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcw==", arena.GetAllocator());
+		REQUIRE(base64.data == "the quick brown fox jumps");
+		REQUIRE(base64.data.get_allocator().resource() == arena.GetResource());
+
+		const auto hex = Oulu::HexDecodeStrict("74:68:65:20:71:75:69:63:6b:20:62:72:6f:77:6e:20:66:6f:78:20:6a:75:6d:70:73", arena.GetAllocator(), Oulu::HEX_TABLE_LOWER, ':');
+		REQUIRE(hex.data == "the quick brown fox jumps");
+		REQUIRE(hex.data.get_allocator().resource() == arena.GetResource());
+
+		const auto percent = Oulu::PercentDecodeStrict("the%20quick%20brown%20fox%20jumps", arena.GetAllocator());
+		REQUIRE(percent.data == "the quick brown fox jumps");
+		REQUIRE(percent.data.get_allocator().resource() == arena.GetResource());
+
+		const auto error = Oulu::PercentDecodeStrict("foo%2", arena.GetAllocator());
+		REQUIRE(error.error == Oulu::DecodeError::TRUNCATED);
+		REQUIRE(error.position == 5);
+		REQUIRE(error.data.empty());
+	}
+
+	SECTION("Test that resetting the arena frees everything at once")
+	{
+		// The upstream resource fails every allocation so this only works if memory is reused.
+		Oulu::MessageArena arena(512, std::pmr::null_memory_resource());
+		for (size_t idx = 0; idx < 100; ++idx)
+		{
+			{
+				const auto unescaped = Oulu::UnescapeTag(std::string(300, 'a') + "\\s", arena.GetAllocator());
+				REQUIRE(unescaped.length() == 301);
+			}
+			arena.Reset();
+		}
+
+		const auto first = Oulu::UnescapeTag(std::string(300, 'a'), arena.GetAllocator());
+		REQUIRE(first.length() == 300);
+		REQUIRE_THROWS_AS(Oulu::UnescapeTag(std::string(300, 'a'), arena.GetAllocator()), std::bad_alloc);
+	}
+}
+
+TEST_CASE("Test that ListTokenizer functions as expected")
+{
+	SECTION("Test that we can split a list")
+	{
+		Oulu::ListTokenizer tokenizer("#a,#b,#c");
+		REQUIRE(tokenizer.GetCount() == 3);
+
+		std::string_view element;
+		REQUIRE(tokenizer.GetNext(element));
+		REQUIRE(element == "#a");
+		REQUIRE(tokenizer.GetCount() == 2);
+		REQUIRE(tokenizer.GetRemaining() == "#b,#c");
+
+		REQUIRE(tokenizer.GetNext(element));
+		REQUIRE(element == "#b");
+		REQUIRE(tokenizer.GetNext(element));
+		REQUIRE(element == "#c");
+		REQUIRE(tokenizer.GetCount() == 0);
+		REQUIRE(tokenizer.GetRemaining().empty());
+
+		REQUIRE(!tokenizer.GetNext(element));
+		REQUIRE(element.empty());
+	}
+
+	SECTION("Test that empty elements are skipped unless requested")
+	{
+		std::string_view element;
+		Oulu::ListTokenizer skipping(",#a,,#b,");
+		REQUIRE(skipping.GetCount() == 2);
+		REQUIRE(skipping.GetNext(element));
+		REQUIRE(element == "#a");
+		REQUIRE(skipping.GetNext(element));
+		REQUIRE(element == "#b");
+		REQUIRE(!skipping.GetNext(element));
+
+		Oulu::ListTokenizer allowing(",#a,,#b,", ',', true);
+		REQUIRE(allowing.GetCount() == 5);
+		for (const auto* expected : { "", "#a", "", "#b", "" })
+		{
+			REQUIRE(allowing.GetNext(element));
+			REQUIRE(element == expected);
+		}
+		REQUIRE(allowing.GetCount() == 0);
+		REQUIRE(!allowing.GetNext(element));
+
+		for (const auto allow_empty : { false, true })
+		{
+			Oulu::ListTokenizer empty("", ',', allow_empty);
+			REQUIRE(empty.GetCount() == 0);
+			REQUIRE(!empty.GetNext(element));
+		}
+	}
+
+	SECTION("Test that we can split on other separators")
+	{
+		std::string_view element;
+		Oulu::ListTokenizer tokenizer("PREFIX=(ov)@+", '=');
+		REQUIRE(tokenizer.GetNext(element));
+		REQUIRE(element == "PREFIX");
+		REQUIRE(tokenizer.GetRemaining() == "(ov)@+");
+
+		Oulu::ListTokenizer caps("multi-prefix  sasl   away-notify", ' ');
+		REQUIRE(caps.GetCount() == 3);
+	}
+
+	SECTION("Test that we match a reference implementation across blocks")
+	{
+		const auto original_level = Oulu::SIMD::GetLevel();
+		std::mt19937 random(1459);
+		for (const auto level : { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 })
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			for (size_t iteration = 0; iteration < 500; ++iteration)
+			{
+				std::string list(random() % 300, 'a');
+				for (auto& chr : list)
+				{
+					if (random() % 4 == 0)
+						chr = ',';
+				}
+
+				for (const auto allow_empty : { false, true })
+				{
+					std::vector<std::string_view> expected;
+					for (size_t start = 0; !list.empty() && start <= list.length(); )
+					{
+						const auto end = std::min(list.find(',', start), list.length());
+						if (allow_empty || end > start)
+							expected.push_back(std::string_view(list).substr(start, end - start));
+						start = end + 1;
+					}
+
+					Oulu::ListTokenizer tokenizer(list, ',', allow_empty);
+					std::string_view element;
+					for (size_t idx = 0; idx < expected.size(); ++idx)
+					{
+						REQUIRE(tokenizer.GetCount() == expected.size() - idx);
+						REQUIRE(tokenizer.GetNext(element));
+						REQUIRE(element == expected[idx]);
+						REQUIRE(element.data() >= list.data());
+					}
+					REQUIRE(tokenizer.GetCount() == 0);
+					REQUIRE(!tokenizer.GetNext(element));
+				}
+			}
+		}
+		Oulu::SIMD::SetLevel(original_level);
+	}
 }
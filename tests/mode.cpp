@@ -0,0 +1,130 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <oulu/mode.hpp>
+
+TEST_CASE("Test that ModeTable functions as expected")
+{
+	const Oulu::ModeTable table("beI,k,l,imnpst,XYZ", "(qaohv)~&@%+");
+
+	SECTION("Test that we can classify modes")
+	{
+		REQUIRE(table.GetType('b') == Oulu::ModeType::LIST);
+		REQUIRE(table.GetType('k') == Oulu::ModeType::PARAM);
+		REQUIRE(table.GetType('l') == Oulu::ModeType::PARAM_SET);
+		REQUIRE(table.GetType('m') == Oulu::ModeType::FLAG);
+		REQUIRE(table.GetType('o') == Oulu::ModeType::PREFIX);
+		REQUIRE(table.GetType('X') == Oulu::ModeType::UNKNOWN);
+		REQUIRE(table.GetType('z') == Oulu::ModeType::UNKNOWN);
+
+		REQUIRE(table.GetPrefix('q') == '~');
+		REQUIRE(table.GetPrefix('v') == '+');
+		REQUIRE(table.GetPrefix('b') == '\0');
+
+		REQUIRE(table.HasParam('b', false));
+		REQUIRE(table.HasParam('k', false));
+		REQUIRE(table.HasParam('l', true));
+		REQUIRE(!table.HasParam('l', false));
+		REQUIRE(!table.HasParam('n', true));
+		REQUIRE(table.HasParam('h', false));
+
+		const Oulu::ModeTable defaults;
+		REQUIRE(defaults.GetType('I') == Oulu::ModeType::LIST);
+		REQUIRE(defaults.GetPrefix('o') == '@');
+		REQUIRE(defaults.GetType('h') == Oulu::ModeType::UNKNOWN);
+
+		const Oulu::ModeTable malformed("b", "ov)@+");
+		REQUIRE(malformed.GetType('b') == Oulu::ModeType::LIST);
+		REQUIRE(malformed.GetType('o') == Oulu::ModeType::UNKNOWN);
+	}
+
+	SECTION("Test that we can parse mode changes")
+	{
+		std::array<Oulu::ModeChange, 16> changes;
+		const auto count = table.Parse("+ov-b+l-lk nick1 nick2 *!*@host 10 key", changes);
+		REQUIRE(count == 6);
+		REQUIRE(changes[0] == Oulu::ModeChange{ true, 'o', "nick1" });
+		REQUIRE(changes[1] == Oulu::ModeChange{ true, 'v', "nick2" });
+		REQUIRE(changes[2] == Oulu::ModeChange{ false, 'b', "*!*@host" });
+		REQUIRE(changes[3] == Oulu::ModeChange{ true, 'l', "10" });
+		REQUIRE(changes[4] == Oulu::ModeChange{ false, 'l', "" });
+		REQUIRE(changes[5] == Oulu::ModeChange{ false, 'k', "key" });
+
+		const std::vector<std::string_view> params = { "nt+k-X", "key" };
+		REQUIRE(table.Parse(params, changes) == 4);
+		REQUIRE(changes[0] == Oulu::ModeChange{ true, 'n', "" });
+		REQUIRE(changes[1] == Oulu::ModeChange{ true, 't', "" });
+		REQUIRE(changes[2] == Oulu::ModeChange{ true, 'k', "key" });
+		REQUIRE(changes[3] == Oulu::ModeChange{ false, 'X', "" });
+
+		REQUIRE(table.Parse("+b :trailing mask", changes) == 1);
+		REQUIRE(changes[0] == Oulu::ModeChange{ true, 'b', "trailing mask" });
+
+		REQUIRE(table.Parse("", changes) == 0);
+		REQUIRE(table.Parse(std::span<const std::string_view>(), changes) == 0);
+	}
+
+	SECTION("Test that we skip changes which are missing parameters or do not fit")
+	{
+		std::array<Oulu::ModeChange, 2> changes;
+		REQUIRE(table.Parse("+iob nick", changes) == 2);
+		REQUIRE(changes[0] == Oulu::ModeChange{ true, 'i', "" });
+		REQUIRE(changes[1] == Oulu::ModeChange{ true, 'o', "nick" });
+
+		REQUIRE(table.Parse("+mnst", changes) == 2);
+		REQUIRE(changes[1] == Oulu::ModeChange{ true, 'n', "" });
+	}
+
+	SECTION("Test that we can serialize mode changes")
+	{
+		const Oulu::ModeChange changes[] = {
+			{ true, 'o', "nick1" },
+			{ false, 'b', "*!*@host" },
+			{ true, 'v', "nick2" },
+			{ true, 'n', "" },
+			{ false, 'l', "" },
+		};
+		const auto lines = table.Serialize(changes, 0, 512);
+		REQUIRE(lines == std::vector<std::string>{ "+ovn-bl nick1 nick2 *!*@host" });
+
+		std::array<Oulu::ModeChange, 8> parsed;
+		REQUIRE(table.Parse(lines[0], parsed) == 5);
+	}
+
+	SECTION("Test that we merge changes to the same mode")
+	{
+		const Oulu::ModeChange changes[] = {
+			{ true, 'm', "" },
+			{ true, 'o', "nick1" },
+			{ true, 'l', "10" },
+			{ false, 'm', "" },
+			{ false, 'o', "nick1" },
+			{ true, 'o', "nick2" },
+			{ true, 'l', "20" },
+			{ true, 'b', "a" },
+			{ true, 'b', "b" },
+			{ true, 'b', "a" },
+		};
+		REQUIRE(table.Serialize(changes, 0, 512) == std::vector<std::string>{ "+olbb-mo nick2 20 b a nick1" });
+	}
+
+	SECTION("Test that we pack changes under the limits")
+	{
+		std::vector<Oulu::ModeChange> changes;
+		for (const auto* nick : { "a", "b", "c", "d", "e" })
+			changes.push_back({ true, 'v', nick });
+		changes.push_back({ true, 'i', "" });
+		changes.push_back({ true, 's', "" });
+
+		REQUIRE(table.Serialize(changes, 2, 512) == std::vector<std::string>{ "+vv a b", "+vv c d", "+vis e" });
+		REQUIRE(table.Serialize(changes, 0, 8) == std::vector<std::string>{ "+vv a b", "+vv c d", "+vis e" });
+		REQUIRE(table.Serialize(changes, 0, 1).size() == 7);
+		REQUIRE(table.Serialize({}, 4, 512).empty());
+	}
+}
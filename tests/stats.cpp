@@ -0,0 +1,146 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <numeric>
+#include <string>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <oulu/command.hpp>
+#include <oulu/encoding.hpp>
+#include <oulu/message.hpp>
+#include <oulu/stats.hpp>
+
+namespace
+{
+	// Retrieves the difference between the statistics of a function in two snapshots.
+	Oulu::Stats::FunctionStats Difference(const Oulu::Stats::Snapshot& before, const Oulu::Stats::Snapshot& after, Oulu::Stats::Function function)
+	{
+		const auto& lhs = before.Get(function);
+		const auto& rhs = after.Get(function);
+
+		Oulu::Stats::FunctionStats difference;
+		difference.bytes = rhs.bytes - lhs.bytes;
+		difference.calls = rhs.calls - lhs.calls;
+		for (size_t bucket = 0; bucket < Oulu::Stats::HISTOGRAM_BUCKETS; ++bucket)
+			difference.cycles[bucket] = rhs.cycles[bucket] - lhs.cycles[bucket];
+		difference.failures = rhs.failures - lhs.failures;
+		difference.slow_paths = rhs.slow_paths - lhs.slow_paths;
+		return difference;
+	}
+
+	// Counts the calls in a histogram.
+	uint64_t CountHistogram(const Oulu::Stats::FunctionStats& stats)
+	{
+		return std::accumulate(stats.cycles.begin(), stats.cycles.end(), uint64_t(0));
+	}
+}
+
+TEST_CASE("Test that Stats functions as expected")
+{
+	SECTION("Test that every function has a name")
+	{
+		for (size_t idx = 0; idx < Oulu::Stats::FUNCTION_COUNT; ++idx)
+			REQUIRE(!Oulu::Stats::GetName(static_cast<Oulu::Stats::Function>(idx)).empty());
+
+		REQUIRE(Oulu::Stats::GetName(Oulu::Stats::Function::PARSED_MESSAGE_PARSE) == "ParsedMessage::Parse");
+		REQUIRE(Oulu::Stats::GetName(static_cast<Oulu::Stats::Function>(Oulu::Stats::FUNCTION_COUNT)).empty());
+	}
+
+	SECTION("Test that calls are recorded")
+	{
+		const auto before = Oulu::Stats::GetThreadSnapshot();
+
+		std::string buffer;
+		Oulu::UnescapeTag("plain", buffer);
+		Oulu::UnescapeTag("needs\\sunescaping", buffer);
+
+		std::string_view name;
+		Oulu::ParseCTCP("not a ctcp", name);
+		Oulu::ParseCTCP("\x1VERSION\x1", name);
+
+		Oulu::HexDecode("0g");
+		Oulu::ParsedMessage message;
+		message.Parse("");
+
+		const auto after = Oulu::Stats::GetThreadSnapshot();
+		const auto unescape = Difference(before, after, Oulu::Stats::Function::UNESCAPE_TAG);
+		const auto ctcp = Difference(before, after, Oulu::Stats::Function::PARSE_CTCP);
+		const auto hex = Difference(before, after, Oulu::Stats::Function::HEX_DECODE);
+		const auto parse = Difference(before, after, Oulu::Stats::Function::PARSED_MESSAGE_PARSE);
+		if (!Oulu::Stats::IsEnabled())
+		{
+			REQUIRE(unescape.calls == 0);
+			REQUIRE(ctcp.calls == 0);
+			REQUIRE(Oulu::Stats::GetSnapshot().Get(Oulu::Stats::Function::HEX_DECODE).calls == 0);
+			return;
+		}
+
+		REQUIRE(unescape.calls == 2);
+		REQUIRE(unescape.bytes == 22);
+		REQUIRE(unescape.slow_paths == 1);
+		REQUIRE(unescape.failures == 0);
+		REQUIRE(CountHistogram(unescape) == 0);
+
+		REQUIRE(ctcp.calls == 2);
+		REQUIRE(ctcp.failures == 1);
+
+		REQUIRE(hex.calls == 1);
+		REQUIRE(hex.failures == 1);
+
+		REQUIRE(parse.calls == 1);
+		REQUIRE(parse.failures == 1);
+	}
+
+	SECTION("Test that histograms are only recorded when enabled")
+	{
+		REQUIRE(!Oulu::Stats::IsHistogramEnabled());
+		Oulu::Stats::SetHistogramEnabled(true);
+		REQUIRE(Oulu::Stats::IsHistogramEnabled() == Oulu::Stats::IsEnabled());
+
+		const auto before = Oulu::Stats::GetThreadSnapshot();
+		for (size_t idx = 0; idx < 10; ++idx)
+			Oulu::IdentifyCommand("PRIVMSG");
+		const auto after = Oulu::Stats::GetThreadSnapshot();
+		Oulu::Stats::SetHistogramEnabled(false);
+
+		const auto identify = Difference(before, after, Oulu::Stats::Function::IDENTIFY_COMMAND);
+		REQUIRE(identify.calls == (Oulu::Stats::IsEnabled() ? 10 : 0));
+		REQUIRE(CountHistogram(identify) == identify.calls);
+	}
+
+	SECTION("Test that the statistics of other threads are included")
+	{
+		const auto before = Oulu::Stats::GetSnapshot();
+		std::thread thread([] {
+			for (size_t idx = 0; idx < 10; ++idx)
+				Oulu::IdentifyCommand("XYZZY");
+		});
+		thread.join();
+		const auto after = Oulu::Stats::GetSnapshot();
+
+		const auto identify = Difference(before, after, Oulu::Stats::Function::IDENTIFY_COMMAND);
+		REQUIRE(identify.calls == (Oulu::Stats::IsEnabled() ? 10 : 0));
+		REQUIRE(identify.failures == identify.calls);
+		REQUIRE(identify.bytes == identify.calls * 5);
+	}
+
+	SECTION("Test that snapshots can be merged")
+	{
+		Oulu::Stats::Snapshot lhs;
+		lhs.functions[0].calls = 1;
+		lhs.functions[0].cycles[3] = 2;
+
+		Oulu::Stats::Snapshot rhs;
+		rhs.functions[0].calls = 4;
+		rhs.functions[0].cycles[3] = 5;
+		rhs.functions[1].failures = 6;
+
+		lhs.Merge(rhs);
+		REQUIRE(lhs.functions[0].calls == 5);
+		REQUIRE(lhs.functions[0].cycles[3] == 7);
+		REQUIRE(lhs.functions[1].failures == 6);
+		REQUIRE(rhs.functions[0].calls == 4);
+	}
+}
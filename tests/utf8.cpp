@@ -0,0 +1,243 @@
+// Oulu <https://github.com/inspircd/liboulu/>
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <random>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <oulu/simd.hpp>
+#include <oulu/utf8.hpp>
+
+namespace
+{
+	// The SIMD levels which the validator is tested with.
+	constexpr Oulu::SIMD::Level LEVELS[] = { Oulu::SIMD::Level::SCALAR, Oulu::SIMD::Level::SSE41, Oulu::SIMD::Level::AVX2 };
+
+	// A simple reference implementation of UTF-8 validation to check the optimised one against.
+	bool ReferenceIsValid(const std::string_view& str)
+	{
+		for (size_t idx = 0; idx < str.length(); )
+		{
+			const auto lead = static_cast<uint8_t>(str[idx]);
+			size_t length;
+			uint32_t codepoint;
+			if (lead < 0x80)
+			{
+				idx++;
+				continue;
+			}
+			else if (lead >= 0xC2 && lead <= 0xDF)
+			{
+			length = 2;
+			codepoint = lead & 0x1F;
+			}
+			else if (lead >= 0xE0 && lead <= 0xEF)
+			{
+			length = 3;
+			codepoint = lead & 0x0F;
+			}
+			else if (lead >= 0xF0 && lead <= 0xF4)
+			{
+			length = 4;
+			codepoint = lead & 0x07;
+			}
+			else
+			return false;
+
+			if (idx + length > str.length())
+			return false;
+
+			for (size_t offset = 1; offset < length; ++offset)
+			{
+			const auto chr = static_cast<uint8_t>(str[idx + offset]);
+			if ((chr & 0xC0) != 0x80)
+				return false;
+			codepoint = (codepoint << 6) | (chr & 0x3F);
+			}
+
+			if ((length == 3 && codepoint < 0x800) || (length == 4 && codepoint < 0x10000))
+			return false;
+			if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+			return false;
+			idx += length;
+		}
+		return true;
+	}
+}
+
+TEST_CASE("Test that UTF8::IsValid functions as expected")
+{
+	const auto original_level = Oulu::SIMD::GetLevel();
+
+	const std::pair<std::string_view, bool> cases[] = {
+		{ "", true },
+		{ "hello", true },
+		{ "caf\xC3\xA9", true },
+		{ "\xE2\x82\xAC", true },
+		{ "\xF0\x9F\x98\x80", true },
+		{ "\xF4\x8F\xBF\xBF", true },
+		{ "\xED\x9F\xBF", true },
+		{ "\xEE\x80\x80", true },
+		{ "\x80", false },
+		{ "\xBF", false },
+		{ "\xC0\x80", false },
+		{ "\xC1\xBF", false },
+		{ "\xC3", false },
+		{ "\xC3\x28", false },
+		{ "\xE0\x80\xAF", false },
+		{ "\xE0\x9F\xBF", false },
+		{ "\xE2\x82", false },
+		{ "\xED\xA0\x80", false },
+		{ "\xED\xBF\xBF", false },
+		{ "\xF0\x8F\xBF\xBF", false },
+		{ "\xF0\x9F\x98", false },
+		{ "\xF4\x90\x80\x80", false },
+		{ "\xF5\x80\x80\x80", false },
+		{ "\xF8\x88\x80\x80\x80", false },
+		{ "\xFE", false },
+		{ "\xFF", false },
+		{ "\xC3\xA9\xA9", false },
+	};
+
+	SECTION("Test that known sequences are checked correctly at every offset")
+	{
+		for (const auto level : LEVELS)
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			for (const auto& [sequence, valid] : cases)
+			{
+				// Move the sequence across the block boundaries and the ASCII fast path.
+				for (size_t prefix = 0; prefix <= 130; ++prefix)
+				{
+					for (const size_t suffix : { 0, 1, 3, 64 })
+					{
+						const auto str = std::string(prefix, 'a') + std::string(sequence) + std::string(suffix, 'b');
+						REQUIRE(Oulu::UTF8::IsValid(str) == valid);
+					}
+				}
+			}
+		}
+	}
+
+	SECTION("Test that every pair of octets matches the reference implementation")
+	{
+		for (const auto level : LEVELS)
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			std::string str(70, 'x');
+			for (size_t first = 0; first < 256; ++first)
+			{
+				for (size_t second = 0; second < 256; ++second)
+				{
+					str[62] = static_cast<char>(first);
+					str[63] = static_cast<char>(second);
+					REQUIRE(Oulu::UTF8::IsValid(str) == ReferenceIsValid(str));
+					REQUIRE(Oulu::UTF8::IsValid(str.substr(62, 2)) == ReferenceIsValid(str.substr(62, 2)));
+				}
+			}
+		}
+	}
+
+	SECTION("Test that random strings match the reference implementation")
+	{
+		for (const auto level : LEVELS)
+		{
+			if (!Oulu::SIMD::SetLevel(level))
+				continue;
+
+			const std::string_view pieces[] = {
+				"a", "ab", "abcdefghijklmnop", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF",
+			};
+
+			std::mt19937 random(1459);
+			for (size_t iteration = 0; iteration < 5000; ++iteration)
+			{
+				std::string str;
+				const auto length = random() % 300;
+				while (str.length() < length)
+					str.append(pieces[random() % std::size(pieces)]);
+				REQUIRE(Oulu::UTF8::IsValid(str));
+				if (str.empty())
+					continue;
+
+				// Corrupt a random octet and make sure we agree with the reference.
+				str[random() % str.length()] = static_cast<char>(random());
+				REQUIRE(Oulu::UTF8::IsValid(str) == ReferenceIsValid(str));
+			}
+		}
+	}
+
+	Oulu::SIMD::SetLevel(original_level);
+}
+
+TEST_CASE("Test that UTF8::Truncate functions as expected")
+{
+	SECTION("Test that strings which fit are not truncated")
+	{
+		REQUIRE(Oulu::UTF8::Truncate("", 0).empty());
+		REQUIRE(Oulu::UTF8::Truncate("hello", 5) == "hello");
+		REQUIRE(Oulu::UTF8::Truncate("caf\xC3\xA9", 10) == "caf\xC3\xA9");
+		REQUIRE(Oulu::UTF8::Truncate("hello", 3) == "hel");
+	}
+
+	SECTION("Test that codepoints are not split")
+	{
+		const std::string_view str = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+		const size_t expected[] = { 0, 1, 1, 3, 3, 3, 6, 6, 6, 6, 10 };
+		for (size_t length = 0; length <= str.length(); ++length)
+		{
+			const auto truncated = Oulu::UTF8::Truncate(str, length);
+			REQUIRE(truncated.data() == str.data());
+			REQUIRE(truncated.length() == expected[length]);
+		}
+	}
+
+	SECTION("Test that invalid sequences are truncated at the byte limit")
+	{
+		REQUIRE(Oulu::UTF8::Truncate("ab\x80\x80\x80\x80", 4) == "ab\x80\x80");
+		REQUIRE(Oulu::UTF8::Truncate("\x80\x80", 1) == "\x80");
+		REQUIRE(Oulu::UTF8::Truncate("a\xC3\xA9\xA9", 3) == "a\xC3\xA9");
+	}
+
+	SECTION("Test that graphemes are not split")
+	{
+		using Oulu::UTF8::Boundary;
+
+		// "e" followed by U+0301 COMBINING ACUTE ACCENT.
+		const std::string_view combining = "xe\xCC\x81y";
+		REQUIRE(Oulu::UTF8::Truncate(combining, 3, Boundary::CODEPOINT) == "xe");
+		REQUIRE(Oulu::UTF8::Truncate(combining, 2, Boundary::CODEPOINT) == "xe");
+		REQUIRE(Oulu::UTF8::Truncate(combining, 2, Boundary::GRAPHEME) == "x");
+		REQUIRE(Oulu::UTF8::Truncate(combining, 4, Boundary::GRAPHEME) == "xe\xCC\x81");
+
+		// U+1F44D THUMBS UP SIGN followed by U+1F3FD EMOJI MODIFIER FITZPATRICK TYPE-4.
+		const std::string_view modifier = "a\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD";
+		REQUIRE(Oulu::UTF8::Truncate(modifier, 5, Boundary::CODEPOINT) == "a\xF0\x9F\x91\x8D");
+		REQUIRE(Oulu::UTF8::Truncate(modifier, 5, Boundary::GRAPHEME) == "a");
+		REQUIRE(Oulu::UTF8::Truncate(modifier, 8, Boundary::GRAPHEME) == "a");
+
+		// U+1F468 MAN, U+200D ZERO WIDTH JOINER, U+1F4BB PERSONAL COMPUTER.
+		const std::string_view joined = "a\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x92\xBB";
+		REQUIRE(Oulu::UTF8::Truncate(joined, 8, Boundary::CODEPOINT) == "a\xF0\x9F\x91\xA8\xE2\x80\x8D");
+		REQUIRE(Oulu::UTF8::Truncate(joined, 8, Boundary::GRAPHEME) == "a");
+		REQUIRE(Oulu::UTF8::Truncate(joined, 11, Boundary::GRAPHEME) == "a");
+
+		// U+2764 HEAVY BLACK HEART followed by U+FE0F VARIATION SELECTOR-16.
+		const std::string_view selector = "\xE2\x9D\xA4\xEF\xB8\x8F!";
+		REQUIRE(Oulu::UTF8::Truncate(selector, 3, Boundary::GRAPHEME).empty());
+		REQUIRE(Oulu::UTF8::Truncate(selector, 6, Boundary::GRAPHEME) == "\xE2\x9D\xA4\xEF\xB8\x8F");
+
+		// Three flags made from pairs of regional indicators.
+		const std::string_view flags = "\xF0\x9F\x87\xAB\xF0\x9F\x87\xAE" "\xF0\x9F\x87\xAC\xF0\x9F\x87\xA7" "\xF0\x9F\x87\xBA\xF0\x9F\x87\xB8";
+		REQUIRE(Oulu::UTF8::Truncate(flags, 4, Boundary::CODEPOINT).length() == 4);
+		REQUIRE(Oulu::UTF8::Truncate(flags, 4, Boundary::GRAPHEME).empty());
+		REQUIRE(Oulu::UTF8::Truncate(flags, 8, Boundary::GRAPHEME).length() == 8);
+		REQUIRE(Oulu::UTF8::Truncate(flags, 15, Boundary::GRAPHEME).length() == 8);
+		REQUIRE(Oulu::UTF8::Truncate(flags, 20, Boundary::GRAPHEME).length() == 16);
+	}
+}